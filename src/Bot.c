@@ -0,0 +1,203 @@
+#include "Bot.h"
+#include <stdlib.h>
+
+/*******************************************************************************
+ * GLOBALS AND CONSTANTS
+ ******************************************************************************/
+// How far ahead a bot looks along each way on, in grid points
+#define BOT_LOOKAHEAD 8
+// The chance, when thinking, of turning for no reason (if it's safe)
+#define BOT_WANDER_CHANCE 0.05f
+// The chance, when thinking, of firing
+#define BOT_FIRE_CHANCE 0.03f
+
+// The ways on from a grid point
+#define WAYS 3
+
+
+/*******************************************************************************
+ * INTERNAL FUNCTION PROTOTYPES
+ ******************************************************************************/
+Direction turned( Direction dir, Turn turn );
+void step( Direction dir, int* row, int* column );
+int clear_run( GameState* gamestate, Direction dir, int row, int column );
+float distance_to_edible( GameState* gamestate, Direction dir, int row,
+                          int column );
+
+
+/*******************************************************************************
+ * CONSTRUCTORS/DESTRUCTORS
+ ******************************************************************************/
+Bot* Bot_new( int player_id, unsigned int seed )
+{
+    Bot* bot = (Bot*)malloc( sizeof(Bot) );
+
+    bot->playerId = player_id;
+    bot->jointsSeen = 0;
+    random_seed( &bot->random, seed );
+
+    return bot;
+}
+
+void Bot_delete( Bot* bot )
+{
+    free(bot);
+}
+
+
+/*******************************************************************************
+ * BOT FUNCTIONS
+ ******************************************************************************/
+int Bot_play( Bot* bot, GameState* gamestate, Action* actions )
+{
+    Player* player = GameState_player( gamestate, bot->playerId );
+    // The point the player's heading for, where they'll next be able to turn
+    int* head;
+    Direction ways[WAYS];
+    Action turns[WAYS] = { ACTION_TURN_LEFT, ACTION_TURN_LEFT,
+                           ACTION_TURN_RIGHT };
+    int runs[WAYS], longest = 0, best = -1, count = 0, i;
+    float distance, nearest = 0.0f;
+
+    if( gamestate->mode != MODE_RUNNING || player == NULL || player->out ||
+        player->jointsLaid == bot->jointsSeen )
+        return 0;
+    bot->jointsSeen = player->jointsLaid;
+    head = Player_joint( player, 0 );
+
+    // Ahead (which needs no turn), left and right
+    ways[0] = player->currentDir;
+    ways[1] = turned( player->currentDir, TURN_LEFT );
+    ways[2] = turned( player->currentDir, TURN_RIGHT );
+
+    for( i = 0; i < WAYS; i++ )
+    {
+        runs[i] = clear_run( gamestate, ways[i], head[0], head[1] );
+        if( runs[i] > longest )
+            longest = runs[i];
+    }
+
+    // Head for the edible along any way that's clear for long enough
+    for( i = 0; i < WAYS; i++ )
+    {
+        if( runs[i] < longest && runs[i] < BOT_LOOKAHEAD )
+            continue;
+
+        distance = distance_to_edible( gamestate, ways[i], head[0], head[1] );
+        if( best < 0 || distance < nearest )
+        {
+            best = i;
+            nearest = distance;
+        }
+    }
+
+    // ... or, now and then, turn off it
+    if( bounded_random( &bot->random, 0, 1 ) < BOT_WANDER_CHANCE )
+    {
+        i = bounded_random( &bot->random, 1, WAYS );
+        if( i < WAYS && runs[i] >= BOT_LOOKAHEAD )
+            best = i;
+    }
+
+    if( best > 0 )
+        actions[count++] = turns[best];
+
+    if( bounded_random( &bot->random, 0, 1 ) < BOT_FIRE_CHANCE )
+        actions[count++] = ACTION_FIRE;
+
+    return count;
+}
+
+
+/*******************************************************************************
+ * INTERNAL FUNCTIONS
+ ******************************************************************************/
+/**
+ * Returns the direction a player ends up going after turning.
+ *
+ * These are the turns change_player_direction makes, back to front (see the
+ * note there).
+ */
+Direction turned( Direction dir, Turn turn )
+{
+    switch( dir )
+    {
+    case DIRECTION_NORTH:
+        return turn == TURN_RIGHT ? DIRECTION_WEST : DIRECTION_EAST;
+    case DIRECTION_SOUTH:
+        return turn == TURN_RIGHT ? DIRECTION_EAST : DIRECTION_WEST;
+    case DIRECTION_EAST:
+        return turn == TURN_RIGHT ? DIRECTION_NORTH : DIRECTION_SOUTH;
+    case DIRECTION_WEST:
+    default:
+        return turn == TURN_RIGHT ? DIRECTION_SOUTH : DIRECTION_NORTH;
+    }
+}
+
+/**
+ * Moves a grid point one point in the given direction.
+ */
+void step( Direction dir, int* row, int* column )
+{
+    switch( dir )
+    {
+    case DIRECTION_NORTH:
+        (*column)++;
+        break;
+    case DIRECTION_SOUTH:
+        (*column)--;
+        break;
+    case DIRECTION_EAST:
+        (*row)++;
+        break;
+    case DIRECTION_WEST:
+        (*row)--;
+        break;
+    }
+}
+
+/**
+ * Returns the number of grid points, up to BOT_LOOKAHEAD, that lie between
+ * the given point and the nearest wall or body in the given direction.
+ */
+int clear_run( GameState* gamestate, Direction dir, int row, int column )
+{
+    OccupancyGrid* occupancy = gamestate->occupancy;
+    int run;
+
+    for( run = 0; run < BOT_LOOKAHEAD; run++ )
+    {
+        step( dir, &row, &column );
+        if( row < 0 || row >= occupancy->gridWidth ||
+            column < 0 || column >= occupancy->gridWidth )
+            return run;
+
+        if( OccupancyGrid_first( occupancy, row, column ) != NULL )
+            return run;
+    }
+
+    return run;
+}
+
+/**
+ * Returns the squared distance across the landscape from the grid point next
+ * to the given one, in the given direction, to the edible (or 0 if there's
+ * no edible).
+ */
+float distance_to_edible( GameState* gamestate, Direction dir, int row,
+                          int column )
+{
+    Landscape* landscape = gamestate->landscape;
+    ObjectPool* edibles = gamestate->edibles;
+    int edible = ObjectPool_find( edibles, gamestate->edible );
+    float dx, dz;
+
+    step( dir, &row, &column );
+    if( edible < 0 || row < 0 || row >= landscape->gridWidth ||
+        column < 0 || column >= landscape->gridWidth )
+        return 0.0f;
+
+    dx = landscape->pointMap[row][column][0] - edibles->position[0][edible];
+    dz = landscape->pointMap[row][column][2] - edibles->position[2][edible];
+    return dx * dx + dz * dz;
+}
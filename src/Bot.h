@@ -0,0 +1,53 @@
+#ifndef BOT_H_
+#define BOT_H_
+/**
+ * Bot.h
+ * A computer player, for playing games with no one at the controls.
+ *
+ * Players only turn at grid points, so a bot only thinks when its player lays
+ * a joint: it looks at the ways on from there (ahead, left and right), counts
+ * how far each runs before hitting a wall or a body, and takes the way towards
+ * the edible if it's clear for long enough, or the clearest way if none is.
+ * Now and then it turns for no reason, or fires, so that games differ.
+ *
+ * A bot plays by choosing actions (see mechanics.h), just as a person would,
+ * which can be logged and replayed without it. It has random numbers of its
+ * own, so it doesn't disturb the game's.
+ */
+
+#include "mechanics.h"
+
+/*******************************************************************************
+ * TYPE DEFINITIONS
+ ******************************************************************************/
+// The most actions a bot takes in a tick
+#define BOT_ACTIONS 2
+
+typedef struct {
+    int playerId; // The player the bot plays (1 or 2)
+    // The joints the player had laid when the bot last thought
+    unsigned int jointsSeen;
+    Random random;
+} Bot;
+
+/*******************************************************************************
+ * CONSTRUCTORS/DESTRUCTORS
+ ******************************************************************************/
+/**
+ * Creates a bot to play player `player_id`, with random numbers from `seed`.
+ */
+Bot* Bot_new( int player_id, unsigned int seed );
+void Bot_delete( Bot* bot );
+
+/*******************************************************************************
+ * BOT FUNCTIONS
+ ******************************************************************************/
+/**
+ * Chooses how the bot steers and fires its player, if it's reached a new grid
+ * point. Call once per tick, before updating the world, and perform the
+ * actions it puts in `actions` (up to BOT_ACTIONS); returns how many there
+ * are.
+ */
+int Bot_play( Bot* bot, GameState* gamestate, Action* actions );
+
+#endif /*BOT_H_*/
@@ -0,0 +1,108 @@
+#include "EventBus.h"
+#include <stdlib.h>
+#include <stdio.h>
+
+/*******************************************************************************
+ * CONSTRUCTORS/DESTRUCTORS
+ ******************************************************************************/
+EventBus* EventBus_new()
+{
+    EventBus* bus = (EventBus*)calloc( 1, sizeof(EventBus) );
+
+    atomic_init( &bus->subscriptionCount, 0 );
+
+    return bus;
+}
+
+void EventBus_delete( EventBus* bus )
+{
+    int i;
+
+    if( bus == NULL )
+        return;
+
+    for( i = 0; i < atomic_load( &bus->subscriptionCount ); i++ )
+        free( bus->subscriptions[i] );
+    free(bus);
+}
+
+
+/*******************************************************************************
+ * BUS FUNCTIONS
+ ******************************************************************************/
+EventSubscription* EventBus_subscribe( EventBus* bus )
+{
+    int count = atomic_load_explicit( &bus->subscriptionCount,
+                                      memory_order_relaxed );
+    EventSubscription* subscription;
+
+    if( count == EVENT_MAX_SUBSCRIBERS )
+    {
+        fprintf( stderr, "Event bus has %d subscribers already\n", count );
+        return NULL;
+    }
+
+    subscription = (EventSubscription*)malloc( sizeof(EventSubscription) );
+    atomic_init( &subscription->head, 0 );
+    atomic_init( &subscription->tail, 0 );
+    atomic_init( &subscription->dropped, 0 );
+
+    // Only once it's ready does the publisher see it
+    bus->subscriptions[count] = subscription;
+    atomic_store_explicit( &bus->subscriptionCount, count + 1,
+                           memory_order_release );
+
+    return subscription;
+}
+
+void EventBus_publish( EventBus* bus, const Event* event )
+{
+    int count = atomic_load_explicit( &bus->subscriptionCount,
+                                      memory_order_acquire ), i;
+    EventSubscription* subscription;
+    unsigned int tail;
+
+    for( i = 0; i < count; i++ )
+    {
+        subscription = bus->subscriptions[i];
+        tail = atomic_load_explicit( &subscription->tail,
+                                     memory_order_relaxed );
+
+        // Drop the event, rather than wait, if the subscriber's fallen behind
+        if( tail - atomic_load_explicit( &subscription->head,
+                                         memory_order_acquire )
+                >= EVENT_QUEUE_SIZE )
+        {
+            atomic_fetch_add_explicit( &subscription->dropped, 1,
+                                       memory_order_relaxed );
+            continue;
+        }
+
+        subscription->events[tail & (EVENT_QUEUE_SIZE - 1)] = *event;
+        atomic_store_explicit( &subscription->tail, tail + 1,
+                               memory_order_release );
+    }
+}
+
+int EventSubscription_poll( EventSubscription* subscription, Event* event )
+{
+    unsigned int head = atomic_load_explicit( &subscription->head,
+                                              memory_order_relaxed );
+
+    if( head == atomic_load_explicit( &subscription->tail,
+                                      memory_order_acquire ) )
+        return 0;
+
+    *event = subscription->events[head & (EVENT_QUEUE_SIZE - 1)];
+    // The slot's free to be written again once the event's been copied out
+    atomic_store_explicit( &subscription->head, head + 1,
+                           memory_order_release );
+
+    return 1;
+}
+
+unsigned int EventSubscription_dropped( EventSubscription* subscription )
+{
+    return atomic_load_explicit( &subscription->dropped,
+                                 memory_order_relaxed );
+}
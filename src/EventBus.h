@@ -0,0 +1,134 @@
+#ifndef EVENTBUS_H_
+#define EVENTBUS_H_
+/**
+ * EventBus.h
+ * Tells whoever's interested what happens in a game, without the game waiting
+ * for them.
+ *
+ * The mechanics publish an event for each thing that happens (a player
+ * turning, firing, eating, crashing, a crater being made, the game ending)
+ * on their gamestate's bus, rather than printing it. Anything that wants to
+ * know, whether to log it, keep score, show it on the HUD or count it up,
+ * subscribes to the bus, and takes the events from its subscription when it
+ * likes, on whatever thread it likes.
+ *
+ * Each subscription is a lock free ring buffer, with the game's thread the
+ * only producer and the subscriber the only consumer, so publishing an event
+ * is a copy into each subscription and never blocks, or touches the heap. If
+ * a subscriber falls so far behind that its ring is full, events are dropped
+ * (and counted) rather than the game waiting for it. With no subscribers,
+ * publishing does nothing.
+ */
+
+#include <stdatomic.h>
+#include "Player.h"
+
+/*******************************************************************************
+ * GLOBALS AND CONSTANTS
+ ******************************************************************************/
+// The events each subscription holds before dropping them (a power of two)
+#define EVENT_QUEUE_SIZE 256
+// The most subscriptions a bus takes
+#define EVENT_MAX_SUBSCRIBERS 8
+
+/*******************************************************************************
+ * TYPE DEFINITIONS
+ ******************************************************************************/
+typedef enum {
+    EVENT_TURN, // A player's chosen their next direction
+    EVENT_FIRE, // A player's fired their weapon
+    EVENT_EAT, // A player's eaten the food
+    EVENT_COLLIDE, // A player's crashed, and is out
+    EVENT_DEFORM, // A projectile's made a crater
+    EVENT_GAME_OVER, // The game's ended
+    EVENT_SCORE // A player's final score, one for each after EVENT_GAME_OVER
+} EventType;
+
+/**
+ * What a player crashed into.
+ */
+typedef enum {
+    COLLISION_WALL, COLLISION_OWN_BODY, COLLISION_BODY, COLLISION_HEAD_ON
+} CollisionType;
+
+typedef struct {
+    EventType type;
+    // The game it happened in (see GameState's generation)
+    unsigned int generation;
+    // The player it happened to, counting from 1, or 0 for none
+    int player;
+    union {
+        // EVENT_TURN: the direction they'll go in at the next grid point
+        Direction direction;
+        // EVENT_EAT and EVENT_SCORE: their score
+        int score;
+        // EVENT_COLLIDE: what they hit, and the other player involved (or 0)
+        struct {
+            CollisionType with;
+            int other;
+        } collision;
+        // EVENT_DEFORM: where the crater is, in real-space X/Z coordinates
+        struct {
+            float X, Z;
+        } crater;
+        // EVENT_GAME_OVER: the winning player, or 0 for none
+        int winner;
+    };
+} Event;
+
+/**
+ * One subscriber's events, waiting to be taken. Events are added at the tail
+ * and taken from the head; each only ever increases, and is written by one
+ * side.
+ */
+typedef struct {
+    Event events[EVENT_QUEUE_SIZE];
+    atomic_uint head, tail;
+    atomic_uint dropped; // Events that didn't fit
+} EventSubscription;
+
+typedef struct {
+    EventSubscription* subscriptions[EVENT_MAX_SUBSCRIBERS];
+    // Published after the subscription it counts is ready
+    atomic_int subscriptionCount;
+} EventBus;
+
+/*******************************************************************************
+ * CONSTRUCTORS/DESTRUCTORS
+ ******************************************************************************/
+/**
+ * Creates a bus with no subscribers.
+ */
+EventBus* EventBus_new();
+/**
+ * Deletes the bus and its subscriptions. Nothing may be using either.
+ */
+void EventBus_delete( EventBus* bus );
+
+/*******************************************************************************
+ * BUS FUNCTIONS
+ ******************************************************************************/
+/**
+ * Subscribes to the events published from now on, for as long as the bus
+ * lasts, returning the subscription to take them from, or NULL if the bus
+ * has all the subscribers it can take. May be called while events are being
+ * published, but by one thread at a time.
+ */
+EventSubscription* EventBus_subscribe( EventBus* bus );
+/**
+ * Passes a copy of the event to every subscriber. Only to be called on the
+ * game's thread.
+ */
+void EventBus_publish( EventBus* bus, const Event* event );
+/**
+ * Takes the subscription's oldest event into `event`, returning false if
+ * there are none. Only to be called by the subscriber, on one thread at a
+ * time.
+ */
+int EventSubscription_poll( EventSubscription* subscription, Event* event );
+/**
+ * Returns the number of events the subscription has dropped for being full.
+ */
+unsigned int EventSubscription_dropped( EventSubscription* subscription );
+
+#endif /*EVENTBUS_H_*/
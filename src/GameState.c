@@ -1,55 +1,349 @@
 #include "GameState.h"
 #include <stdlib.h>
+#include <stdio.h>
 
-GameState* GameState_new(  )
+// The most projectiles and edibles there may be at once
+#define PROJECTILE_POOL_SIZE 256
+#define EDIBLE_POOL_SIZE 64
+
+// Mixed into the seed of the edibles' random number stream, to keep it apart
+// from the terrain's
+#define FOOD_STREAM 0x9e3779b9u
+
+void set_player_count( GameState* gamestate, int count );
+void leave_grid( OccupancyGrid* grid, Player* player );
+void enter_grid( OccupancyGrid* grid, Player* player );
+
+GameState* GameState_new( unsigned int seed )
 {
     GameState *gamestate = (GameState*)calloc( sizeof(GameState), 1 );
     
+    GameState_seed( gamestate, seed );
+    rules_default( &gamestate->rules );
+    
+    gamestate->projectiles = ObjectPool_new( PROJECTILE_POOL_SIZE );
+    gamestate->edibles = ObjectPool_new( EDIBLE_POOL_SIZE );
+    gamestate->events = EventBus_new();
+    
     // Create the players
-    gamestate->player1 = Player_new();
-    gamestate->player2 = Player_new();
+    set_player_count( gamestate, gamestate->rules.players );
+    gamestate->playersLeft = gamestate->playerCount;
     
     return gamestate;
 }
 
 void GameState_delete( GameState* gamestate )
 {
+    int i;
+    
+    GameState_clearProjectiles(gamestate);
+    GameState_clearEdibles(gamestate);
+    
     // Delete the players
-    if( gamestate->player1 != NULL )
-    {
-        Player_delete( gamestate->player1 );
-    }
-    if( gamestate->player2 != NULL )
+    for( i = 0; i < gamestate->playerCount; i++ )
     {
-        Player_delete( gamestate->player2 );
+        Player_delete( gamestate->players[i] );
     }
+    free( gamestate->players );
+    free( gamestate->playerProjectiles );
     
-    GameState_clearProjectiles(gamestate);
-    GameState_clearEdibles(gamestate);
+    ObjectPool_delete( gamestate->projectiles );
+    ObjectPool_delete( gamestate->edibles );
     
     // Delete the landscape
     Landscape_delete( gamestate->landscape );
+    OccupancyGrid_delete( gamestate->occupancy );
+    SpatialHash_delete( gamestate->heads );
+    EventBus_delete( gamestate->events );
+    
+    free(gamestate);
+}
+
+void GameState_seed( GameState* gamestate, unsigned int seed )
+{
+    // The terrain's stream is the one the seed has always given
+    random_seed( &gamestate->terrainRandom, seed );
+    random_seed( &gamestate->foodRandom, seed ^ FOOD_STREAM );
 }
 
 void GameState_clearProjectiles( GameState* gamestate )
 {
-    Object_delete(gamestate->player1_projectile);
-    Object_delete(gamestate->player2_projectile);
-    gamestate->player1_projectile = NULL;
-    gamestate->player2_projectile = NULL;
+    int i;
+    
+    for( i = 0; i < gamestate->playerCount; i++ )
+    {
+        ObjectPool_despawn( gamestate->projectiles,
+                            gamestate->playerProjectiles[i] );
+        gamestate->playerProjectiles[i] = OBJECT_NONE;
+    }
 }
 
 void GameState_clearEdibles( GameState* gamestate )
 {
-    Object_delete(gamestate->edible);
-    gamestate->edible = NULL;
+    ObjectPool_despawn( gamestate->edibles, gamestate->edible );
+    gamestate->edible = OBJECT_NONE;
 }
 
 void GameState_clearPlayers( GameState* gamestate )
 {
-    Player_delete(gamestate->player1);
-    gamestate->player1 = Player_new();
-    Player_delete(gamestate->player2);
-    gamestate->player2 = Player_new();
+    int i;
+    
+    for( i = 0; i < gamestate->playerCount; i++ )
+    {
+        Player_delete( gamestate->players[i] );
+        gamestate->players[i] = Player_new(i);
+    }
+    set_player_count( gamestate, gamestate->rules.players );
+    gamestate->playersLeft = gamestate->playerCount;
+    
+    if( gamestate->heads != NULL )
+        SpatialHash_clear( gamestate->heads );
+}
+
+Player* GameState_player( GameState* gamestate, int player_id )
+{
+    if( player_id < 1 || player_id > gamestate->playerCount )
+        return NULL;
+    
+    return gamestate->players[player_id - 1];
+}
+
+void GameState_indexHeads( GameState* gamestate )
+{
+    Landscape* landscape = gamestate->landscape;
+    Player* player;
+    // Heads collide within two radii of each other, so cells that wide need
+    // only the cells around a head searched
+    float cell_size = 2.0f * gamestate->rules.playerRadius *
+                      landscape->gridDivisionWidth;
+    int i;
+    
+    if( cell_size < landscape->gridDivisionWidth )
+        cell_size = landscape->gridDivisionWidth;
+    
+    if( gamestate->heads != NULL &&
+        ( gamestate->heads->items != gamestate->playerCount ||
+          gamestate->heads->cellSize != cell_size ||
+          gamestate->heads->west != landscape->westBound ||
+          gamestate->heads->south != landscape->southBound ) )
+    {
+        SpatialHash_delete( gamestate->heads );
+        gamestate->heads = NULL;
+    }
+    if( gamestate->heads == NULL )
+    {
+        gamestate->heads = SpatialHash_new( landscape->westBound,
+                                            landscape->southBound,
+                                            landscape->worldWidth,
+                                            landscape->worldDepth,
+                                            cell_size,
+                                            gamestate->playerCount );
+    }
+    
+    SpatialHash_clear( gamestate->heads );
+    for( i = 0; i < gamestate->playerCount; i++ )
+    {
+        player = gamestate->players[i];
+        if( !player->out )
+        {
+            SpatialHash_place( gamestate->heads, i, player->headPosition[0],
+                               player->headPosition[2] );
+        }
+    }
+}
+
+GameStateSnapshot* GameStateSnapshot_new()
+{
+    GameStateSnapshot* snapshot =
+        (GameStateSnapshot*)calloc( sizeof(GameStateSnapshot), 1 );
+    
+    // The players are made as they're needed
+    snapshot->projectiles = ObjectPool_new( PROJECTILE_POOL_SIZE );
+    snapshot->edibles = ObjectPool_new( EDIBLE_POOL_SIZE );
+    
+    return snapshot;
+}
+
+void GameStateSnapshot_delete( GameStateSnapshot* snapshot )
+{
+    int i;
+    
+    for( i = 0; i < snapshot->playerCount; i++ )
+        Player_delete( snapshot->players[i] );
+    free( snapshot->players );
+    free( snapshot->playerProjectiles );
+    ObjectPool_delete( snapshot->projectiles );
+    ObjectPool_delete( snapshot->edibles );
+    Landscape_delete( snapshot->landscape );
+    free(snapshot);
+}
+
+int GameState_snapshot( GameState* gamestate, GameStateSnapshot* snapshot )
+{
+    int i;
+    
+    if( gamestate->landscape == NULL )
+    {
+        fprintf( stderr, "Can't take a snapshot before the game's begun\n" );
+        return 0;
+    }
+    
+    // Keep the snapshot's players if there are enough of them
+    if( snapshot->playerCount < gamestate->playerCount )
+    {
+        snapshot->players = (Player**)realloc( snapshot->players,
+            sizeof(Player*) * gamestate->playerCount );
+        snapshot->playerProjectiles = (ObjectHandle*)realloc(
+            snapshot->playerProjectiles,
+            sizeof(ObjectHandle) * gamestate->playerCount );
+        for( i = snapshot->playerCount; i < gamestate->playerCount; i++ )
+            snapshot->players[i] = Player_new(i);
+        snapshot->playerCount = gamestate->playerCount;
+    }
+    
+    snapshot->gamestate = *gamestate;
+    for( i = 0; i < gamestate->playerCount; i++ )
+    {
+        Player_assign( snapshot->players[i], gamestate->players[i] );
+        snapshot->playerProjectiles[i] = gamestate->playerProjectiles[i];
+    }
+    ObjectPool_assign( snapshot->projectiles, gamestate->projectiles );
+    ObjectPool_assign( snapshot->edibles, gamestate->edibles );
+    if( snapshot->landscape == NULL )
+        snapshot->landscape = Landscape_copy( gamestate->landscape );
+    else
+        Landscape_assign( snapshot->landscape, gamestate->landscape );
+    
+    return 1;
 }
 
+void GameState_restore( GameState* gamestate, GameStateSnapshot* snapshot )
+{
+    GameState live = *gamestate;
+    Landscape* landscape = snapshot->landscape;
+    // The snapshot may hold more players than it was taken with
+    int players = snapshot->gamestate.playerCount, i;
+    
+    // Take the players off the grid, before they're replaced
+    if( live.occupancy != NULL &&
+        live.occupancy->gridWidth != landscape->gridWidth )
+    {
+        OccupancyGrid_delete( live.occupancy );
+        live.occupancy = NULL;
+    }
+    if( live.occupancy == NULL )
+    {
+        live.occupancy = OccupancyGrid_new( landscape->gridWidth );
+    }
+    else
+    {
+        for( i = 0; i < live.playerCount; i++ )
+            leave_grid( live.occupancy, live.players[i] );
+    }
+    
+    // The pool's about to be replaced, so its projectiles go with it
+    for( i = 0; i < live.playerCount; i++ )
+        live.playerProjectiles[i] = OBJECT_NONE;
+    set_player_count( &live, players );
+    for( i = 0; i < players; i++ )
+    {
+        Player_assign( live.players[i], snapshot->players[i] );
+        live.playerProjectiles[i] = snapshot->playerProjectiles[i];
+    }
+    ObjectPool_assign( live.projectiles, snapshot->projectiles );
+    ObjectPool_assign( live.edibles, snapshot->edibles );
+    if( live.landscape == NULL )
+        live.landscape = Landscape_copy(landscape);
+    else
+        Landscape_assign( live.landscape, landscape );
+    
+    // The grid isn't saved, since it can be worked out from the players
+    for( i = 0; i < players; i++ )
+        enter_grid( live.occupancy, live.players[i] );
+    
+    // Take the saved fields, but keep our own players, pools and landscape
+    *gamestate = snapshot->gamestate;
+    gamestate->events = live.events;
+    gamestate->players = live.players;
+    gamestate->playerProjectiles = live.playerProjectiles;
+    gamestate->projectiles = live.projectiles;
+    gamestate->edibles = live.edibles;
+    gamestate->landscape = live.landscape;
+    gamestate->occupancy = live.occupancy;
+    gamestate->heads = live.heads;
+    
+    // Nor is the heads hash
+    GameState_indexHeads(gamestate);
+}
+
+/**
+ * Makes the gamestate's players up to `count` (at least one), making new
+ * players or deleting the last ones, with their projectiles, as need be.
+ */
+void set_player_count( GameState* gamestate, int count )
+{
+    int i;
+    
+    if( count < 1 )
+        count = 1;
+    if( count == gamestate->playerCount )
+        return;
+    
+    for( i = count; i < gamestate->playerCount; i++ )
+    {
+        Player_delete( gamestate->players[i] );
+        ObjectPool_despawn( gamestate->projectiles,
+                            gamestate->playerProjectiles[i] );
+    }
+    
+    gamestate->players = (Player**)realloc( gamestate->players,
+                                            sizeof(Player*) * count );
+    gamestate->playerProjectiles =
+        (ObjectHandle*)realloc( gamestate->playerProjectiles,
+                                sizeof(ObjectHandle) * count );
+    for( i = gamestate->playerCount; i < count; i++ )
+    {
+        gamestate->players[i] = Player_new(i);
+        gamestate->playerProjectiles[i] = OBJECT_NONE;
+    }
+    
+    gamestate->playerCount = count;
+}
+
+/**
+ * Takes each of the player's joints off the grid. Players out of the game
+ * aren't on it.
+ */
+void leave_grid( OccupancyGrid* grid, Player* player )
+{
+    int* joint;
+    int i;
+    
+    if( player->out )
+        return;
+    
+    for( i = 0; i < player->jointCount; i++ )
+    {
+        joint = Player_joint( player, i );
+        OccupancyGrid_leave( grid, joint[0], joint[1], player->number );
+    }
+}
+
+/**
+ * Puts each of the player's joints on the grid, oldest first.
+ */
+void enter_grid( OccupancyGrid* grid, Player* player )
+{
+    int* joint;
+    int i;
+    
+    if( player->out )
+        return;
+    
+    for( i = player->jointCount - 1; i >= 0; i-- )
+    {
+        joint = Player_joint( player, i );
+        OccupancyGrid_enter( grid, joint[0], joint[1], player->number,
+                             player->jointsLaid - 1 - i );
+    }
+}
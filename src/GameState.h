@@ -4,11 +4,22 @@
  * GameState.h
  * This module defines the Gamestate object, responsible for holding all data
  * used to determine the state of the game.
+ *
+ * A gamestate can be saved to a snapshot and restored from it later, any
+ * number of times, e.g. to search ahead from a position or roll a game back.
+ * A snapshot is made once and refilled, so, once it's big enough, taking one
+ * allocates nothing. Snapshots share the landscape's terrain rather than
+ * copying it (see Landscape.h), so take microseconds, and restoring one only
+ * repoints the terrain that's changed since.
  */
 
 #include "Player.h"
 #include "Landscape.h"
-#include "Object.h"
+#include "ObjectPool.h"
+#include "OccupancyGrid.h"
+#include "SpatialHash.h"
+#include "EventBus.h"
+#include "rules.h"
 
 typedef enum {
     MODE_MENU, MODE_COUNTDOWN, MODE_RUNNING, MODE_PAUSED, MODE_FINISHED
@@ -21,27 +32,107 @@ typedef enum {
 typedef struct {
     GameMode mode; // The mode of the game (playing, paused, menu etc.)
     float countdown; // The number of seconds before the game starts
+    unsigned int generation; // Counts the games played with this gamestate
+    // Where the game's random numbers come from: a stream for each purpose,
+    // so that drawing more numbers for one doesn't change the other's
+    Random terrainRandom; // For generating landscapes
+    Random foodRandom; // For placing edibles
+    Rules rules; // The numbers the game is played by
     
-    // The game's players
-    Player* player1;
-    Player* player2;
+    // How the last game ended: the winning player (counting from 1), or 0 for
+    // none
+    int winner;
+    // The craters made in the landscape this game
+    unsigned int deformations;
+    
+    // The game's players, as many as the rules say, and how many of them are
+    // still in the game. Player 1 is players[0].
+    Player** players;
+    int playerCount;
+    int playersLeft;
     // The speed players travel, in distance units per second
     float playerSpeed;
     
-    // Each player may have one projectile in existance at a time
-    Projectile* player1_projectile;
-    Projectile* player2_projectile;
+    // The projectiles and edibles in the game live in these pools
+    ObjectPool* projectiles;
+    ObjectPool* edibles;
+    
+    // Each player may have one projectile in existance at a time, so there's a
+    // handle for each player
+    ObjectHandle* playerProjectiles;
     
     // There is only ever one edible in the game at a time
-    Edible* edible;
+    ObjectHandle edible;
     
     Landscape* landscape; // The landscape
+    // The players' bodies on the landscape grid (player 1 is player 0)
+    OccupancyGrid* occupancy;
+    // Where the players' heads are (player 1 is item 0), so that heads can
+    // find the others near them without looking at every player
+    SpatialHash* heads;
+    
+    // What happens in the game is published here, for anyone to follow
+    EventBus* events;
 } GameState;
 
-GameState* GameState_new( /* params */ );
+/**
+ * A saved gamestate (see GameState_snapshot).
+ */
+typedef struct {
+    // The gamestate's own fields; its pointers are left as they were
+    GameState gamestate;
+    // Copies of the players, their projectiles' handles, the pools and the
+    // landscape
+    Player** players;
+    ObjectHandle* playerProjectiles;
+    int playerCount;
+    ObjectPool* projectiles;
+    ObjectPool* edibles;
+    Landscape* landscape;
+} GameStateSnapshot;
+
+/**
+ * Creates a gamestate, whose random numbers start from `seed`.
+ */
+GameState* GameState_new( unsigned int seed );
 void GameState_delete( GameState* gamestate );
+/**
+ * Starts the gamestate's random number streams afresh from `seed`.
+ */
+void GameState_seed( GameState* gamestate, unsigned int seed );
 void GameState_clearProjectiles( GameState* gamestate );
 void GameState_clearEdibles( GameState* gamestate );
+/**
+ * Replaces the players with new ones, as many as the rules say.
+ */
 void GameState_clearPlayers( GameState* gamestate );
+/**
+ * Returns the player with the given id (counting from 1), or NULL if there's
+ * no such player.
+ */
+Player* GameState_player( GameState* gamestate, int player_id );
+/**
+ * Puts the heads of the players still in the game in the gamestate's heads
+ * hash, which is made to fit the landscape and players if need be.
+ */
+void GameState_indexHeads( GameState* gamestate );
+
+/**
+ * Creates an empty snapshot, to be filled by GameState_snapshot.
+ */
+GameStateSnapshot* GameStateSnapshot_new();
+void GameStateSnapshot_delete( GameStateSnapshot* snapshot );
+/**
+ * Saves the state of the gamestate's game to `snapshot`, replacing whatever
+ * it held. Returns false if no game's begun (see new_game).
+ */
+int GameState_snapshot( GameState* gamestate, GameStateSnapshot* snapshot );
+/**
+ * Puts the gamestate back as it was when `snapshot` was taken, which may have
+ * been from another gamestate. Playing on from there plays exactly as it
+ * would have from the snapshot (see mechanics.h). The gamestate keeps its
+ * own event bus, and its subscribers.
+ */
+void GameState_restore( GameState* gamestate, GameStateSnapshot* snapshot );
 
 #endif /*GAMESTATE_H_*/
@@ -0,0 +1,235 @@
+#include "Horizon.h"
+#include <stdlib.h>
+#include <float.h>
+#include <math.h>
+
+/*******************************************************************************
+ * GLOBALS AND CONSTANTS
+ ******************************************************************************/
+// Directions are measured by a cheap stand-in for their angle, which goes
+// from 0 to DIRECTIONS once around (see `pseudo_angle`)
+#define DIRECTIONS 4.0f
+
+// A margin, in sectors, for rounding in the angles: occluders are taken to
+// cover a little less than they do, and what's tested a little more
+#define SPAN_MARGIN 0.01f
+
+
+/*******************************************************************************
+ * INTERNAL FUNCTION PROTOTYPES
+ ******************************************************************************/
+int angular_span( Horizon* horizon, float min[3], float max[3],
+                  float* first, float* last );
+float pseudo_angle( float x, float z );
+void footprint_distances( Horizon* horizon, float min[3], float max[3],
+                          float* nearest, float* furthest );
+
+
+/*******************************************************************************
+ * CONSTRUCTORS/DESTRUCTORS
+ ******************************************************************************/
+Horizon* Horizon_new()
+{
+    Horizon* horizon = (Horizon*)malloc( sizeof(Horizon) );
+    int i;
+
+    for( i = 0; i < HORIZON_SECTORS * HORIZON_BANDS; i++ )
+        horizon->slopes[i] = -FLT_MAX;
+    for( i = 0; i < HORIZON_SECTORS; i++ )
+        horizon->blocking[i] = 0;
+
+    return horizon;
+}
+
+void Horizon_delete( Horizon* horizon )
+{
+    free(horizon);
+}
+
+
+/*******************************************************************************
+ * HORIZON FUNCTIONS
+ ******************************************************************************/
+void Horizon_begin( Horizon* horizon, float eye[3], float reach )
+{
+    int sector, band;
+
+    horizon->eye[0] = eye[0];
+    horizon->eye[1] = eye[1];
+    horizon->eye[2] = eye[2];
+    horizon->bandWidth = reach / (HORIZON_BANDS - 1);
+    if( horizon->bandWidth <= 0.0f )
+        horizon->bandWidth = 1.0f;
+
+    // Only sectors with occluders in them need clearing
+    for( sector = 0; sector < HORIZON_SECTORS; sector++ )
+    {
+        if( !horizon->blocking[sector] )
+            continue;
+        for( band = 0; band < HORIZON_BANDS; band++ )
+            horizon->slopes[sector * HORIZON_BANDS + band] = -FLT_MAX;
+        horizon->blocking[sector] = 0;
+    }
+}
+
+void Horizon_addOccluder( Horizon* horizon, float min[3], float max[3] )
+{
+    float first, last, nearest, furthest, rise, slope, *blocked;
+    int band, sector, index;
+
+    // An occluder around the eye blocks nothing, since the eye's above it
+    if( !angular_span( horizon, min, max, &first, &last ) )
+        return;
+
+    footprint_distances( horizon, min, max, &nearest, &furthest );
+    band = (int)ceilf( furthest / horizon->bandWidth );
+    if( band >= HORIZON_BANDS )
+        return;
+
+    // Every line of sight in the occluder's directions passes through it, so
+    // dips below its top somewhere in it if it's below the top at the far
+    // side (for a top above the eye) or the near side (below)
+    rise = min[1] - horizon->eye[1];
+    slope = rise / (rise > 0.0f ? furthest : nearest);
+
+    // Only sectors entirely within the occluder's directions are blocked
+    for( sector = (int)ceilf( first + SPAN_MARGIN );
+         sector + 1 <= (int)floorf( last - SPAN_MARGIN ); sector++ )
+    {
+        index = (sector + HORIZON_SECTORS) % HORIZON_SECTORS;
+        blocked = &horizon->slopes[index * HORIZON_BANDS + band];
+        if( slope > *blocked )
+            *blocked = slope;
+        horizon->blocking[index] = 1;
+    }
+}
+
+void Horizon_end( Horizon* horizon )
+{
+    float* slopes;
+    int sector, band;
+
+    // Whatever blocks the view of one band blocks the view of those beyond
+    for( sector = 0; sector < HORIZON_SECTORS; sector++ )
+    {
+        if( !horizon->blocking[sector] )
+            continue;
+        slopes = &horizon->slopes[sector * HORIZON_BANDS];
+        for( band = 1; band < HORIZON_BANDS; band++ )
+        {
+            if( slopes[band - 1] > slopes[band] )
+                slopes[band] = slopes[band - 1];
+        }
+    }
+}
+
+int Horizon_hides( Horizon* horizon, float min[3], float max[3] )
+{
+    float first, last, nearest, furthest, rise, slope;
+    int band, sector, last_sector;
+
+    if( !angular_span( horizon, min, max, &first, &last ) )
+        return 0;
+
+    footprint_distances( horizon, min, max, &nearest, &furthest );
+    band = (int)(nearest / horizon->bandWidth);
+    if( band >= HORIZON_BANDS )
+        band = HORIZON_BANDS - 1;
+
+    // The steepest line of sight to any part of the box
+    rise = max[1] - horizon->eye[1];
+    slope = rise / (rise > 0.0f ? nearest : furthest);
+
+    last_sector = (int)floorf( last + SPAN_MARGIN );
+    sector = (int)floorf( first - SPAN_MARGIN );
+    if( last_sector - sector >= HORIZON_SECTORS )
+        return 0;
+    for( ; sector <= last_sector; sector++ )
+    {
+        if( slope >= horizon->slopes[((sector + HORIZON_SECTORS) %
+                                      HORIZON_SECTORS) * HORIZON_BANDS +
+                                     band] )
+            return 0;
+    }
+
+    return 1;
+}
+
+
+/*******************************************************************************
+ * INTERNAL FUNCTIONS
+ ******************************************************************************/
+/**
+ * Finds the directions from the eye to a box, in sectors: the box lies
+ * between the directions `first` and `last`, where `last` may run on past
+ * the last sector and `first` back before the first. Returns false if the
+ * eye is over the box, so that it's in every direction.
+ */
+int angular_span( Horizon* horizon, float min[3], float max[3],
+                  float* first, float* last )
+{
+    float centre, angle, low = 0.0f, high = 0.0f;
+    int corner;
+
+    if( horizon->eye[0] >= min[0] && horizon->eye[0] <= max[0] &&
+        horizon->eye[2] >= min[2] && horizon->eye[2] <= max[2] )
+        return 0;
+
+    // Measure the corners' directions from the centre's, so the span doesn't
+    // break where the directions wrap around
+    centre = pseudo_angle( (min[0] + max[0]) / 2.0f - horizon->eye[0],
+                           (min[2] + max[2]) / 2.0f - horizon->eye[2] );
+    for( corner = 0; corner < 4; corner++ )
+    {
+        angle = pseudo_angle( (corner & 1 ? max[0] : min[0]) - horizon->eye[0],
+                              (corner & 2 ? max[2] : min[2]) -
+                                  horizon->eye[2] ) - centre;
+        if( angle > DIRECTIONS / 2.0f )
+            angle -= DIRECTIONS;
+        else if( angle < -DIRECTIONS / 2.0f )
+            angle += DIRECTIONS;
+
+        if( corner == 0 || angle < low )
+            low = angle;
+        if( corner == 0 || angle > high )
+            high = angle;
+    }
+
+    *first = (centre + low) * HORIZON_SECTORS / DIRECTIONS;
+    *last = (centre + high) * HORIZON_SECTORS / DIRECTIONS;
+    return 1;
+}
+
+/**
+ * Measures the direction of (x, z) from the origin, from 0 up to DIRECTIONS
+ * anticlockwise from the X axis. It isn't the angle, but goes up and down
+ * with it, which is all sectors need, and costs no trigonometry.
+ */
+float pseudo_angle( float x, float z )
+{
+    if( z >= 0.0f )
+        return x >= 0.0f ? z / (x + z) : 1.0f - x / (z - x);
+    else
+        return x < 0.0f ? 2.0f - z / (-x - z) : 3.0f + x / (x - z);
+}
+
+/**
+ * Finds the nearest and furthest a box is from the eye, across the ground.
+ */
+void footprint_distances( Horizon* horizon, float min[3], float max[3],
+                          float* nearest, float* furthest )
+{
+    float near_x, near_z, far_x, far_z;
+
+    near_x = fmaxf( fmaxf( min[0] - horizon->eye[0], 0.0f ),
+                    horizon->eye[0] - max[0] );
+    near_z = fmaxf( fmaxf( min[2] - horizon->eye[2], 0.0f ),
+                    horizon->eye[2] - max[2] );
+    far_x = fmaxf( fabsf( min[0] - horizon->eye[0] ),
+                   fabsf( max[0] - horizon->eye[0] ) );
+    far_z = fmaxf( fabsf( min[2] - horizon->eye[2] ),
+                   fabsf( max[2] - horizon->eye[2] ) );
+
+    *nearest = sqrtf( near_x * near_x + near_z * near_z );
+    *furthest = sqrtf( far_x * far_x + far_z * far_z );
+}
@@ -0,0 +1,76 @@
+#ifndef HORIZON_H_
+#define HORIZON_H_
+/**
+ * Horizon.h
+ * What the landscape hides from an eye above it.
+ *
+ * The eye is above the landscape, so anything below the landscape's surface
+ * is out of sight, and a line of sight that dips below it on the way to
+ * something hides that thing. A horizon is built from occluders: boxes of
+ * the ground known to be solid up to some height (each a patch of the
+ * landscape, up to its lowest point). Looking out from the eye, in each
+ * direction and out to each distance, it keeps the steepest line of sight
+ * (as rise over distance) that the occluders are certain to block. Anything
+ * seen only along lines of sight lower than that, and further away than the
+ * occluders blocking them, is hidden.
+ *
+ * A horizon is built afresh for each view:
+ *
+ *     Horizon_begin( horizon, eye, reach );
+ *     for each occluder: Horizon_addOccluder( horizon, min, max );
+ *     Horizon_end( horizon );
+ *
+ * and then asked what it hides with Horizon_hides. It's conservative: it may
+ * say something's visible when it isn't, but never the other way around.
+ */
+
+/*******************************************************************************
+ * TYPE DEFINITIONS
+ ******************************************************************************/
+// The directions around the eye, and the distances from it, the horizon is
+// kept for
+#define HORIZON_SECTORS 512
+#define HORIZON_BANDS 32
+
+typedef struct {
+    float eye[3];
+    // The distance covered by each band
+    float bandWidth;
+    // The steepest blocked line of sight, in each sector, for things at least
+    // as far away as each band, sector by sector
+    float slopes[HORIZON_SECTORS * HORIZON_BANDS];
+    // Whether any occluder has been added to each sector (the others block
+    // nothing)
+    unsigned char blocking[HORIZON_SECTORS];
+} Horizon;
+
+/*******************************************************************************
+ * CONSTRUCTORS/DESTRUCTORS
+ ******************************************************************************/
+Horizon* Horizon_new();
+void Horizon_delete( Horizon* horizon );
+
+/*******************************************************************************
+ * HORIZON FUNCTIONS
+ ******************************************************************************/
+/**
+ * Starts a new horizon around `eye`, with nothing hidden. Occluders further
+ * than `reach` from the eye are ignored.
+ */
+void Horizon_begin( Horizon* horizon, float eye[3], float reach );
+/**
+ * Adds an occluder: the ground between the corners `min` and `max` (in X and
+ * Z) is solid up to the height min[1].
+ */
+void Horizon_addOccluder( Horizon* horizon, float min[3], float max[3] );
+/**
+ * Finishes the horizon, once every occluder has been added.
+ */
+void Horizon_end( Horizon* horizon );
+/**
+ * Returns true if the box between the corners `min` and `max` is certainly
+ * hidden from the eye by the occluders.
+ */
+int Horizon_hides( Horizon* horizon, float min[3], float max[3] );
+
+#endif /*HORIZON_H_*/
@@ -1,5 +1,7 @@
 #include "Landscape.h"
 #include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
 #include "maths.h"
 #include <math.h>
 
@@ -12,6 +14,25 @@
 #define THRES_SNOW 0.9
 #define THRES_MOUNT 0.6
 
+/**
+ * A chunk of rows of a landscape's maps: the points, colours and normals of
+ * `rows` rows, row after row, in a single allocation.
+ *
+ * A chunk may be shared by any number of landscapes, on any threads, and is
+ * freed once none of them refer to it. A shared chunk never changes, so only
+ * a chunk with a single reference may be written to.
+ */
+struct LandscapeChunk {
+    atomic_int references;
+    int rows;
+    Point* points;
+    Color* colors;
+    Normal* normals;
+};
+
+// The last version given to a change to any landscape
+atomic_uint landscape_version = 0;
+
 
 /*******************************************************************************
  * INTERNAL FUNCTION PROTOTYPES
@@ -20,19 +41,22 @@ Normal* Normal_new( float X, float Y, float Z );
 Point* Point_new( float X, float Y, float Z );
 Color* Color_new( float, float, float, float );
 
-ColorMap* ColorMap_new( int width );
-PointMap* PointMap_new( int width );
-NormalMap* NormalMap_new( int width );
-
-void ColorMap_delete( ColorMap*, int );
-void NormalMap_delete( NormalMap*, int );
-void PointMap_delete( PointMap*, int );
+LandscapeChunk* chunk_new( int rows, int width );
+LandscapeChunk* chunk_copy( LandscapeChunk* chunk, int width );
+void chunk_release( LandscapeChunk* chunk );
+void set_chunk( Landscape* landscape, int index, LandscapeChunk* chunk );
+void allocate_rows( Landscape* landscape, int grid_width );
+void free_rows( Landscape* landscape );
+unsigned int next_version();
+double next_crossing( Landscape* landscape, float position, float velocity,
+                      int cell );
+int arc_meets_ground( float height, float Y, float rise, double gravity,
+                      double from, double to, double* hit );
 
 
-float bounded_random( float max, float min );
-float displace( float rand_effect_size );
+float displace( Random* random, float rand_effect_size );
 void fractalIteration( int Ax, int Ay, int fsize,float rand_effect_size,
-                       Landscape* landscape );
+                       Landscape* landscape, Random* random );
 void set_point( Landscape* landscape, int row, int column,
                 float X, float Y, float Z );
 /**
@@ -56,7 +80,6 @@ void calcAverageNormal2( float n1[3], float n2[3], float result[3] );
 void calcAverageNormal4( float n1[3], float n2[3], float n3[3], float n4[3],
                          float result[3] );
 void normaliseVector( float normalvector[3] );
-float displace(float rand_effect_size);
 
 /*******************************************************************************
  * PUBLIC FUNCTIONS
@@ -67,11 +90,21 @@ Landscape* Landscape_new( int grid_width,
                           float world_width, float world_depth )
 {
     Landscape* landscape = (Landscape*)malloc( sizeof(Landscape) );
+    int i, rows;
     
-    landscape->gridWidth = grid_width;
-    landscape->pointMap = *PointMap_new(grid_width);
-    landscape->colorMap = *ColorMap_new(grid_width);
-    landscape->normalMap = *NormalMap_new(grid_width);
+    allocate_rows( landscape, grid_width );
+    for( i = 0; i < landscape->chunkCount; i++ )
+    {
+        rows = grid_width - i * LANDSCAPE_CHUNK_ROWS;
+        set_chunk( landscape, i, chunk_new( rows < LANDSCAPE_CHUNK_ROWS ?
+                                            rows : LANDSCAPE_CHUNK_ROWS,
+                                            grid_width ) );
+    }
+    
+    // A new landscape is unlike any other, so has a version of its own
+    landscape->version = next_version();
+    for( i = 0; i < grid_width; i++ )
+        landscape->rowVersions[i] = landscape->version;
     
     /* Calculate world dimensions */
     landscape->worldWidth = world_width;
@@ -92,22 +125,70 @@ Landscape* Landscape_new( int grid_width,
     return landscape;
 }
 
+Landscape* Landscape_copy( Landscape* landscape )
+{
+    Landscape* copy = (Landscape*)malloc( sizeof(Landscape) );
+    
+    allocate_rows( copy, landscape->gridWidth );
+    Landscape_assign( copy, landscape );
+    
+    return copy;
+}
+
 void Landscape_delete( Landscape* landscape )
 {
     if( landscape == NULL )
         return;
     
-    if( landscape->colorMap != NULL )
-        ColorMap_delete( &landscape->colorMap, landscape->gridWidth );
-    if( landscape->pointMap != NULL )
-        PointMap_delete( &landscape->pointMap, landscape->gridWidth );
-    if( landscape->normalMap != NULL )
-        NormalMap_delete( &landscape->normalMap, landscape->gridWidth );
-    
+    free_rows( landscape );
     free( landscape );
 }
 
-void Landscape_generate( Landscape* landscape )
+void Landscape_assign( Landscape* landscape, Landscape* source )
+{
+    PointMap point_map;
+    ColorMap color_map;
+    NormalMap normal_map;
+    unsigned int* row_versions;
+    LandscapeChunk** chunks;
+    int i;
+    
+    if( landscape == source )
+        return;
+    
+    if( landscape->gridWidth != source->gridWidth )
+    {
+        free_rows( landscape );
+        allocate_rows( landscape, source->gridWidth );
+    }
+    
+    for( i = 0; i < source->chunkCount; i++ )
+    {
+        if( landscape->chunks[i] == source->chunks[i] )
+            continue;
+        
+        atomic_fetch_add( &source->chunks[i]->references, 1 );
+        chunk_release( landscape->chunks[i] );
+        set_chunk( landscape, i, source->chunks[i] );
+    }
+    memcpy( landscape->rowVersions, source->rowVersions,
+            sizeof(unsigned int) * source->gridWidth );
+    
+    // Take the bounds, heights and version, but keep our own rows
+    point_map = landscape->pointMap;
+    color_map = landscape->colorMap;
+    normal_map = landscape->normalMap;
+    row_versions = landscape->rowVersions;
+    chunks = landscape->chunks;
+    *landscape = *source;
+    landscape->pointMap = point_map;
+    landscape->colorMap = color_map;
+    landscape->normalMap = normal_map;
+    landscape->rowVersions = row_versions;
+    landscape->chunks = chunks;
+}
+
+void Landscape_generate( Landscape* landscape, Random* random )
 {
     int fsize, size;
     float range,rand_effect_size,cornerA,cornerB,cornerC,cornerD,midheight;
@@ -119,13 +200,13 @@ void Landscape_generate( Landscape* landscape )
     // The new size of the fractal iteration
     rand_effect_size = range;
     
-    cornerA = bounded_random(landscape->maxHeight,landscape->minHeight);
-    cornerB = bounded_random(landscape->maxHeight,landscape->minHeight);
-    cornerC = bounded_random(landscape->maxHeight,landscape->minHeight);
-    cornerD = bounded_random(landscape->maxHeight,landscape->minHeight);
+    cornerA = bounded_random(random,landscape->maxHeight,landscape->minHeight);
+    cornerB = bounded_random(random,landscape->maxHeight,landscape->minHeight);
+    cornerC = bounded_random(random,landscape->maxHeight,landscape->minHeight);
+    cornerD = bounded_random(random,landscape->maxHeight,landscape->minHeight);
 
     midheight = ((cornerA+cornerB+cornerC+cornerD)/4.0f)
-                + (displace(rand_effect_size));
+                + (displace(random, rand_effect_size));
 
     // Assigns the corners from bottom left as A anticlockwise to form square
     // ABCD
@@ -143,28 +224,28 @@ void Landscape_generate( Landscape* landscape )
     
         set_height( landscape, size, 0,
                     (cornerA + cornerB + midheight) / 3.0f
-                        + (displace(rand_effect_size)) );
+                        + (displace(random, rand_effect_size)) );
         
         set_height( landscape, fsize, size,
                     (cornerB + cornerC + midheight) / 3.0f
-                        + (displace(rand_effect_size)) );
+                        + (displace(random, rand_effect_size)) );
         
         set_height( landscape, size, fsize,
                     (cornerD + cornerC + midheight)/3
-                        + (displace(rand_effect_size)) );
+                        + (displace(random, rand_effect_size)) );
         set_height( landscape, 0, size,
                     (cornerA + cornerD + midheight)/3 
-                        + (displace(rand_effect_size)) );
+                        + (displace(random, rand_effect_size)) );
        
         rand_effect_size *= ROUGHNESS;
     
-        fractalIteration(0,0,       size,   rand_effect_size, landscape); 
+        fractalIteration(0,0,       size,   rand_effect_size, landscape, random); 
         // -x, -y   quad
-        fractalIteration(size,0,    size,   rand_effect_size, landscape); 
+        fractalIteration(size,0,    size,   rand_effect_size, landscape, random); 
         // x, -y    quad
-        fractalIteration(0,size,    size,   rand_effect_size, landscape);
+        fractalIteration(0,size,    size,   rand_effect_size, landscape, random);
         // -x, y    quad
-        fractalIteration(size,size, size,   rand_effect_size, landscape); 
+        fractalIteration(size,size, size,   rand_effect_size, landscape, random); 
         // x, y     quad
     }
     
@@ -199,6 +280,37 @@ int Landscape_getColumn( Landscape* landscape, float Z){
     return (Z - landscape->southBound) / (float)landscape->gridDivisionWidth;
 }
 
+void Landscape_touchRows( Landscape* landscape, int first_row, int last_row )
+{
+    LandscapeChunk* chunk;
+    int row, i;
+    
+    if( first_row < 0 )
+        first_row = 0;
+    if( last_row >= landscape->gridWidth )
+        last_row = landscape->gridWidth - 1;
+    if( first_row > last_row )
+        return;
+    
+    // Copy the chunks the rows are in, unless they're ours alone
+    for( i = first_row / LANDSCAPE_CHUNK_ROWS;
+         i <= last_row / LANDSCAPE_CHUNK_ROWS; i++ )
+    {
+        chunk = landscape->chunks[i];
+        if( atomic_load( &chunk->references ) == 1 )
+            continue;
+        
+        set_chunk( landscape, i, chunk_copy( chunk, landscape->gridWidth ) );
+        chunk_release(chunk);
+    }
+    
+    landscape->version = next_version();
+    for( row = first_row; row <= last_row; row++ )
+    {
+        landscape->rowVersions[row] = landscape->version;
+    }
+}
+
 float Landscape_getHeight( Landscape* landscape, float X, float Z )
 {
     int row, col;
@@ -221,9 +333,255 @@ float Landscape_getHeight( Landscape* landscape, float X, float Z )
     return landscape->pointMap[row][col][1];
 }
 
+void Landscape_getHeights( Landscape* landscape, const float* X,
+                           const float* Z, int count, float* heights )
+{
+    float south = landscape->southBound;
+    float width = (float)landscape->gridDivisionWidth;
+    int last = landscape->gridWidth - 1, row, col, i;
+
+    // Landscape_getHeight, with the landscape's fields read once rather than
+    // once a position (and the same hack with the row)
+    for( i = 0; i < count; i++ )
+    {
+        row = (X[i] - south) / width;
+        col = (Z[i] - south) / width;
+        row = row < 0 ? 0 : row > last ? last : row;
+        col = col < 0 ? 0 : col > last ? last : col;
+        heights[i] = landscape->pointMap[row][col][1];
+    }
+}
+
+int Landscape_traceArc( Landscape* landscape, const float origin[3],
+                        const float velocity[3], double gravity, float from,
+                        float to, float* hit )
+{
+    // The arc's ground track is a straight line, so the cells it crosses are
+    // found a boundary at a time (as in a DDA): cell[0] is the row (along X)
+    // and cell[1] the column (along Z), as Landscape_getHeight finds them,
+    // and crossing[] the times the arc next crosses into another row and
+    // column. Every time is worked out from the start of the arc, not from
+    // `from`, so that the same arc meets the ground at the same time however
+    // its flight is divided up.
+    const int axes[2] = { 0, 2 };
+    float low[2] = { landscape->westBound, landscape->southBound },
+          high[2] = { landscape->eastBound, landscape->northBound };
+    double time = from, end = to, crossing[2], next, when;
+    int cell[2], step[2], last = landscape->gridWidth - 1, row, column, a;
+    float position, speed;
+
+    for( a = 0; a < 2; a++ )
+    {
+        position = origin[axes[a]];
+        speed = velocity[axes[a]];
+
+        // Stop where the arc leaves the landscape
+        if( speed > 0 && (high[a] - position) / speed < end )
+            end = (high[a] - position) / speed;
+        else if( speed < 0 && (low[a] - position) / speed < end )
+            end = (low[a] - position) / speed;
+
+        // The same hack as Landscape_getHeight: rows are found from the
+        // south bound too
+        cell[a] = floor( (position + speed * time - landscape->southBound) /
+                         landscape->gridDivisionWidth );
+        step[a] = speed > 0 ? 1 : speed < 0 ? -1 : 0;
+        crossing[a] = next_crossing( landscape, position, speed, cell[a] );
+    }
+
+    while( time <= end )
+    {
+        next = crossing[0] < crossing[1] ? crossing[0] : crossing[1];
+        if( next > end )
+            next = end;
+
+        row = cell[0] < 0 ? 0 : cell[0] > last ? last : cell[0];
+        column = cell[1] < 0 ? 0 : cell[1] > last ? last : cell[1];
+        if( arc_meets_ground( landscape->pointMap[row][column][1],
+                              origin[1], velocity[1], gravity, time, next,
+                              &when ) )
+        {
+            *hit = when;
+            return 1;
+        }
+        if( next >= end )
+            return 0;
+
+        // On into the next cell
+        a = crossing[0] <= crossing[1] ? 0 : 1;
+        cell[a] += step[a];
+        if( crossing[a] > time )
+            time = crossing[a];
+        crossing[a] = next_crossing( landscape, origin[axes[a]],
+                                     velocity[axes[a]], cell[a] );
+    }
+
+    return 0;
+}
+
 /*******************************************************************************
  * INTERNAL FUNCTIONS
  ******************************************************************************/
+/**
+ * Returns the time at which something starting at `position` (along X or Z)
+ * and moving at `velocity` leaves grid cell `cell`, or HUGE_VAL if it never
+ * does.
+ */
+double next_crossing( Landscape* landscape, float position, float velocity,
+                      int cell )
+{
+    if( velocity == 0 )
+        return HUGE_VAL;
+
+    // The cell's far edge, in the direction of travel
+    if( velocity > 0 )
+        cell++;
+    return (landscape->southBound + (double)cell *
+            landscape->gridDivisionWidth - position) / velocity;
+}
+
+/**
+ * Finds whether an arc, at height `Y` at time 0 and rising at `rise`,
+ * reaches `height` between times `from` and `to`, setting `hit` to when it
+ * first does.
+ */
+int arc_meets_ground( float height, float Y, float rise, double gravity,
+                      double from, double to, double* hit )
+{
+    double above = Y - (double)height, time;
+
+    // Already down, coming in to the cell (through the side of it)
+    if( above + rise * from + 0.5 * gravity * from * from <= 0 )
+    {
+        *hit = from;
+        return 1;
+    }
+
+    // Otherwise, when it comes down through `height`: the later root of
+    // above + rise * t + gravity * t^2 / 2, for gravity pulling down
+    if( gravity == 0 )
+    {
+        if( rise >= 0 )
+            return 0;
+        time = -above / rise;
+    }
+    else
+    {
+        if( rise * (double)rise - 2.0 * gravity * above < 0 )
+            return 0;
+        time = (-rise - sqrt( rise * (double)rise - 2.0 * gravity * above )) /
+               gravity;
+    }
+
+    if( time < from || time > to )
+        return 0;
+    *hit = time;
+    return 1;
+}
+
+/**
+ * Creates a chunk of `rows` rows of `width` points, all zeroes.
+ */
+LandscapeChunk* chunk_new( int rows, int width )
+{
+    int points = rows * width;
+    LandscapeChunk* chunk = (LandscapeChunk*)
+        calloc( 1, sizeof(LandscapeChunk) +
+                   points * (sizeof(Point) + sizeof(Color) + sizeof(Normal)) );
+    
+    atomic_init( &chunk->references, 1 );
+    chunk->rows = rows;
+    chunk->points = (Point*)(chunk + 1);
+    chunk->colors = (Color*)(chunk->points + points);
+    chunk->normals = (Normal*)(chunk->colors + points);
+    
+    return chunk;
+}
+
+/**
+ * Creates a copy of a chunk, for a landscape to change.
+ */
+LandscapeChunk* chunk_copy( LandscapeChunk* chunk, int width )
+{
+    LandscapeChunk* copy = chunk_new( chunk->rows, width );
+    
+    memcpy( copy->points, chunk->points,
+            chunk->rows * width *
+                (sizeof(Point) + sizeof(Color) + sizeof(Normal)) );
+    
+    return copy;
+}
+
+/**
+ * Gives up a reference to a chunk, freeing it if it was the last.
+ */
+void chunk_release( LandscapeChunk* chunk )
+{
+    if( chunk != NULL && atomic_fetch_sub( &chunk->references, 1 ) == 1 )
+        free(chunk);
+}
+
+/**
+ * Puts a chunk in the landscape, pointing the maps' rows into it.
+ */
+void set_chunk( Landscape* landscape, int index, LandscapeChunk* chunk )
+{
+    int first_row = index * LANDSCAPE_CHUNK_ROWS, i;
+    
+    landscape->chunks[index] = chunk;
+    for( i = 0; i < chunk->rows; i++ )
+    {
+        landscape->pointMap[first_row + i] =
+            chunk->points + i * landscape->gridWidth;
+        landscape->colorMap[first_row + i] =
+            chunk->colors + i * landscape->gridWidth;
+        landscape->normalMap[first_row + i] =
+            chunk->normals + i * landscape->gridWidth;
+    }
+}
+
+/**
+ * Allocates the landscape's rows and chunks for a grid of `grid_width`
+ * points, with no chunks in them yet.
+ */
+void allocate_rows( Landscape* landscape, int grid_width )
+{
+    landscape->gridWidth = grid_width;
+    landscape->chunkCount = (grid_width + LANDSCAPE_CHUNK_ROWS - 1) /
+                            LANDSCAPE_CHUNK_ROWS;
+    landscape->pointMap = (Point**)malloc( sizeof(Point*) * grid_width );
+    landscape->colorMap = (Color**)malloc( sizeof(Color*) * grid_width );
+    landscape->normalMap = (Normal**)malloc( sizeof(Normal*) * grid_width );
+    landscape->rowVersions =
+        (unsigned int*)calloc( grid_width, sizeof(unsigned int) );
+    landscape->chunks = (LandscapeChunk**)
+        calloc( landscape->chunkCount, sizeof(LandscapeChunk*) );
+}
+
+/**
+ * Releases the landscape's chunks, and frees its rows.
+ */
+void free_rows( Landscape* landscape )
+{
+    int i;
+    
+    for( i = 0; i < landscape->chunkCount; i++ )
+        chunk_release( landscape->chunks[i] );
+    free( landscape->chunks );
+    free( landscape->pointMap );
+    free( landscape->colorMap );
+    free( landscape->normalMap );
+    free( landscape->rowVersions );
+}
+
+/**
+ * Returns a version no landscape has had before.
+ */
+unsigned int next_version()
+{
+    return atomic_fetch_add( &landscape_version, 1 ) + 1;
+}
+
 /**
  * Sets the a point in the pointmap.
  */
@@ -278,12 +636,12 @@ void set_normal( Landscape* landscape, int row, int column,
 }
 
 // Produces a random value between +ve and -ve of input
-float displace(float rand_effect_size)
+float displace(Random* random, float rand_effect_size)
 {
-    return bounded_random(rand_effect_size,-rand_effect_size);
+    return bounded_random(random,rand_effect_size,-rand_effect_size);
 }
 
-void fractalIteration(int Ax, int Ay, int fsize,float rand_effect_size, Landscape* landscape)
+void fractalIteration(int Ax, int Ay, int fsize,float rand_effect_size, Landscape* landscape, Random* random)
 {
     int size = fsize/2;
     float cornerA =
@@ -295,7 +653,7 @@ void fractalIteration(int Ax, int Ay, int fsize,float rand_effect_size, Landscap
     float cornerD =
         ( *Landscape_getPoint(landscape, Ax, Ay+fsize) )[1];
     
-    float midheight = ((cornerA+cornerB+cornerC+cornerD)/4.0f);// + (displace(rand_effect_size)); // Mid-point calculations - Diamond Step
+    float midheight = ((cornerA+cornerB+cornerC+cornerD)/4.0f);// + (displace(random, rand_effect_size)); // Mid-point calculations - Diamond Step
     
     // Set the height of the centre point
     set_height( landscape, Ax + size, Ay + size,
@@ -304,31 +662,31 @@ void fractalIteration(int Ax, int Ay, int fsize,float rand_effect_size, Landscap
     if( landscape->pointMap[Ax+size][Ay][1] == 0 )
     {
         set_height( landscape, Ax + size, Ay,
-                   (cornerA+cornerB+midheight)/3 + (displace(rand_effect_size)) );
+                   (cornerA+cornerB+midheight)/3 + (displace(random, rand_effect_size)) );
     }
     if( landscape->pointMap[Ax+fsize][Ay+size][1] == 0 )
     {
         set_height( landscape, Ax+fsize, Ay+size,
-                   (cornerB+cornerC+midheight)/3 + (displace(rand_effect_size)) );
+                   (cornerB+cornerC+midheight)/3 + (displace(random, rand_effect_size)) );
     }
     if( landscape->pointMap[Ax+size][Ay+fsize][1] == 0 )
     {
         set_height( landscape, Ax+size,Ay+fsize,
-                   (cornerC+cornerD+midheight)/3 + (displace(rand_effect_size)) );
+                   (cornerC+cornerD+midheight)/3 + (displace(random, rand_effect_size)) );
     }
     if( landscape->pointMap[Ax][Ay+size][1] == 0 )
     {
         set_height( landscape, Ax, Ay+size,
-                   (cornerA+cornerD+midheight)/3 + (displace(rand_effect_size)) );
+                   (cornerA+cornerD+midheight)/3 + (displace(random, rand_effect_size)) );
     }
 
     if (size >= MINGRIDSIZE )
     {
         rand_effect_size *= ROUGHNESS;
-        fractalIteration(Ax,Ay,             size,   rand_effect_size, landscape);  // -x, -y    quad
-        fractalIteration(Ax+size,Ay,        size,   rand_effect_size, landscape);  // x, -y quad
-        fractalIteration(Ax,Ay+size,        size,   rand_effect_size, landscape);  // -x, y quad
-        fractalIteration(Ax+size,Ay+size,   size,   rand_effect_size, landscape);  // x, y      quad
+        fractalIteration(Ax,Ay,             size,   rand_effect_size, landscape, random);  // -x, -y    quad
+        fractalIteration(Ax+size,Ay,        size,   rand_effect_size, landscape, random);  // x, -y quad
+        fractalIteration(Ax,Ay+size,        size,   rand_effect_size, landscape, random);  // -x, y quad
+        fractalIteration(Ax+size,Ay+size,   size,   rand_effect_size, landscape, random);  // x, y      quad
     }
     else
     {
@@ -510,57 +868,6 @@ Normal* Normal_new( float X, float Y, float Z )
     return normal;
 }
 
-ColorMap* ColorMap_new( int width )
-{
-    int i;
-    // Create the map
-    ColorMap* colormap = (ColorMap*)malloc( sizeof(ColorMap) );
-    
-    // Create the rows
-    *colormap = (Color**)malloc( sizeof(Color*) * width );
-    for( i = 0; i < width; i++ )
-    {
-        // Create the columns
-        (*colormap)[i] = (Color*)malloc( sizeof(Color) * width );
-    }
-    
-    return colormap;
-}
-
-PointMap* PointMap_new( int width )
-{
-    int i;
-    // Create the map
-    PointMap* pointmap = (PointMap*)calloc( sizeof(PointMap), 1 );
-    
-    // Create the rows
-    *pointmap = (Point**)calloc( sizeof(Point*), width );
-    for( i = 0; i < width; i++ )
-    {
-        // Create the columns
-        (*pointmap)[i] = (Point*)calloc( sizeof(Point), width );
-    }
-    
-    return pointmap;
-}
-
-NormalMap* NormalMap_new( int width )
-{
-    int i;
-    // Create the map
-    NormalMap* normalmap = (NormalMap*)malloc( sizeof(NormalMap) );
-    
-    // Create the rows
-    *normalmap = (Normal**)malloc( sizeof(Normal*) * width );
-    for( i = 0; i < width; i++ )
-    {
-        // Create the columns
-        (*normalmap)[i] = (Normal*)malloc( sizeof(Normal) * width );
-    }
-    
-    return normalmap;
-}
-
 void set_height( Landscape* landscape, int row, int column,
                  float height )
 {
@@ -576,39 +883,3 @@ void set_height( Landscape* landscape, int row, int column,
     
     set_point( landscape, row, column, X, height, Z );
 }
-
-void ColorMap_delete( ColorMap* map, int width )
-{
-    int i, j;
-    
-    for( i = 0; i < width; i++ )
-    {
-        free( (*map)[i] );
-    }
-    
-    free( (*map) );
-}
-
-void NormalMap_delete( NormalMap* map, int width )
-{
-    int i, j;
-        
-    for( i = 0; i < width; i++ )
-    {
-        free( (*map)[i] );
-    }
-    
-    free( (*map) );
-}
-
-void PointMap_delete( PointMap* map, int width )
-{
-    int i, j;
-        
-    for( i = 0; i < width; i++ )
-    {
-        free( (*map)[i] );
-    }
-    
-    free( (*map) );
-}
\ No newline at end of file
@@ -1,6 +1,8 @@
 #ifndef LANDSCAPE_H_
 #define LANDSCAPE_H_
 
+#include "random.h"
+
 /*******************************************************************************
  * TYPE DEFINITIONS
  ******************************************************************************/
@@ -19,6 +21,12 @@ typedef Color** ColorMap;
 typedef Point** PointMap;
 typedef Normal** NormalMap;
 
+// The rows of the maps are kept in chunks of this many rows (see Landscape)
+#define LANDSCAPE_CHUNK_ROWS 8
+
+// A chunk of rows of the maps, which may be shared (see Landscape.c)
+typedef struct LandscapeChunk LandscapeChunk;
+
 // The Landscape structure
 typedef struct {
     PointMap pointMap; // Positions at each point
@@ -41,6 +49,21 @@ typedef struct {
           worldDepth, // The north-south distance across the world
           gridDivisionWidth, // The north-south distance between grid points
           gridDivisionDepth; // The east-west distance between grid points
+    
+    /* Every change to the landscape after it's generated bumps its version,
+     * and stamps the rows it touched with the new version, so that copies of
+     * the landscape need only copy the rows that have changed. Versions are
+     * drawn from a count shared by all landscapes, so a row's version stands
+     * for what's in it, even once it's been copied to another landscape. */
+    unsigned int version;
+    unsigned int* rowVersions;
+    
+    /* The maps' rows are kept in chunks of LANDSCAPE_CHUNK_ROWS rows. Copies
+     * of the landscape share its chunks, and a chunk is only copied when one
+     * of the landscapes sharing it is about to change it (see
+     * Landscape_touchRows), so copying a landscape copies no terrain. */
+    LandscapeChunk** chunks;
+    int chunkCount;
 } Landscape;
 
 
@@ -54,6 +77,11 @@ Landscape* Landscape_new( int grid_size,
                           float min_height, float max_height,
                           float south_bound, float west_bound,
                           float world_width, float world_depth );
+/**
+ * Creates a copy of a landscape, which shares its terrain until either
+ * changes it.
+ */
+Landscape* Landscape_copy( Landscape* landscape );
 /**
  * Frees a landscape structure.
  */
@@ -63,9 +91,10 @@ void Landscape_delete( Landscape* landscape );
  * LANDSCAPE FUNCTIONS
  ******************************************************************************/
 /**
- * Given a landscape structure, generates the landscape.
+ * Given a landscape structure, generates the landscape, from the numbers
+ * `random` gives.
  */
-void Landscape_generate( Landscape* landscape );
+void Landscape_generate( Landscape* landscape, Random* random );
 /**
  * Retrieves the point at grid coordinates (row, column).
  */
@@ -79,9 +108,39 @@ void Landscape_setPoint( Landscape* landscape, int row, int column,
  * Gets the height at a position, in real-space, X/Z coordinates.
  */
 float Landscape_getHeight( Landscape* landscape, float X, float Z );
+/**
+ * Gets the heights at `count` positions, given as arrays of X and of Z
+ * coordinates, into `heights`.
+ */
+void Landscape_getHeights( Landscape* landscape, const float* X,
+                           const float* Z, int count, float* heights );
+/**
+ * Follows the arc of something thrown from `origin` at `velocity` (in
+ * distance units per second), falling at `gravity` (per second per second,
+ * negative for down), from `from` to `to` seconds after it was thrown. If it
+ * meets the ground on the way, through the top of a grid cell or the side,
+ * sets `hit` to the time it first does and returns true. The arc is followed
+ * across every cell it passes over, so however far it goes in the time it
+ * can't pass through a ridge, and stops at the edge of the landscape.
+ */
+int Landscape_traceArc( Landscape* landscape, const float origin[3],
+                        const float velocity[3], double gravity, float from,
+                        float to, float* hit );
 
 int Landscape_getColumn( Landscape* landscape, float Z);
 
+/**
+ * Makes `landscape` a copy of `source`, sharing its terrain, and releasing
+ * any of its own that nothing else shares.
+ */
+void Landscape_assign( Landscape* landscape, Landscape* source );
+/**
+ * Records that rows `first_row` to `last_row` (inclusive) are about to
+ * change, first giving the landscape a copy of its own of any of their
+ * chunks it shares. Rows must be touched before they're changed.
+ */
+void Landscape_touchRows( Landscape* landscape, int first_row, int last_row );
+
 float Landscape_getHeight( Landscape* landscape, float X, float Z );
 
 #endif /*LANDSCAPE_H_*/
@@ -0,0 +1,398 @@
+#include "ObjectPool.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+/*******************************************************************************
+ * GLOBALS AND CONSTANTS
+ ******************************************************************************/
+const ObjectHandle OBJECT_NONE = { 0, 0 };
+
+
+/*******************************************************************************
+ * INTERNAL FUNCTION PROTOTYPES
+ ******************************************************************************/
+void allocate_objects( ObjectPool* pool, int capacity );
+void free_objects( ObjectPool* pool );
+void move_object( ObjectPool* pool, int from, int to );
+int handle_is_live( ObjectPool* pool, ObjectHandle handle );
+void stale_handle( ObjectPool* pool, ObjectHandle handle, const char* use );
+
+
+/*******************************************************************************
+ * CONSTRUCTORS/DESTRUCTORS
+ ******************************************************************************/
+ObjectPool* ObjectPool_new( int capacity )
+{
+    ObjectPool* pool = (ObjectPool*)calloc( 1, sizeof(ObjectPool) );
+    int i;
+
+    allocate_objects( pool, capacity );
+    pool->live = 0;
+    pool->count = 0;
+    pool->refused = 0;
+    pool->staleHandles = 0;
+
+    for( i = 0; i < capacity; i++ )
+    {
+        pool->places[i] = -1;
+        pool->generations[i] = 1;
+        pool->nextFree[i] = i + 1 < capacity ? i + 1 : -1;
+    }
+    pool->firstFree = capacity > 0 ? 0 : -1;
+
+    return pool;
+}
+
+void ObjectPool_delete( ObjectPool* pool )
+{
+    if( pool == NULL )
+        return;
+
+    free_objects(pool);
+    free(pool);
+}
+
+
+void ObjectPool_assign( ObjectPool* pool, ObjectPool* source )
+{
+    int axis, count = source->count, capacity = source->capacity;
+
+    if( pool->capacity != capacity )
+        allocate_objects( pool, capacity );
+
+    pool->live = source->live;
+    pool->count = count;
+    pool->firstFree = source->firstFree;
+    pool->refused = source->refused;
+    pool->staleHandles = source->staleHandles;
+    // Only the places in use need copying
+    for( axis = 0; axis < 3; axis++ )
+    {
+        memcpy( pool->position[axis], source->position[axis],
+                sizeof(float) * count );
+        memcpy( pool->velocity[axis], source->velocity[axis],
+                sizeof(float) * count );
+        memcpy( pool->origin[axis], source->origin[axis],
+                sizeof(float) * count );
+        memcpy( pool->launch[axis], source->launch[axis],
+                sizeof(float) * count );
+    }
+    memcpy( pool->flight, source->flight, sizeof(float) * count );
+    memcpy( pool->radius, source->radius, sizeof(float) * count );
+    memcpy( pool->type, source->type, sizeof(ObjectType) * count );
+    memcpy( pool->owner, source->owner, sizeof(int) * count );
+    memcpy( pool->ground, source->ground, sizeof(float) * count );
+    memcpy( pool->slots, source->slots, sizeof(int) * count );
+    memcpy( pool->places, source->places, sizeof(int) * capacity );
+    memcpy( pool->generations, source->generations,
+            sizeof(unsigned int) * capacity );
+    memcpy( pool->nextFree, source->nextFree, sizeof(int) * capacity );
+}
+
+
+/*******************************************************************************
+ * POOL FUNCTIONS
+ ******************************************************************************/
+ObjectHandle ObjectPool_spawn( ObjectPool* pool, ObjectType type, int owner )
+{
+    ObjectHandle handle;
+    int place, axis;
+
+    // Spawning happens mid-tick, so rather than say so, count it
+    if( pool->firstFree < 0 )
+    {
+        pool->refused++;
+        return OBJECT_NONE;
+    }
+    // There's a free slot, so there's room at the end once the holes are
+    // closed up
+    if( pool->count == pool->capacity )
+        ObjectPool_compact(pool);
+
+    handle.index = pool->firstFree;
+    handle.generation = pool->generations[handle.index];
+    pool->firstFree = pool->nextFree[handle.index];
+    pool->live++;
+
+    place = pool->count++;
+    pool->places[handle.index] = place;
+    pool->slots[place] = handle.index;
+    for( axis = 0; axis < 3; axis++ )
+    {
+        pool->position[axis][place] = 0.0f;
+        pool->velocity[axis][place] = 0.0f;
+        pool->origin[axis][place] = 0.0f;
+        pool->launch[axis][place] = 0.0f;
+    }
+    pool->flight[place] = 0.0f;
+    pool->radius[place] = 0.0f;
+    pool->type[place] = type;
+    pool->owner[place] = owner;
+    pool->ground[place] = 0.0f;
+
+    return handle;
+}
+
+void ObjectPool_despawn( ObjectPool* pool, ObjectHandle handle )
+{
+    if( ObjectHandle_isNone(handle) )
+        return;
+    if( !handle_is_live( pool, handle ) )
+    {
+        stale_handle( pool, handle, "despawned" );
+        return;
+    }
+
+    ObjectPool_despawnAt( pool, pool->places[handle.index] );
+}
+
+void ObjectPool_despawnAt( ObjectPool* pool, int place )
+{
+    int slot = pool->slots[place];
+
+    if( slot < 0 )
+        return;
+
+    // Move the slot on to its next object, so the handle goes stale
+    if( ++pool->generations[slot] == 0 )
+        pool->generations[slot] = 1;
+    pool->nextFree[slot] = pool->firstFree;
+    pool->firstFree = slot;
+    pool->places[slot] = -1;
+    pool->slots[place] = -1;
+    pool->live--;
+}
+
+int ObjectPool_find( ObjectPool* pool, ObjectHandle handle )
+{
+    if( ObjectHandle_isNone(handle) )
+        return -1;
+    if( !handle_is_live( pool, handle ) )
+    {
+        stale_handle( pool, handle, "used" );
+        return -1;
+    }
+
+    return pool->places[handle.index];
+}
+
+int ObjectPool_isLive( ObjectPool* pool, int place )
+{
+    return pool->slots[place] >= 0;
+}
+
+void ObjectPool_integrate( ObjectPool* pool, double gravity, float delta )
+{
+    float* restrict position;
+    float* restrict velocity;
+    // Gravity's worked out in double precision, as it always has been, so
+    // that objects fall exactly as they did
+    double fall = gravity * (delta / 1000.0f);
+    int count = pool->count, axis, i;
+
+    // No branches, and no object depends on another, so each of these loops
+    // vectorises
+    velocity = pool->velocity[1];
+    for( i = 0; i < count; i++ )
+        velocity[i] += fall;
+
+    for( axis = 0; axis < 3; axis++ )
+    {
+        position = pool->position[axis];
+        velocity = pool->velocity[axis];
+        for( i = 0; i < count; i++ )
+            position[i] += velocity[i] * delta / 1000.0f;
+    }
+}
+
+void ObjectPool_launch( ObjectPool* pool, int place )
+{
+    int axis;
+
+    for( axis = 0; axis < 3; axis++ )
+    {
+        pool->origin[axis][place] = pool->position[axis][place];
+        pool->launch[axis][place] = pool->velocity[axis][place];
+    }
+    pool->flight[place] = 0.0f;
+}
+
+void ObjectPool_fly( ObjectPool* pool, double gravity, float delta )
+{
+    float* restrict position;
+    float* restrict velocity = pool->velocity[1];
+    const float* restrict origin;
+    const float* restrict launch;
+    float* restrict flight = pool->flight;
+    float seconds = delta / 1000.0f, fall = gravity,
+          half_gravity = 0.5 * gravity;
+    int count = pool->count, axis, i;
+
+    // The same sums as ObjectPool_arcAt, a loop at a time, so that they
+    // vectorise
+    for( i = 0; i < count; i++ )
+        flight[i] += seconds;
+
+    for( axis = 0; axis < 3; axis++ )
+    {
+        position = pool->position[axis];
+        origin = pool->origin[axis];
+        launch = pool->launch[axis];
+        for( i = 0; i < count; i++ )
+            position[i] = origin[i] + launch[i] * flight[i];
+    }
+
+    position = pool->position[1];
+    launch = pool->launch[1];
+    for( i = 0; i < count; i++ )
+    {
+        position[i] += half_gravity * flight[i] * flight[i];
+        velocity[i] = launch[i] + fall * flight[i];
+    }
+}
+
+void ObjectPool_arcAt( ObjectPool* pool, int place, double gravity,
+                       float time, float position[3] )
+{
+    float half_gravity = 0.5 * gravity;
+    int axis;
+
+    for( axis = 0; axis < 3; axis++ )
+    {
+        position[axis] = pool->origin[axis][place] +
+                         pool->launch[axis][place] * time;
+    }
+    position[1] += half_gravity * time * time;
+}
+
+void ObjectPool_compact( ObjectPool* pool )
+{
+    int from, to = 0;
+
+    if( pool->live == pool->count )
+        return;
+
+    for( from = 0; from < pool->count; from++ )
+    {
+        if( pool->slots[from] < 0 )
+            continue;
+        if( from != to )
+            move_object( pool, from, to );
+        to++;
+    }
+    pool->count = to;
+}
+
+int ObjectHandle_isNone( ObjectHandle handle )
+{
+    return handle.generation == 0;
+}
+
+
+/*******************************************************************************
+ * INTERNAL FUNCTIONS
+ ******************************************************************************/
+/**
+ * Gives the pool arrays for `capacity` objects and slots, freeing the ones it
+ * had. The arrays' contents are left undefined.
+ */
+void allocate_objects( ObjectPool* pool, int capacity )
+{
+    int axis;
+
+    free_objects(pool);
+    for( axis = 0; axis < 3; axis++ )
+    {
+        pool->position[axis] = (float*)malloc( sizeof(float) * capacity );
+        pool->velocity[axis] = (float*)malloc( sizeof(float) * capacity );
+        pool->origin[axis] = (float*)malloc( sizeof(float) * capacity );
+        pool->launch[axis] = (float*)malloc( sizeof(float) * capacity );
+    }
+    pool->flight = (float*)malloc( sizeof(float) * capacity );
+    pool->radius = (float*)malloc( sizeof(float) * capacity );
+    pool->type = (ObjectType*)malloc( sizeof(ObjectType) * capacity );
+    pool->owner = (int*)malloc( sizeof(int) * capacity );
+    pool->ground = (float*)malloc( sizeof(float) * capacity );
+    pool->slots = (int*)malloc( sizeof(int) * capacity );
+    pool->places = (int*)malloc( sizeof(int) * capacity );
+    pool->generations = (unsigned int*)malloc( sizeof(unsigned int) *
+                                               capacity );
+    pool->nextFree = (int*)malloc( sizeof(int) * capacity );
+
+    pool->capacity = capacity;
+}
+
+/**
+ * Frees the pool's arrays.
+ */
+void free_objects( ObjectPool* pool )
+{
+    int axis;
+
+    for( axis = 0; axis < 3; axis++ )
+    {
+        free(pool->position[axis]);
+        free(pool->velocity[axis]);
+        free(pool->origin[axis]);
+        free(pool->launch[axis]);
+    }
+    free(pool->flight);
+    free(pool->radius);
+    free(pool->type);
+    free(pool->owner);
+    free(pool->ground);
+    free(pool->slots);
+    free(pool->places);
+    free(pool->generations);
+    free(pool->nextFree);
+}
+
+/**
+ * Moves the object at place `from` to place `to`, over whatever's there.
+ */
+void move_object( ObjectPool* pool, int from, int to )
+{
+    int axis;
+
+    for( axis = 0; axis < 3; axis++ )
+    {
+        pool->position[axis][to] = pool->position[axis][from];
+        pool->velocity[axis][to] = pool->velocity[axis][from];
+        pool->origin[axis][to] = pool->origin[axis][from];
+        pool->launch[axis][to] = pool->launch[axis][from];
+    }
+    pool->flight[to] = pool->flight[from];
+    pool->radius[to] = pool->radius[from];
+    pool->type[to] = pool->type[from];
+    pool->owner[to] = pool->owner[from];
+    pool->ground[to] = pool->ground[from];
+    pool->slots[to] = pool->slots[from];
+    pool->places[pool->slots[to]] = to;
+    pool->slots[from] = -1;
+}
+
+/**
+ * Returns true if the handle refers to an object in the pool that hasn't
+ * been despawned.
+ */
+int handle_is_live( ObjectPool* pool, ObjectHandle handle )
+{
+    // A slot's generation only matches a handle's while the object it was
+    // handed out for is still there; despawning moves the generation on
+    return handle.index >= 0 && handle.index < pool->capacity &&
+           pool->generations[handle.index] == handle.generation;
+}
+
+/**
+ * Counts the use of a stale handle. Debug builds report it and stop.
+ */
+void stale_handle( ObjectPool* pool, ObjectHandle handle, const char* use )
+{
+    pool->staleHandles++;
+#ifndef NDEBUG
+    fprintf( stderr, "Stale object handle (slot %d, generation %u) %s\n",
+             handle.index, handle.generation, use );
+    abort();
+#endif
+}
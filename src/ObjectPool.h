@@ -0,0 +1,162 @@
+#ifndef OBJECTPOOL_H_
+#define OBJECTPOOL_H_
+/**
+ * ObjectPool.h
+ * A fixed number of objects, handed out and taken back without allocating.
+ *
+ * A pool allocates all of its objects when it's created. Spawning an object
+ * takes one off a free list, and despawning puts it back, so neither touches
+ * the heap during play.
+ *
+ * Objects are referred to by handles rather than pointers. Each slot in the
+ * pool counts the objects it's held, and a handle carries the count of the
+ * object it was given for, so a handle to an object that's been despawned is
+ * recognisably stale, even once its slot holds another object. Debug builds
+ * (without NDEBUG) stop on the spot when given a stale handle; others treat it
+ * as no object at all, and count it. Pools are used mid-tick, so otherwise
+ * they never print: a spawn from a full pool is counted too, and gets no
+ * object.
+ *
+ * The objects themselves are kept a field to an array, packed at the front of
+ * the arrays in the order they were spawned, so that a pass over them all
+ * (see ObjectPool_integrate) is a loop straight down a few arrays, which the
+ * compiler can vectorise, however many objects there are. A slot says where
+ * its object is in the arrays. Despawning an object leaves a hole, which is
+ * kept until the pool's compacted, so that passes can despawn objects as they
+ * go without the others moving under them.
+ */
+
+#include "Object.h"
+
+/*******************************************************************************
+ * TYPE DEFINITIONS
+ ******************************************************************************/
+/**
+ * Refers to an object in a pool. A handle of all zeroes (OBJECT_NONE) refers
+ * to no object.
+ */
+typedef struct {
+    int index; // The object's slot
+    unsigned int generation; // The slot's count when the object was spawned
+} ObjectHandle;
+
+extern const ObjectHandle OBJECT_NONE;
+
+typedef struct {
+    int capacity;
+    int live; // The number of objects spawned and not yet despawned
+    // The number of places used at the front of the object arrays, by live
+    // objects and by the holes despawned ones have left
+    int count;
+    // The spawns refused for the pool being full, and the stale handles it's
+    // been given
+    unsigned int refused;
+    unsigned int staleHandles;
+
+    /* The objects, place by place. Each array is `capacity` long. */
+    // Position and velocity (in distance units per second): an array for X,
+    // one for Y and one for Z
+    float* position[3];
+    float* velocity[3];
+    float* radius;
+    ObjectType* type;
+    // The player the object belongs to (counting from 0), or -1
+    int* owner;
+    // The height of the landscape under the object, when it was last found
+    // (see Landscape_getHeights)
+    float* ground;
+    // Where the object was launched from, and how fast, and the seconds
+    // since, for objects flying a ballistic arc (see ObjectPool_launch)
+    float* origin[3];
+    float* launch[3];
+    float* flight;
+    // The slot of the object in each place, or -1 for a hole
+    int* slots;
+
+    /* The slots, slot by slot */
+    // The place of each slot's object, or -1 if it's free
+    int* places;
+    // The number of objects each slot has held (never 0)
+    unsigned int* generations;
+    // The free slots, as a list threaded through `nextFree`, ending with -1
+    int* nextFree;
+    int firstFree;
+} ObjectPool;
+
+/*******************************************************************************
+ * CONSTRUCTORS/DESTRUCTORS
+ ******************************************************************************/
+/**
+ * Creates a pool of `capacity` objects, all free.
+ */
+ObjectPool* ObjectPool_new( int capacity );
+void ObjectPool_delete( ObjectPool* pool );
+/**
+ * Makes `pool` a copy of `source`, so that the same handles refer to the same
+ * objects in each.
+ */
+void ObjectPool_assign( ObjectPool* pool, ObjectPool* source );
+
+/*******************************************************************************
+ * POOL FUNCTIONS
+ ******************************************************************************/
+/**
+ * Takes a zeroed object of the given type and owner from the pool, and
+ * returns its handle, or OBJECT_NONE (counted in `refused`) if the pool's
+ * empty. The object goes
+ * after all of the others, so is at place count - 1.
+ */
+ObjectHandle ObjectPool_spawn( ObjectPool* pool, ObjectType type, int owner );
+/**
+ * Returns the object with the given handle to the pool. Despawning no object
+ * does nothing.
+ */
+void ObjectPool_despawn( ObjectPool* pool, ObjectHandle handle );
+/**
+ * Returns the object at the given place to the pool.
+ */
+void ObjectPool_despawnAt( ObjectPool* pool, int place );
+/**
+ * Returns the place of the object with the given handle, or -1 for no object.
+ * Places change when the pool's compacted; handles don't.
+ */
+int ObjectPool_find( ObjectPool* pool, ObjectHandle handle );
+/**
+ * Returns true if there's a live object at the given place, rather than a
+ * hole.
+ */
+int ObjectPool_isLive( ObjectPool* pool, int place );
+/**
+ * Moves every object on by `delta` milliseconds: accelerates them downwards
+ * by `gravity` (in distance units per second per second), then moves them by
+ * their velocity. Holes are moved too, which costs less than skipping them.
+ */
+void ObjectPool_integrate( ObjectPool* pool, double gravity, float delta );
+/**
+ * Launches the object at the given place on an arc from where it is, at the
+ * velocity it has, for ObjectPool_fly to follow.
+ */
+void ObjectPool_launch( ObjectPool* pool, int place );
+/**
+ * Moves every object on by `delta` milliseconds along the arcs they were
+ * launched on, falling at `gravity`. Unlike ObjectPool_integrate, each
+ * position is worked out afresh from the launch, so is the same at the same
+ * time into the flight however the flight's divided into steps.
+ */
+void ObjectPool_fly( ObjectPool* pool, double gravity, float delta );
+/**
+ * Finds where the object at the given place is on its arc, `time` seconds
+ * into its flight, exactly as ObjectPool_fly would put it.
+ */
+void ObjectPool_arcAt( ObjectPool* pool, int place, double gravity,
+                       float time, float position[3] );
+/**
+ * Closes up the holes left by despawned objects, keeping the rest in order.
+ */
+void ObjectPool_compact( ObjectPool* pool );
+/**
+ * Returns true if `handle` refers to no object.
+ */
+int ObjectHandle_isNone( ObjectHandle handle );
+
+#endif /*OBJECTPOOL_H_*/
@@ -0,0 +1,153 @@
+#include "OccupancyGrid.h"
+#include <stdlib.h>
+
+/*******************************************************************************
+ * INTERNAL FUNCTION PROTOTYPES
+ ******************************************************************************/
+int take_occupant( OccupancyGrid* grid );
+
+
+/*******************************************************************************
+ * CONSTRUCTORS/DESTRUCTORS
+ ******************************************************************************/
+OccupancyGrid* OccupancyGrid_new( int grid_width )
+{
+    OccupancyGrid* grid = (OccupancyGrid*)malloc( sizeof(OccupancyGrid) );
+    int i;
+
+    grid->gridWidth = grid_width;
+    grid->points = (int*)malloc( sizeof(int) * grid_width * grid_width );
+    for( i = 0; i < grid_width * grid_width; i++ )
+        grid->points[i] = -1;
+
+    // The pool grows as it's needed
+    grid->occupants = NULL;
+    grid->capacity = 0;
+    grid->firstFree = -1;
+
+    return grid;
+}
+
+void OccupancyGrid_delete( OccupancyGrid* grid )
+{
+    if( grid == NULL )
+        return;
+
+    free(grid->points);
+    free(grid->occupants);
+    free(grid);
+}
+
+
+/*******************************************************************************
+ * GRID FUNCTIONS
+ ******************************************************************************/
+void OccupancyGrid_enter( OccupancyGrid* grid, int row, int column,
+                          int player, unsigned int joint )
+{
+    Occupant* occupant = OccupancyGrid_at( grid, row, column, player );
+    int* point, index;
+
+    if( occupant == NULL )
+    {
+        // New occupants go at the end, so that a point's occupants are in
+        // the order they arrived
+        index = take_occupant(grid);
+        occupant = &grid->occupants[index];
+        occupant->player = player;
+        occupant->count = 0;
+        occupant->next = -1;
+
+        point = &grid->points[row * grid->gridWidth + column];
+        while( *point >= 0 )
+            point = &grid->occupants[*point].next;
+        *point = index;
+    }
+
+    occupant->joint = joint;
+    occupant->count++;
+}
+
+void OccupancyGrid_leave( OccupancyGrid* grid, int row, int column,
+                          int player )
+{
+    int* point = &grid->points[row * grid->gridWidth + column];
+    Occupant* occupant;
+    int index;
+
+    for( ; *point >= 0; point = &occupant->next )
+    {
+        occupant = &grid->occupants[*point];
+        if( occupant->player != player )
+            continue;
+
+        // Return the occupant to the pool once their last joint's gone
+        if( --occupant->count == 0 )
+        {
+            index = *point;
+            *point = occupant->next;
+            occupant->next = grid->firstFree;
+            grid->firstFree = index;
+        }
+        return;
+    }
+}
+
+Occupant* OccupancyGrid_at( OccupancyGrid* grid, int row, int column,
+                            int player )
+{
+    Occupant* occupant;
+
+    for( occupant = OccupancyGrid_first( grid, row, column );
+         occupant != NULL; occupant = OccupancyGrid_next( grid, occupant ) )
+    {
+        if( occupant->player == player )
+            return occupant;
+    }
+
+    return NULL;
+}
+
+Occupant* OccupancyGrid_first( OccupancyGrid* grid, int row, int column )
+{
+    int index = grid->points[row * grid->gridWidth + column];
+
+    return index >= 0 ? &grid->occupants[index] : NULL;
+}
+
+Occupant* OccupancyGrid_next( OccupancyGrid* grid, Occupant* occupant )
+{
+    return occupant->next >= 0 ? &grid->occupants[occupant->next] : NULL;
+}
+
+
+/*******************************************************************************
+ * INTERNAL FUNCTIONS
+ ******************************************************************************/
+/**
+ * Takes an occupant from the pool, doubling the pool if it's empty, and
+ * returns its index.
+ */
+int take_occupant( OccupancyGrid* grid )
+{
+    int capacity, index;
+
+    if( grid->firstFree < 0 )
+    {
+        capacity = grid->capacity > 0 ? grid->capacity * 2 : grid->gridWidth;
+        grid->occupants = (Occupant*)realloc( grid->occupants,
+                                              sizeof(Occupant) * capacity );
+        for( index = grid->capacity; index < capacity; index++ )
+        {
+            grid->occupants[index].next = index + 1 < capacity ? index + 1 :
+                                                                 -1;
+        }
+        grid->firstFree = grid->capacity;
+        grid->capacity = capacity;
+    }
+
+    index = grid->firstFree;
+    grid->firstFree = grid->occupants[index].next;
+
+    return index;
+}
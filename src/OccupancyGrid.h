@@ -0,0 +1,90 @@
+#ifndef OCCUPANCYGRID_H_
+#define OCCUPANCYGRID_H_
+/**
+ * OccupancyGrid.h
+ * Which players' bodies lie on each point of the landscape grid.
+ *
+ * Players' joints are always on grid points, so the grid can say, for each
+ * point, whose joints are there, how many of each player's, and which was laid
+ * most recently. Joints enter the grid as they're laid at the head and leave
+ * it as they're dropped from the tail, so finding whether anyone is in the way
+ * of something is a single lookup, however long and however many the players
+ * are.
+ *
+ * A point usually holds one player's joint at most, but may briefly hold more:
+ * a head may arrive at a point before a tail leaves it. So each point keeps a
+ * list of its occupants, one for each player with joints there, drawn from a
+ * pool shared by the whole grid, and the grid takes the same memory whatever
+ * the number of players.
+ */
+
+/*******************************************************************************
+ * TYPE DEFINITIONS
+ ******************************************************************************/
+/**
+ * A player's joints at a grid point.
+ */
+typedef struct {
+    int player; // The player's number (counting from 0)
+    // The number of the newest of them, counting joints in the order they
+    // were laid (see Player's `jointsLaid`)
+    unsigned int joint;
+    // How many of them there are
+    int count;
+    // The next occupant of the same point, or -1 (or the next free occupant,
+    // for occupants in the pool)
+    int next;
+} Occupant;
+
+typedef struct {
+    int gridWidth; // The number of points along each side of the grid
+    // The first occupant of each point, or -1, point by point, row by row
+    int* points;
+    // The pool of occupants, with a list of the free ones, ending with -1
+    Occupant* occupants;
+    int capacity;
+    int firstFree;
+} OccupancyGrid;
+
+/*******************************************************************************
+ * CONSTRUCTORS/DESTRUCTORS
+ ******************************************************************************/
+/**
+ * Creates an empty grid of `grid_width` by `grid_width` points.
+ */
+OccupancyGrid* OccupancyGrid_new( int grid_width );
+void OccupancyGrid_delete( OccupancyGrid* grid );
+
+/*******************************************************************************
+ * GRID FUNCTIONS
+ ******************************************************************************/
+/**
+ * Records that `player` has laid their joint number `joint` at the given
+ * point.
+ */
+void OccupancyGrid_enter( OccupancyGrid* grid, int row, int column,
+                          int player, unsigned int joint );
+/**
+ * Records that one of `player`'s joints has left the given point.
+ */
+void OccupancyGrid_leave( OccupancyGrid* grid, int row, int column,
+                          int player );
+/**
+ * Returns `player`'s joints at the given point, or NULL if there are none.
+ *
+ * Occupants may move when joints enter the grid, so aren't to be kept.
+ */
+Occupant* OccupancyGrid_at( OccupancyGrid* grid, int row, int column,
+                            int player );
+/**
+ * Returns the first of the players with joints at the given point, or NULL if
+ * there are none.
+ */
+Occupant* OccupancyGrid_first( OccupancyGrid* grid, int row, int column );
+/**
+ * Returns the player after `occupant` with joints at the same point, or NULL
+ * if there are no more.
+ */
+Occupant* OccupancyGrid_next( OccupancyGrid* grid, Occupant* occupant );
+
+#endif /*OCCUPANCYGRID_H_*/
@@ -1,98 +1,306 @@
 #include "Player.h"
 #include <stdlib.h>
 #include "maths.h"
+#include "profile.h"
 
-// Default player colours
-#define PLAYER1_R 1.0f
-#define PLAYER1_G 1.0f
-#define PLAYER1_B 0.0f
+/*******************************************************************************
+ * GLOBALS AND CONSTANTS
+ ******************************************************************************/
+// Player colours (R, G, B): player 1 is yellow and player 2 blue, as they
+// always were
+static const float player_colors[PLAYER_COLORS][3] = {
+    { 1.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 1.0f, 0.0f, 0.0f },
+    { 0.0f, 1.0f, 0.0f }, { 1.0f, 0.0f, 1.0f }, { 0.0f, 1.0f, 1.0f },
+    { 1.0f, 0.5f, 0.0f }, { 0.5f, 0.0f, 1.0f }, { 1.0f, 1.0f, 1.0f },
+    { 0.5f, 1.0f, 0.0f }, { 1.0f, 0.0f, 0.5f }, { 0.0f, 0.5f, 1.0f },
+    { 0.5f, 0.25f, 0.0f }, { 0.0f, 0.5f, 0.5f }, { 1.0f, 0.75f, 0.75f },
+    { 0.5f, 0.5f, 0.5f }
+};
 
-#define PLAYER2_R 0.0f
-#define PLAYER2_G 0.0f
-#define PLAYER2_B 1.0f
+// The fewest joints and runs a player's ring buffers hold
+#define MIN_JOINTS 256
+#define MIN_RUNS 16
 
-Player* Player_new( /* params */ )
+
+/*******************************************************************************
+ * INTERNAL FUNCTION PROTOTYPES
+ ******************************************************************************/
+int run_step( int value );
+int run_length( BodyRun* run );
+void grow_runs( Player* player );
+void grow_joints( Player* player );
+void add_to_runs( Player* player, int row, int column, float position[3] );
+
+
+/*******************************************************************************
+ * CONSTRUCTORS/DESTRUCTORS
+ ******************************************************************************/
+Player* Player_new( int number )
 {
-    static int count = 0;
-    
     Player *player = (Player*)calloc( sizeof(Player), 1 );
+    PROFILE_ALLOCATION();
     
-    switch( count )
-    {
-    case 0:
-        player->color[0] = PLAYER1_R;
-        player->color[1] = PLAYER1_G;
-        player->color[2] = PLAYER1_B;
-        break;
-    case 1:
-        player->color[0] = PLAYER2_R;
-        player->color[1] = PLAYER2_G;
-        player->color[2] = PLAYER2_B;
-        count = -1;
-        break;
-    }
-    
-    count++;
+    player->number = number;
+    player->color[0] = player_colors[number % PLAYER_COLORS][0];
+    player->color[1] = player_colors[number % PLAYER_COLORS][1];
+    player->color[2] = player_colors[number % PLAYER_COLORS][2];
     
     return player;
 }
 
 void Player_delete( Player* player )
 {
-    // Free the player's body
-    while( player->head != NULL )
+    free(player->joints);
+    free(player->runs);
+    free(player);
+}
+
+void Player_assign( Player* player, Player* source )
+{
+    Joint* joints = player->joints;
+    BodyRun* runs = player->runs;
+    int joint_capacity = player->jointCapacity,
+        run_capacity = player->runCapacity, i;
+    int* joint;
+    
+    if( joint_capacity < source->jointCount )
     {
-        free(player->head);
-        player->head = player->head->next;
+        joint_capacity = source->jointCapacity;
+        free(joints);
+        joints = (Joint*)malloc( sizeof(Joint) * joint_capacity );
+    }
+    if( run_capacity < source->runCount )
+    {
+        run_capacity = source->runCapacity;
+        free(runs);
+        runs = (BodyRun*)malloc( sizeof(BodyRun) * run_capacity );
     }
     
-    free(player);
+    // Copy the joints and runs to the front of our buffers, tail first
+    for( i = 0; i < source->jointCount; i++ )
+    {
+        joint = Player_joint( source, source->jointCount - 1 - i );
+        joints[i][0] = joint[0];
+        joints[i][1] = joint[1];
+    }
+    for( i = 0; i < source->runCount; i++ )
+        runs[i] = *Player_run( source, i );
+    
+    *player = *source;
+    player->joints = joints;
+    player->jointCapacity = joint_capacity;
+    player->tailJoint = 0;
+    player->runs = runs;
+    player->runCapacity = run_capacity;
+    player->firstRun = 0;
 }
 
-Body* Body_new( int row, int column, float x, float y, float z )
+
+/*******************************************************************************
+ * PLAYER FUNCTIONS
+ ******************************************************************************/
+void Player_pushJoint( Player* player, int row, int column,
+                       Landscape* landscape )
 {
-    Body* body = (Body*)calloc( sizeof(Body), 1 );
+    int* joint;
     
-    body->position = (float*)malloc( sizeof(float) * 3 );
-    body->position[0] = x;
-    body->position[1] = y;
-    body->position[2] = z;
+    if( player->jointCount == player->jointCapacity )
+        grow_joints(player);
     
-    body->gridPosition[0] = row;
-    body->gridPosition[1] = column;
+    player->jointCount++;
+    joint = Player_joint( player, 0 );
+    joint[0] = row;
+    joint[1] = column;
+    player->jointsLaid++;
     
-    return body;
+    add_to_runs( player, row, column, landscape->pointMap[row][column] );
 }
 
-void Body_delete( Body* body )
+void Player_popJoint( Player* player )
 {
-    if( body->next != NULL )
+    BodyRun* run;
+    
+    if( player->jointCount == 0 )
+        return;
+    
+    player->tailJoint = (player->tailJoint + 1) & (player->jointCapacity - 1);
+    player->jointCount--;
+    
+    // Move the oldest run's start along, dropping the run when it's empty.
+    // Its bounds only ever shrink, so are left as they are.
+    run = Player_run( player, 0 );
+    if( run_length(run) == 1 )
+    {
+        player->firstRun = (player->firstRun + 1) & (player->runCapacity - 1);
+        player->runCount--;
+    }
+    else
     {
-        Body_delete(body->next);
+        run->start[0] += run_step(run->end[0] - run->start[0]);
+        run->start[1] += run_step(run->end[1] - run->start[1]);
     }
-    if( body->previous != NULL )
+}
+
+void Player_clearJoints( Player* player )
+{
+    player->tailJoint = player->jointCount = 0;
+    player->firstRun = player->runCount = 0;
+}
+
+int* Player_joint( Player* player, int i )
+{
+    return player->joints[(player->tailJoint + player->jointCount - 1 - i) &
+                          (player->jointCapacity - 1)];
+}
+
+float* Player_jointPosition( Player* player, int i, Landscape* landscape )
+{
+    int* joint = Player_joint( player, i );
+    
+    return landscape->pointMap[joint[0]][joint[1]];
+}
+
+void Player_refitRuns( Player* player, Landscape* landscape )
+{
+    BodyRun* run;
+    float* position;
+    int r, row, column, i;
+    
+    for( r = 0; r < player->runCount; r++ )
     {
-        body->previous->next = NULL;
+        run = Player_run( player, r );
+        row = run->start[0];
+        column = run->start[1];
+        for( i = 0; i < 3; i++ )
+            run->min[i] = run->max[i] = landscape->pointMap[row][column][i];
+        
+        while( row != run->end[0] || column != run->end[1] )
+        {
+            row += run_step(run->end[0] - run->start[0]);
+            column += run_step(run->end[1] - run->start[1]);
+            position = landscape->pointMap[row][column];
+            for( i = 0; i < 3; i++ )
+            {
+                if( position[i] < run->min[i] )
+                    run->min[i] = position[i];
+                if( position[i] > run->max[i] )
+                    run->max[i] = position[i];
+            }
+        }
     }
+}
+
+BodyRun* Player_run( Player* player, int i )
+{
+    return &player->runs[(player->firstRun + i) & (player->runCapacity - 1)];
+}
+
+
+/*******************************************************************************
+ * INTERNAL FUNCTIONS
+ ******************************************************************************/
+/**
+ * Returns -1, 0 or 1, as `value` is negative, zero or positive: the step
+ * along a run whose end is `value` from its start.
+ */
+int run_step( int value )
+{
+    return (value > 0) - (value < 0);
+}
+
+/**
+ * Returns the number of joints in a run.
+ */
+int run_length( BodyRun* run )
+{
+    return abs(run->end[0] - run->start[0]) +
+           abs(run->end[1] - run->start[1]) + 1;
+}
+
+/**
+ * Doubles the size of the player's ring buffer of runs, moving the oldest run
+ * to the front.
+ */
+void grow_runs( Player* player )
+{
+    int capacity = player->runCapacity == 0 ?
+                   MIN_RUNS : player->runCapacity * 2, i;
+    BodyRun* runs = (BodyRun*)malloc( sizeof(BodyRun) * capacity );
     
-    free(body->position);
+    for( i = 0; i < player->runCount; i++ )
+        runs[i] = *Player_run( player, i );
     
-    free(body);
+    free(player->runs);
+    player->runs = runs;
+    player->runCapacity = capacity;
+    player->firstRun = 0;
 }
 
-void Body_push( Body* new_segment, Body** body )
+/**
+ * Doubles the size of the player's ring buffer of joints, moving the tail to
+ * the front.
+ */
+void grow_joints( Player* player )
 {
-    new_segment->next = *body;
-    (*body)->previous = new_segment;
-    *body = new_segment;
+    int capacity = player->jointCapacity == 0 ?
+                   MIN_JOINTS : player->jointCapacity * 2, i;
+    Joint* joints = (Joint*)malloc( sizeof(Joint) * capacity );
+    int* joint;
+    
+    for( i = 0; i < player->jointCount; i++ )
+    {
+        joint = Player_joint( player, player->jointCount - 1 - i );
+        joints[i][0] = joint[0];
+        joints[i][1] = joint[1];
+    }
+    
+    free(player->joints);
+    player->joints = joints;
+    player->jointCapacity = capacity;
+    player->tailJoint = 0;
 }
 
-void Body_setPosition( Body* body, int row, int column,
-                       float x, float y, float z )
+/**
+ * Adds a joint laid at the head of the player to their runs, extending the
+ * newest run if it carries straight on.
+ */
+void add_to_runs( Player* player, int row, int column, float position[3] )
 {
-    body->gridPosition[0] = row;
-    body->gridPosition[1] = column;
-    body->position[0] = x;
-    body->position[1] = y;
-    body->position[2] = z;
+    BodyRun* run = NULL;
+    int i;
+    
+    // Carry on the newest run if the joint is the next point along it. A run
+    // of one joint may go either way.
+    if( player->runCount > 0 )
+    {
+        run = Player_run( player, player->runCount - 1 );
+        if( abs(row - run->end[0]) + abs(column - run->end[1]) != 1 ||
+            (run_length(run) > 1 &&
+             (row - run->end[0] != run_step(run->end[0] - run->start[0]) ||
+              column - run->end[1] != run_step(run->end[1] - run->start[1]))) )
+        {
+            run = NULL;
+        }
+    }
+    
+    if( run == NULL )
+    {
+        if( player->runCount == player->runCapacity )
+            grow_runs(player);
+        run = Player_run( player, player->runCount++ );
+        run->start[0] = row;
+        run->start[1] = column;
+        for( i = 0; i < 3; i++ )
+            run->min[i] = run->max[i] = position[i];
+    }
+    
+    run->end[0] = row;
+    run->end[1] = column;
+    for( i = 0; i < 3; i++ )
+    {
+        if( position[i] < run->min[i] )
+            run->min[i] = position[i];
+        if( position[i] > run->max[i] )
+            run->max[i] = position[i];
+    }
 }
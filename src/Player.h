@@ -4,6 +4,11 @@
  * This module defines the Player - a very simple object representing a player.
  */
 
+#include "Landscape.h"
+
+// The number of distinct player colours
+#define PLAYER_COLORS 16
+
 /**
  * This is the direction of travel of the player, relative to the landscape.
  */
@@ -12,21 +17,27 @@ typedef enum {
 } Direction;
 
 /**
- * This struct defines a segment of the body of a player.
+ * A joint in the body of a player: the grid point (row, column) it's at.
  * 
- * Actually, this struct defines a joint in the player's body. The body itself
- * is a doubly linked list of joints.
+ * Joints are only ever on grid points, so that's all there is to them; their
+ * positions are the landscape's at those points, so follow it as it changes.
+ */
+typedef int Joint[2];
+
+/**
+ * A straight run of joints in a player's body.
  * 
- * The head of the player is another body segment
+ * Players only turn at grid points, so a body is mostly a few long straight
+ * runs along grid lines, and can be described by the grid points at either
+ * end of each. `start` is the run's oldest joint, and `end` its newest; a run
+ * of one joint starts and ends at the same point. The joints' heights follow
+ * the landscape, but the run keeps the bounds of their positions, which have
+ * to be refitted when the landscape changes.
  */
-typedef struct _Body {
-    float* position; // Position vector
-    int gridPosition[2]; // The grid point this joint occupies
-    
-    // The length of the segment, i.e. the distance to the previous point
-    struct _Body* previous;
-    struct _Body* next;
-} Body;
+typedef struct {
+    int start[2], end[2];
+    float min[3], max[3];
+} BodyRun;
 
 /**
  * This structure describes a player.
@@ -44,9 +55,10 @@ typedef struct _Body {
  * reach the next grid point, if they want to go a different direction, we
  * change their direction.
  * 
- * To describe the body of the player we have a linked list of body segments.
- * Since players can only move on grid lines, body segments can be described in
- * grid coordinates, since each joint will be on a grid point.
+ * To describe the body of the player we have a list of joints. Since players
+ * can only move on grid lines, joints can be described in grid coordinates,
+ * since each joint will be on a grid point. Joints are added at the head and
+ * dropped from the tail, so the list is a ring buffer.
  * 
  * However, to describe the head and tail of a player - since they may be
  * between grid points - we need to store the distance they are from the next
@@ -58,10 +70,17 @@ typedef struct _Body {
  * a certain distance from the last element in the list (`tailOffset`).
  */
 typedef struct {
+    // The player's number, counting from 0 (so player 1 is number 0)
+    int number;
+    // Whether the player's been knocked out of the game
+    int out;
+    
     // The position of the player's head (in real coordinates)
     float headPosition[3];
-    // The player's body, a doubly linked list of body segments.
-    Body *head, *tail;
+    // The player's body, from the tail to the head: a ring buffer of
+    // `jointCapacity` (a power of two) joints, starting at `tailJoint`
+    Joint* joints;
+    int jointCapacity, tailJoint, jointCount;
     // The position of the player's tail (in real coordinates)
     float tailPosition[3];
     
@@ -96,17 +115,61 @@ typedef struct {
     float length;
     // The player's radius
     float radius;
+    
+    // The number of joints laid since the game began, which numbers them: the
+    // head joint is number jointsLaid - 1
+    unsigned int jointsLaid;
+    
+    // The player's body as straight runs, oldest first: a ring buffer of
+    // `runCapacity` (a power of two) runs, starting at `firstRun`
+    BodyRun* runs;
+    int runCapacity, firstRun, runCount;
 } Player;
 
 /**
- * Creates and initializes a new player, and returns a pointer to them.
+ * Creates and initializes a new player, and returns a pointer to them. The
+ * player's `number` (0 for player 1) picks their colour, from a set of
+ * PLAYER_COLORS which repeats for more players.
  */
-Player* Player_new( /* params */ );
+Player* Player_new( int number );
 void Player_delete( Player* );
-Body* Body_new( int row, int column, float x, float y, float z );
-void Body_push( Body* new_segment, Body** body );
-void Body_delete( Body* );
-void Body_setPosition( Body* body, int row, int column,
-                       float x, float y, float z );
+/**
+ * Makes `player` a copy of `source`, joints, runs and all, reusing their own
+ * ring buffers where they're big enough.
+ */
+void Player_assign( Player* player, Player* source );
+
+/**
+ * Lays a joint at the given grid point of the landscape, as the player's new
+ * head, and adds it to their runs.
+ */
+void Player_pushJoint( Player* player, int row, int column,
+                       Landscape* landscape );
+/**
+ * Drops the player's tail joint.
+ */
+void Player_popJoint( Player* player );
+/**
+ * Forgets all of the player's joints and runs.
+ */
+void Player_clearJoints( Player* player );
+/**
+ * Returns the player's `i`th joint, counting from the head (so the head is
+ * joint 0, and the tail joint jointCount - 1).
+ */
+int* Player_joint( Player* player, int i );
+/**
+ * Returns the position of the player's `i`th joint, counting from the head.
+ */
+float* Player_jointPosition( Player* player, int i, Landscape* landscape );
+/**
+ * Brings the bounds of the player's runs up to date with the landscape, once
+ * it's changed under them.
+ */
+void Player_refitRuns( Player* player, Landscape* landscape );
+/**
+ * Returns the player's `i`th run, counting from the oldest.
+ */
+BodyRun* Player_run( Player* player, int i );
 
 #endif /*PLAYER_H_*/
@@ -0,0 +1,295 @@
+#include "ScaledTarget.h"
+#include "glext.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <string.h>
+#include <time.h>
+
+/*******************************************************************************
+ * GLOBALS AND CONSTANTS
+ ******************************************************************************/
+// The smallest fraction of a viewport's width and height drawn
+#define MIN_SCALE 0.5f
+
+// How much of each new time goes into the smoothed time
+#define TIME_SMOOTHING 0.2f
+// How far towards the ideal scale to go, when over budget
+#define SCALE_DOWN_RATE 0.5f
+// How far the scale may creep up each frame, once there's time to spare
+#define SCALE_UP_STEP 0.02f
+// The proportion of the budget used before there's time to spare. The gap
+// stops the scale bouncing up and down around the budget.
+#define SCALE_UP_THRESHOLD 0.8f
+
+
+/*******************************************************************************
+ * INTERNAL FUNCTION PROTOTYPES
+ ******************************************************************************/
+int resize_framebuffer( ScaledTarget* target, int width, int height );
+void delete_framebuffer( ScaledTarget* target );
+void start_timing( ScaledTarget* target );
+void stop_timing( ScaledTarget* target );
+void record_time( ScaledTarget* target, float time );
+long long scaled_target_clock();
+int is_software_renderer();
+
+
+/*******************************************************************************
+ * PUBLIC FUNCTIONS
+ ******************************************************************************/
+ScaledTarget* ScaledTarget_new()
+{
+    ScaledTarget* target;
+
+    if( !glext_has_blit() )
+        return NULL;
+
+    target = (ScaledTarget*)calloc( 1, sizeof(ScaledTarget) );
+    target->scale = 1.0f;
+
+    target->synchronous = !glext_has_timer_queries() || is_software_renderer();
+    if( !target->synchronous )
+        ext_glGenQueries( SCALED_TARGET_QUERIES, target->queries );
+
+    return target;
+}
+
+void ScaledTarget_delete( ScaledTarget* target )
+{
+    if( target == NULL )
+        return;
+
+    delete_framebuffer(target);
+    if( !target->synchronous )
+        ext_glDeleteQueries( SCALED_TARGET_QUERIES, target->queries );
+    free(target);
+}
+
+void ScaledTarget_setBudget( ScaledTarget* target, float budget )
+{
+    target->budget = budget;
+    if( budget <= 0.0f )
+        target->scale = 1.0f;
+}
+
+Viewport* ScaledTarget_begin( ScaledTarget* target, Viewport* viewport )
+{
+    // Without a budget there's nothing to time, or scale
+    target->viewport = target->budget > 0.0f ? viewport : NULL;
+    if( target->viewport == NULL )
+        return viewport;
+
+    start_timing(target);
+
+    if( target->scale >= 1.0f )
+        return viewport;
+
+    // Keep the framebuffer the size of the viewport, so that changing the
+    // scale never means reallocating it
+    if( (target->width != viewport->width ||
+         target->height != viewport->height) &&
+        !resize_framebuffer( target, viewport->width, viewport->height ) )
+    {
+        // Draw at full resolution from now on
+        ScaledTarget_setBudget( target, 0.0f );
+        return viewport;
+    }
+
+    glGetIntegerv( GL_FRAMEBUFFER_BINDING, &target->presented_framebuffer );
+    ext_glBindFramebuffer( GL_FRAMEBUFFER, target->framebuffer );
+
+    target->scaled = *viewport;
+    target->scaled.x = target->scaled.y = 0;
+    target->scaled.width = viewport->width * target->scale + 0.5f;
+    target->scaled.height = viewport->height * target->scale + 0.5f;
+    if( target->scaled.width < 1 )
+        target->scaled.width = 1;
+    if( target->scaled.height < 1 )
+        target->scaled.height = 1;
+
+    glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+
+    return &target->scaled;
+}
+
+void ScaledTarget_end( ScaledTarget* target )
+{
+    Viewport* viewport = target->viewport;
+
+    if( viewport == NULL )
+        return;
+
+    if( target->scale < 1.0f && target->framebuffer != 0 )
+    {
+        // Stretch what was drawn over the viewport
+        ext_glBindFramebuffer( GL_READ_FRAMEBUFFER, target->framebuffer );
+        ext_glBindFramebuffer( GL_DRAW_FRAMEBUFFER,
+                               target->presented_framebuffer );
+        ext_glBlitFramebuffer( 0, 0,
+                               target->scaled.width, target->scaled.height,
+                               viewport->x, viewport->y,
+                               viewport->x + viewport->width,
+                               viewport->y + viewport->height,
+                               GL_COLOR_BUFFER_BIT, GL_LINEAR );
+        ext_glBindFramebuffer( GL_FRAMEBUFFER, target->presented_framebuffer );
+    }
+
+    stop_timing(target);
+}
+
+
+/*******************************************************************************
+ * INTERNAL FUNCTIONS
+ ******************************************************************************/
+/**
+ * (Re)creates the offscreen framebuffer at the given size.
+ */
+int resize_framebuffer( ScaledTarget* target, int width, int height )
+{
+    delete_framebuffer(target);
+
+    ext_glGenRenderbuffers( 1, &target->color_buffer );
+    ext_glBindRenderbuffer( GL_RENDERBUFFER, target->color_buffer );
+    ext_glRenderbufferStorage( GL_RENDERBUFFER, GL_RGBA8, width, height );
+
+    ext_glGenRenderbuffers( 1, &target->depth_buffer );
+    ext_glBindRenderbuffer( GL_RENDERBUFFER, target->depth_buffer );
+    ext_glRenderbufferStorage( GL_RENDERBUFFER, GL_DEPTH_COMPONENT24,
+                               width, height );
+
+    glGetIntegerv( GL_FRAMEBUFFER_BINDING, &target->presented_framebuffer );
+    ext_glGenFramebuffers( 1, &target->framebuffer );
+    ext_glBindFramebuffer( GL_FRAMEBUFFER, target->framebuffer );
+    ext_glFramebufferRenderbuffer( GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                                   GL_RENDERBUFFER, target->color_buffer );
+    ext_glFramebufferRenderbuffer( GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
+                                   GL_RENDERBUFFER, target->depth_buffer );
+
+    if( ext_glCheckFramebufferStatus(GL_FRAMEBUFFER) !=
+        GL_FRAMEBUFFER_COMPLETE )
+    {
+        fprintf( stderr, "Could not create a %dx%d scaled framebuffer\n",
+                 width, height );
+        ext_glBindFramebuffer( GL_FRAMEBUFFER, target->presented_framebuffer );
+        delete_framebuffer(target);
+        return 0;
+    }
+    ext_glBindFramebuffer( GL_FRAMEBUFFER, target->presented_framebuffer );
+
+    target->width = width;
+    target->height = height;
+
+    return 1;
+}
+
+void delete_framebuffer( ScaledTarget* target )
+{
+    if( target->framebuffer != 0 )
+    {
+        ext_glDeleteFramebuffers( 1, &target->framebuffer );
+        ext_glDeleteRenderbuffers( 1, &target->color_buffer );
+        ext_glDeleteRenderbuffers( 1, &target->depth_buffer );
+    }
+    target->framebuffer = target->color_buffer = target->depth_buffer = 0;
+    target->width = target->height = 0;
+}
+
+/**
+ * Starts timing the viewport. With timer queries, this is also when the
+ * result of the query about to be reused is read.
+ */
+void start_timing( ScaledTarget* target )
+{
+    GLuint query;
+    GLint available = 0;
+    GLuint64 elapsed;
+
+    if( target->synchronous )
+    {
+        target->start_time = scaled_target_clock();
+        return;
+    }
+
+    query = target->queries[target->query_count % SCALED_TARGET_QUERIES];
+    if( target->query_count >= SCALED_TARGET_QUERIES )
+    {
+        // Don't wait for the GPU; a result that isn't ready is just skipped
+        ext_glGetQueryObjectiv( query, GL_QUERY_RESULT_AVAILABLE, &available );
+        if( available )
+        {
+            ext_glGetQueryObjectui64v( query, GL_QUERY_RESULT, &elapsed );
+            record_time( target, elapsed / 1000000.0f );
+        }
+    }
+
+    ext_glBeginQuery( GL_TIME_ELAPSED, query );
+}
+
+void stop_timing( ScaledTarget* target )
+{
+    if( target->synchronous )
+    {
+        // Wait for the viewport to be drawn, not just submitted
+        glFinish();
+        record_time( target, (scaled_target_clock() - target->start_time) /
+                             1000000.0f );
+        return;
+    }
+
+    ext_glEndQuery(GL_TIME_ELAPSED);
+    target->query_count++;
+}
+
+/**
+ * Takes the time the viewport took to draw into account, and picks the scale
+ * to draw it at next.
+ */
+void record_time( ScaledTarget* target, float time )
+{
+    float ideal;
+
+    if( target->time == 0.0f )
+        target->time = time;
+    else
+        target->time += TIME_SMOOTHING * (time - target->time);
+
+    if( target->budget <= 0.0f || target->time <= 0.0f )
+        return;
+
+    // Time goes with the number of pixels, which goes with the scale squared
+    ideal = target->scale * sqrtf( target->budget / target->time );
+
+    if( target->time > target->budget )
+        target->scale += SCALE_DOWN_RATE * (ideal - target->scale);
+    else if( target->time < target->budget * SCALE_UP_THRESHOLD )
+        target->scale = fminf( target->scale + SCALE_UP_STEP, ideal );
+
+    if( target->scale < MIN_SCALE )
+        target->scale = MIN_SCALE;
+    if( target->scale > 1.0f )
+        target->scale = 1.0f;
+}
+
+long long scaled_target_clock()
+{
+    struct timespec now;
+
+    clock_gettime( CLOCK_MONOTONIC, &now );
+
+    return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+/**
+ * Returns true if OpenGL is being rendered by the CPU. Software rasterizers
+ * (Mesa's, at least) draw when the frame is flushed, which their timer
+ * queries don't see.
+ */
+int is_software_renderer()
+{
+    const char* renderer = (const char*)glGetString(GL_RENDERER);
+
+    return renderer != NULL && (strstr( renderer, "llvmpipe" ) != NULL ||
+                                strstr( renderer, "softpipe" ) != NULL ||
+                                strstr( renderer, "Software" ) != NULL);
+}
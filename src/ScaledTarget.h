@@ -0,0 +1,82 @@
+#ifndef SCALEDTARGET_H_
+#define SCALEDTARGET_H_
+/**
+ * ScaledTarget.h
+ * Dynamic resolution scaling for a viewport.
+ *
+ * A scaled target times how long its viewport takes to draw, and when that's
+ * over budget, draws it into an offscreen framebuffer at a fraction of its
+ * size instead, which is then stretched back over the viewport. The time
+ * taken is roughly proportional to the number of pixels drawn, so the scale
+ * is set from the square root of the budget over the time taken, and eased
+ * back up once there's time to spare. At full scale the viewport is drawn
+ * straight into the window, as it would be without a target.
+ *
+ * Times come from the GPU's timer queries where there are any, read a couple
+ * of frames late so as never to wait for them. Without them, or on a software
+ * rasterizer (where there's no GPU to wait for anyway), the viewport is timed
+ * on the wall clock, up until it has finished drawing.
+ */
+
+#include "Viewport.h"
+#include <GL/gl.h>
+
+/*******************************************************************************
+ * TYPE DEFINITIONS
+ ******************************************************************************/
+// Queries in flight at once; results are read this many frames late
+#define SCALED_TARGET_QUERIES 2
+
+typedef struct {
+    float budget; // Milliseconds the viewport may take to draw (0 for no limit)
+    float scale; // Fraction of the viewport's width and height drawn
+    float time; // Recent milliseconds taken to draw, smoothed
+
+    // The viewport, as drawn into the framebuffer
+    Viewport scaled;
+    // The viewport being drawn (NULL if it isn't being timed), and the
+    // framebuffer it's presented into
+    Viewport* viewport;
+    GLint presented_framebuffer;
+
+    GLuint framebuffer, color_buffer, depth_buffer;
+    int width, height; // The framebuffer's size
+
+    int synchronous; // True if timed on the wall clock, rather than the GPU
+    GLuint queries[SCALED_TARGET_QUERIES];
+    int query_count; // Queries issued so far
+    long long start_time; // When drawing started, if synchronous
+} ScaledTarget;
+
+/**
+ * Creates a new scaled target, with no budget.
+ *
+ * Requires a current OpenGL context. Returns NULL if framebuffers can't be
+ * blitted between, since then there's nothing to scale with.
+ */
+ScaledTarget* ScaledTarget_new();
+/**
+ * Deletes a scaled target.
+ */
+void ScaledTarget_delete( ScaledTarget* target );
+
+/**
+ * Sets how many milliseconds the target's viewport may take to draw. 0 turns
+ * scaling off, drawing at full resolution.
+ */
+void ScaledTarget_setBudget( ScaledTarget* target, float budget );
+
+/**
+ * Starts drawing `viewport` through the target.
+ *
+ * Returns the viewport to draw, which is `viewport` itself at full scale, or
+ * a copy sized to the offscreen framebuffer (now bound) otherwise.
+ */
+Viewport* ScaledTarget_begin( ScaledTarget* target, Viewport* viewport );
+/**
+ * Finishes drawing, stretches the offscreen framebuffer over the viewport if
+ * it was used, and adjusts the scale for the next frame.
+ */
+void ScaledTarget_end( ScaledTarget* target );
+
+#endif /*SCALEDTARGET_H_*/
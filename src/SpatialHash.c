@@ -0,0 +1,173 @@
+#include "SpatialHash.h"
+#include <stdlib.h>
+#include <math.h>
+
+/*******************************************************************************
+ * INTERNAL FUNCTION PROTOTYPES
+ ******************************************************************************/
+int cell_column( SpatialHash* hash, float X );
+int cell_row( SpatialHash* hash, float Z );
+
+
+/*******************************************************************************
+ * CONSTRUCTORS/DESTRUCTORS
+ ******************************************************************************/
+SpatialHash* SpatialHash_new( float west, float south, float width,
+                              float depth, float cell_size, int items )
+{
+    SpatialHash* hash = (SpatialHash*)malloc( sizeof(SpatialHash) );
+    int i;
+
+    hash->west = west;
+    hash->south = south;
+    hash->cellSize = cell_size;
+    hash->columns = (int)ceilf( width / cell_size );
+    hash->rows = (int)ceilf( depth / cell_size );
+    if( hash->columns < 1 )
+        hash->columns = 1;
+    if( hash->rows < 1 )
+        hash->rows = 1;
+
+    hash->cells = (int*)malloc( sizeof(int) * hash->columns * hash->rows );
+    for( i = 0; i < hash->columns * hash->rows; i++ )
+        hash->cells[i] = -1;
+
+    hash->items = items;
+    hash->itemCells = (int*)malloc( sizeof(int) * items );
+    hash->previous = (int*)malloc( sizeof(int) * items );
+    hash->next = (int*)malloc( sizeof(int) * items );
+    for( i = 0; i < items; i++ )
+        hash->itemCells[i] = -1;
+
+    return hash;
+}
+
+void SpatialHash_delete( SpatialHash* hash )
+{
+    if( hash == NULL )
+        return;
+
+    free(hash->cells);
+    free(hash->itemCells);
+    free(hash->previous);
+    free(hash->next);
+    free(hash);
+}
+
+
+/*******************************************************************************
+ * HASH FUNCTIONS
+ ******************************************************************************/
+void SpatialHash_place( SpatialHash* hash, int item, float X, float Z )
+{
+    int cell = cell_row( hash, Z ) * hash->columns + cell_column( hash, X );
+
+    if( hash->itemCells[item] == cell )
+        return;
+
+    SpatialHash_remove( hash, item );
+
+    hash->itemCells[item] = cell;
+    hash->previous[item] = -1;
+    hash->next[item] = hash->cells[cell];
+    if( hash->cells[cell] >= 0 )
+        hash->previous[hash->cells[cell]] = item;
+    hash->cells[cell] = item;
+}
+
+void SpatialHash_remove( SpatialHash* hash, int item )
+{
+    int cell = hash->itemCells[item];
+
+    if( cell < 0 )
+        return;
+
+    if( hash->previous[item] >= 0 )
+        hash->next[hash->previous[item]] = hash->next[item];
+    else
+        hash->cells[cell] = hash->next[item];
+    if( hash->next[item] >= 0 )
+        hash->previous[hash->next[item]] = hash->previous[item];
+
+    hash->itemCells[item] = -1;
+}
+
+void SpatialHash_clear( SpatialHash* hash )
+{
+    int i;
+
+    // Only the cells with something in them need emptying
+    for( i = 0; i < hash->items; i++ )
+    {
+        if( hash->itemCells[i] >= 0 )
+            hash->cells[hash->itemCells[i]] = -1;
+        hash->itemCells[i] = -1;
+    }
+}
+
+int SpatialHash_first( SpatialHash* hash, SpatialHashQuery* query,
+                       float X, float Z, float radius )
+{
+    query->west = cell_column( hash, X - radius );
+    query->east = cell_column( hash, X + radius );
+    query->south = cell_row( hash, Z - radius );
+    query->north = cell_row( hash, Z + radius );
+    query->row = query->south;
+    query->column = query->west;
+    query->item = hash->cells[query->row * hash->columns + query->column];
+
+    return query->item >= 0 ? query->item : SpatialHash_next( hash, query );
+}
+
+int SpatialHash_next( SpatialHash* hash, SpatialHashQuery* query )
+{
+    if( query->item >= 0 )
+        query->item = hash->next[query->item];
+
+    // Move on through the cells until one has something in it
+    while( query->item < 0 )
+    {
+        if( ++query->column > query->east )
+        {
+            query->column = query->west;
+            if( ++query->row > query->north )
+                return -1;
+        }
+        query->item = hash->cells[query->row * hash->columns + query->column];
+    }
+
+    return query->item;
+}
+
+
+/*******************************************************************************
+ * INTERNAL FUNCTIONS
+ ******************************************************************************/
+/**
+ * Returns the column of cells X is in, counting points beyond the hash's
+ * bounds as in the cells at its edges.
+ */
+int cell_column( SpatialHash* hash, float X )
+{
+    int column = (int)floorf( (X - hash->west) / hash->cellSize );
+
+    if( column < 0 )
+        return 0;
+    if( column >= hash->columns )
+        return hash->columns - 1;
+    return column;
+}
+
+/**
+ * Returns the row of cells Z is in.
+ */
+int cell_row( SpatialHash* hash, float Z )
+{
+    int row = (int)floorf( (Z - hash->south) / hash->cellSize );
+
+    if( row < 0 )
+        return 0;
+    if( row >= hash->rows )
+        return hash->rows - 1;
+    return row;
+}
@@ -0,0 +1,86 @@
+#ifndef SPATIALHASH_H_
+#define SPATIALHASH_H_
+/**
+ * SpatialHash.h
+ * Finds which of a set of things are near a point on the ground.
+ *
+ * The ground (X and Z) is divided into square cells, each with a list of the
+ * things in it. Each thing is a number, from 0 up to the number the hash was
+ * made for, and is in one cell at most. Finding what's near a point only
+ * looks at the cells around it, so takes the same time however many things
+ * there are, so long as they're spread out, and moving a thing is a matter of
+ * unlinking it from one list and linking it into another.
+ *
+ * A hash is given how big things are by its cell size: asking for what's
+ * within a cell's width of a point looks at the cells overlapping a square
+ * three cells wide at most.
+ */
+
+/*******************************************************************************
+ * TYPE DEFINITIONS
+ ******************************************************************************/
+typedef struct {
+    float west, south; // The bounds of the cells, in the negative directions
+    float cellSize;
+    int columns, rows; // The cells east-west, and north-south
+    // The first thing in each cell, or -1, cell by cell, row by row
+    int* cells;
+    // The cell each thing is in, or -1, and the things before and after it
+    // there (or -1)
+    int* itemCells;
+    int* previous;
+    int* next;
+    int items;
+} SpatialHash;
+
+/**
+ * A search for what's near a point (see SpatialHash_first): the cells it
+ * covers, and where it's up to.
+ */
+typedef struct {
+    int west, east, south, north;
+    int row, column, item;
+} SpatialHashQuery;
+
+/*******************************************************************************
+ * CONSTRUCTORS/DESTRUCTORS
+ ******************************************************************************/
+/**
+ * Creates an empty hash of `items` things, with cells `cell_size` across
+ * covering the area `width` east of `west` and `depth` north of `south`.
+ * Things may go outside the area, but are counted as being in the cell at its
+ * edge.
+ */
+SpatialHash* SpatialHash_new( float west, float south, float width,
+                              float depth, float cell_size, int items );
+void SpatialHash_delete( SpatialHash* hash );
+
+/*******************************************************************************
+ * HASH FUNCTIONS
+ ******************************************************************************/
+/**
+ * Puts thing number `item` at the given point, moving it if it's elsewhere.
+ */
+void SpatialHash_place( SpatialHash* hash, int item, float X, float Z );
+/**
+ * Takes the thing out of the hash, if it's in it.
+ */
+void SpatialHash_remove( SpatialHash* hash, int item );
+/**
+ * Takes everything out of the hash.
+ */
+void SpatialHash_clear( SpatialHash* hash );
+/**
+ * Starts looking for the things which may be within `radius` of the given
+ * point: those in cells within that distance, in no particular order. Returns
+ * the first of them, or -1 if there are none.
+ */
+int SpatialHash_first( SpatialHash* hash, SpatialHashQuery* query,
+                       float X, float Z, float radius );
+/**
+ * Returns the next thing found by the query, or -1 if there are no more. The
+ * hash mustn't be changed during a query.
+ */
+int SpatialHash_next( SpatialHash* hash, SpatialHashQuery* query );
+
+#endif /*SPATIALHASH_H_*/
@@ -0,0 +1,259 @@
+#include "StateHasher.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*******************************************************************************
+ * GLOBALS AND CONSTANTS
+ ******************************************************************************/
+// 64-bit FNV-1a
+#define FNV_OFFSET_BASIS 0xcbf29ce484222325ULL
+#define FNV_PRIME 0x100000001b3ULL
+
+static const char* part_names[STATE_PARTS] = {
+    "game", "random numbers", "players", "player bodies", "projectiles",
+    "edibles", "terrain"
+};
+
+
+/*******************************************************************************
+ * INTERNAL FUNCTION PROTOTYPES
+ ******************************************************************************/
+unsigned long long hash_bytes( unsigned long long hash, const void* data,
+                               size_t size );
+unsigned long long hash_int( unsigned long long hash, int value );
+unsigned long long hash_floats( unsigned long long hash, const float* values,
+                                int count );
+unsigned long long hash_player( Player* player );
+unsigned long long hash_body( Player* player );
+unsigned long long hash_object( ObjectPool* pool, ObjectHandle handle,
+                                unsigned long long hash );
+unsigned long long hash_terrain( StateHasher* hasher, GameState* gamestate );
+
+
+/*******************************************************************************
+ * CONSTRUCTORS/DESTRUCTORS
+ ******************************************************************************/
+StateHasher* StateHasher_new()
+{
+    return (StateHasher*)calloc( 1, sizeof(StateHasher) );
+}
+
+void StateHasher_delete( StateHasher* hasher )
+{
+    if( hasher == NULL )
+        return;
+
+    free(hasher->rowVersions);
+    free(hasher->rowHashes);
+    free(hasher);
+}
+
+
+/*******************************************************************************
+ * HASHING FUNCTIONS
+ ******************************************************************************/
+void StateHasher_hash( StateHasher* hasher, GameState* gamestate,
+                       StateHash* hash )
+{
+    unsigned long long part, player, body, projectiles;
+    int i;
+
+    part = hash_int( FNV_OFFSET_BASIS, gamestate->mode );
+    part = hash_floats( part, &gamestate->countdown, 1 );
+    part = hash_int( part, gamestate->generation );
+    part = hash_int( part, gamestate->winner );
+    part = hash_int( part, gamestate->deformations );
+    part = hash_floats( part, &gamestate->playerSpeed, 1 );
+    // Rules are all ints and floats, so have no padding
+    part = hash_bytes( part, &gamestate->rules, sizeof(Rules) );
+    hash->parts[STATE_GAME] = part;
+
+    part = hash_bytes( FNV_OFFSET_BASIS, &gamestate->terrainRandom,
+                       sizeof(Random) );
+    hash->parts[STATE_RANDOM] = hash_bytes( part, &gamestate->foodRandom,
+                                            sizeof(Random) );
+
+    part = hash_int( FNV_OFFSET_BASIS, gamestate->playerCount );
+    part = hash_int( part, gamestate->playersLeft );
+    body = FNV_OFFSET_BASIS;
+    projectiles = FNV_OFFSET_BASIS;
+    for( i = 0; i < gamestate->playerCount; i++ )
+    {
+        player = hash_player( gamestate->players[i] );
+        part = hash_bytes( part, &player, sizeof(unsigned long long) );
+        player = hash_body( gamestate->players[i] );
+        body = hash_bytes( body, &player, sizeof(unsigned long long) );
+        projectiles = hash_object( gamestate->projectiles,
+                                   gamestate->playerProjectiles[i],
+                                   projectiles );
+    }
+    hash->parts[STATE_PLAYERS] = part;
+    hash->parts[STATE_BODIES] = body;
+    hash->parts[STATE_PROJECTILES] = projectiles;
+    hash->parts[STATE_EDIBLES] = hash_object( gamestate->edibles,
+                                              gamestate->edible,
+                                              FNV_OFFSET_BASIS );
+
+    hash->parts[STATE_TERRAIN] = hash_terrain( hasher, gamestate );
+
+    hash->total = FNV_OFFSET_BASIS;
+    for( i = 0; i < STATE_PARTS; i++ )
+        hash->total = hash_bytes( hash->total, &hash->parts[i],
+                                  sizeof(unsigned long long) );
+}
+
+const char* StateHasher_partName( StatePart part )
+{
+    return part >= 0 && part < STATE_PARTS ? part_names[part] : "?";
+}
+
+
+/*******************************************************************************
+ * INTERNAL FUNCTIONS
+ ******************************************************************************/
+unsigned long long hash_bytes( unsigned long long hash, const void* data,
+                               size_t size )
+{
+    const unsigned char* byte = (const unsigned char*)data;
+    size_t i;
+
+    for( i = 0; i < size; i++ )
+    {
+        hash ^= byte[i];
+        hash *= FNV_PRIME;
+    }
+
+    return hash;
+}
+
+unsigned long long hash_int( unsigned long long hash, int value )
+{
+    return hash_bytes( hash, &value, sizeof(int) );
+}
+
+unsigned long long hash_floats( unsigned long long hash, const float* values,
+                                int count )
+{
+    return hash_bytes( hash, values, sizeof(float) * count );
+}
+
+/**
+ * Hashes whether a player's still in, their head, where they're going, and
+ * their score.
+ */
+unsigned long long hash_player( Player* player )
+{
+    unsigned long long hash = FNV_OFFSET_BASIS;
+
+    hash = hash_int( hash, player->out );
+    hash = hash_floats( hash, player->headPosition, 3 );
+    hash = hash_floats( hash, &player->headOffset, 1 );
+    hash = hash_int( hash, player->currentDir );
+    hash = hash_int( hash, player->nextDir );
+    hash = hash_floats( hash, player->forward, 3 );
+    hash = hash_floats( hash, player->up, 3 );
+    hash = hash_floats( hash, &player->radius, 1 );
+    hash = hash_int( hash, player->underGround );
+    hash = hash_int( hash, player->score );
+
+    return hash;
+}
+
+/**
+ * Hashes a player's joints, from the head back, and their tail and length.
+ */
+unsigned long long hash_body( Player* player )
+{
+    unsigned long long hash = FNV_OFFSET_BASIS;
+    int i;
+
+    hash = hash_int( hash, player->jointCount );
+    hash = hash_int( hash, player->jointsLaid );
+    for( i = 0; i < player->jointCount; i++ )
+        hash = hash_bytes( hash, Player_joint( player, i ), sizeof(Joint) );
+    hash = hash_floats( hash, player->tailPosition, 3 );
+    hash = hash_floats( hash, &player->tailOffset, 1 );
+    hash = hash_floats( hash, &player->length, 1 );
+    hash = hash_floats( hash, &player->maxLength, 1 );
+
+    return hash;
+}
+
+/**
+ * Adds an object to the hash, or the lack of one: where it is and how it's
+ * moving, the arc it was launched on and how far along it it is, and the
+ * ground under it.
+ */
+unsigned long long hash_object( ObjectPool* pool, ObjectHandle handle,
+                                unsigned long long hash )
+{
+    int place = ObjectPool_find( pool, handle ), axis;
+
+    hash = hash_int( hash, place >= 0 );
+    if( place < 0 )
+        return hash;
+
+    // Field by field, in the same order (and so to the same hash) as when
+    // objects kept their fields together
+    for( axis = 0; axis < 3; axis++ )
+        hash = hash_floats( hash, &pool->position[axis][place], 1 );
+    for( axis = 0; axis < 3; axis++ )
+        hash = hash_floats( hash, &pool->velocity[axis][place], 1 );
+    hash = hash_floats( hash, &pool->radius[place], 1 );
+    // Projectiles' positions are worked out from these (see ObjectPool_fly),
+    // so they can differ before the positions do
+    for( axis = 0; axis < 3; axis++ )
+        hash = hash_floats( hash, &pool->origin[axis][place], 1 );
+    for( axis = 0; axis < 3; axis++ )
+        hash = hash_floats( hash, &pool->launch[axis][place], 1 );
+    hash = hash_floats( hash, &pool->flight[place], 1 );
+    return hash_floats( hash, &pool->ground[place], 1 );
+}
+
+/**
+ * Hashes the landscape's points, hashing again only the rows that have
+ * changed since they were last hashed.
+ */
+unsigned long long hash_terrain( StateHasher* hasher, GameState* gamestate )
+{
+    Landscape* landscape = gamestate->landscape;
+    unsigned long long hash = FNV_OFFSET_BASIS;
+    int row, column, new_game;
+
+    // A new game has a new landscape, of which nothing's been hashed yet
+    new_game = hasher->rowHashes == NULL ||
+               hasher->generation != gamestate->generation ||
+               hasher->rows != landscape->gridWidth;
+    if( new_game && hasher->rows != landscape->gridWidth )
+    {
+        free(hasher->rowVersions);
+        free(hasher->rowHashes);
+        hasher->rows = landscape->gridWidth;
+        hasher->rowVersions = (unsigned int*)malloc( sizeof(unsigned int) *
+                                                     hasher->rows );
+        hasher->rowHashes = (unsigned long long*)
+            malloc( sizeof(unsigned long long) * hasher->rows );
+    }
+    hasher->generation = gamestate->generation;
+
+    for( row = 0; row < hasher->rows; row++ )
+    {
+        if( new_game ||
+            hasher->rowVersions[row] != landscape->rowVersions[row] )
+        {
+            hasher->rowHashes[row] = FNV_OFFSET_BASIS;
+            for( column = 0; column < landscape->gridWidth; column++ )
+            {
+                hasher->rowHashes[row] =
+                    hash_floats( hasher->rowHashes[row],
+                                 landscape->pointMap[row][column], 3 );
+            }
+            hasher->rowVersions[row] = landscape->rowVersions[row];
+        }
+
+        hash = hash_bytes( hash, &hasher->rowHashes[row],
+                           sizeof(unsigned long long) );
+    }
+
+    return hash;
+}
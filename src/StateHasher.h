@@ -0,0 +1,78 @@
+#ifndef STATEHASHER_H_
+#define STATEHASHER_H_
+/**
+ * StateHasher.h
+ * Fingerprints of a gamestate, to tell whether two games are in step.
+ *
+ * A game's state is hashed in parts (the players, their bodies, the objects,
+ * the terrain and so on, however many players there are), each a 64-bit
+ * FNV-1a hash of its fields' bits, and the parts are hashed together into
+ * one. Two games in the same state have the same hash; when the hashes
+ * differ, the parts say where. Only the fields that decide how the game goes
+ * on are hashed, in a fixed order, so pointers, padding and what's only kept
+ * for drawing make no difference.
+ *
+ * Hashing the whole terrain every tick would take longer than the tick, so
+ * the hasher keeps a hash of each row of the landscape, and only hashes rows
+ * again once they've changed (see the landscape's `rowVersions`).
+ */
+
+#include "GameState.h"
+
+/*******************************************************************************
+ * TYPE DEFINITIONS
+ ******************************************************************************/
+/**
+ * The parts of the state hashed separately.
+ */
+typedef enum {
+    STATE_GAME, // The mode, countdown, outcome and rules
+    STATE_RANDOM, // The random number streams
+    STATE_PLAYERS, // Who's still in, and each player's head, direction and score
+    STATE_BODIES, // Each player's joints, tail and length
+    // Each player's projectile, with the arc it's flying along
+    STATE_PROJECTILES,
+    STATE_EDIBLES,
+    STATE_TERRAIN,
+    STATE_PARTS
+} StatePart;
+
+typedef struct {
+    unsigned long long parts[STATE_PARTS];
+    unsigned long long total; // The parts, hashed together
+} StateHash;
+
+/**
+ * Hashes one gamestate's states, tick after tick.
+ */
+typedef struct {
+    // The game the cached row hashes are of (see the gamestate's
+    // `generation`), and the number of rows
+    unsigned int generation;
+    int rows;
+    // For each row of the landscape, the version it was hashed at, and its
+    // hash
+    unsigned int* rowVersions;
+    unsigned long long* rowHashes;
+} StateHasher;
+
+/*******************************************************************************
+ * CONSTRUCTORS/DESTRUCTORS
+ ******************************************************************************/
+StateHasher* StateHasher_new();
+void StateHasher_delete( StateHasher* hasher );
+
+/*******************************************************************************
+ * HASHING FUNCTIONS
+ ******************************************************************************/
+/**
+ * Hashes the gamestate, which must have a game in it.
+ */
+void StateHasher_hash( StateHasher* hasher, GameState* gamestate,
+                       StateHash* hash );
+/**
+ * Returns the name of a part of the state, e.g. "player bodies".
+ */
+const char* StateHasher_partName( StatePart part );
+
+#endif /*STATEHASHER_H_*/
@@ -0,0 +1,541 @@
+#include "TerrainMesh.h"
+#include "glext.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <float.h>
+
+/*******************************************************************************
+ * GLOBALS AND CONSTANTS
+ ******************************************************************************/
+// The width and depth of a chunk, in grid divisions
+#define CHUNK_SIZE 16
+// The width and depth of an occluder tile, in grid divisions
+#define TILE_SIZE 4
+
+
+/*******************************************************************************
+ * INTERNAL FUNCTION PROTOTYPES
+ ******************************************************************************/
+void resize_mesh( TerrainMesh* mesh, int grid_width );
+void free_mesh( TerrainMesh* mesh );
+void copy_row( TerrainMesh* mesh, Landscape* landscape, int row );
+void update_chunk_bounds( TerrainMesh* mesh, int first_row, int last_row );
+void update_tile_heights( TerrainMesh* mesh, int first_row, int last_row );
+void update_segment_heights( TerrainMesh* mesh, int first_row,
+                             int last_row );
+int segment_hidden( TerrainMesh* mesh, Horizon* horizon, int column,
+                    int chunk_row );
+int last_point( TerrainMesh* mesh, int first, int size );
+void draw_strip( TerrainMesh* mesh, int column, int first_row, int last_row,
+                 int* draw_calls, int* vertices );
+
+
+/*******************************************************************************
+ * CONSTRUCTORS/DESTRUCTORS
+ ******************************************************************************/
+TerrainMesh* TerrainMesh_new()
+{
+    TerrainMesh* mesh = (TerrainMesh*)calloc( 1, sizeof(TerrainMesh) );
+
+    mesh->empty = 1;
+
+    return mesh;
+}
+
+void TerrainMesh_delete( TerrainMesh* mesh )
+{
+    if( mesh == NULL )
+        return;
+
+    free_mesh(mesh);
+    free(mesh);
+}
+
+
+/*******************************************************************************
+ * TERRAIN MESH FUNCTIONS
+ ******************************************************************************/
+void TerrainMesh_update( TerrainMesh* mesh, Landscape* landscape,
+                         unsigned int generation )
+{
+    int row, first_row, last_row, refill;
+
+    if( mesh->gridWidth != landscape->gridWidth )
+        resize_mesh( mesh, landscape->gridWidth );
+
+    refill = mesh->empty || mesh->generation != generation;
+
+    first_row = mesh->gridWidth;
+    last_row = -1;
+    for( row = 0; row < mesh->gridWidth; row++ )
+    {
+        if( refill || mesh->rowVersions[row] != landscape->rowVersions[row] )
+        {
+            copy_row( mesh, landscape, row );
+            if( row < first_row )
+                first_row = row;
+            last_row = row;
+        }
+    }
+
+    if( last_row >= 0 )
+    {
+        // Changes are local, so upload every row between the first and last
+        // changed in one go
+        if( mesh->vertexBuffer != 0 )
+        {
+            ext_glBindBuffer( GL_ARRAY_BUFFER, mesh->vertexBuffer );
+            ext_glBufferSubData( GL_ARRAY_BUFFER,
+                sizeof(TerrainVertex) * first_row * mesh->gridWidth,
+                sizeof(TerrainVertex) * (last_row - first_row + 1) *
+                    mesh->gridWidth,
+                &mesh->vertices[first_row * mesh->gridWidth] );
+            ext_glBindBuffer( GL_ARRAY_BUFFER, 0 );
+        }
+        update_chunk_bounds( mesh, first_row, last_row );
+        update_tile_heights( mesh, first_row, last_row );
+        update_segment_heights( mesh, first_row, last_row );
+    }
+
+    mesh->generation = generation;
+    mesh->empty = 0;
+}
+
+void TerrainMesh_addOccluders( TerrainMesh* mesh, Horizon* horizon,
+                               Frustum* frustum )
+{
+    float min[3], max[3], *first, *last, lowest = FLT_MAX;
+    int tile_row, tile_column, row, column, row_end, column_end, i;
+
+    if( mesh->empty )
+        return;
+
+    for( i = 0; i < mesh->tiles * mesh->tiles; i++ )
+    {
+        if( mesh->tileHeights[i] < lowest )
+            lowest = mesh->tileHeights[i];
+    }
+
+    for( tile_row = 0; tile_row < mesh->tiles; tile_row++ )
+    {
+        row = tile_row * TILE_SIZE;
+        row_end = last_point( mesh, row, TILE_SIZE );
+        for( tile_column = 0; tile_column < mesh->tiles; tile_column++ )
+        {
+            column = tile_column * TILE_SIZE;
+            column_end = last_point( mesh, column, TILE_SIZE );
+
+            // The grid is square to the axes, so opposite corners bound it
+            first = mesh->vertices[row * mesh->gridWidth + column].position;
+            last = mesh->vertices[row_end * mesh->gridWidth +
+                                  column_end].position;
+            min[0] = first[0] < last[0] ? first[0] : last[0];
+            max[0] = first[0] < last[0] ? last[0] : first[0];
+            min[2] = first[2] < last[2] ? first[2] : last[2];
+            max[2] = first[2] < last[2] ? last[2] : first[2];
+            min[1] = max[1] =
+                mesh->tileHeights[tile_row * mesh->tiles + tile_column];
+
+            // Lines of sight to what's in view stay in view, so a tile out of
+            // view can't block them. (Leaving out an occluder only ever hides
+            // less, so the test needn't be exact.)
+            min[1] = lowest;
+            if( frustum_contains_box( frustum, min, max ) )
+            {
+                min[1] = max[1];
+                Horizon_addOccluder( horizon, min, max );
+            }
+        }
+    }
+}
+
+void TerrainMesh_draw( TerrainMesh* mesh, Frustum* frustum, Horizon* horizon,
+                       int* draw_calls, int* vertices, int* occluded )
+{
+    const char* base;
+    int i, column, chunk_row, chunk_column, first_row, last_row, hidden;
+
+    if( mesh->empty )
+        return;
+
+    // Cull
+    for( i = 0; i < mesh->chunks * mesh->chunks; i++ )
+    {
+        mesh->chunkVisible[i] =
+            frustum_contains_box( frustum, mesh->chunkMin[i],
+                                  mesh->chunkMax[i] );
+    }
+
+    // With buffer objects, pointers are offsets into the buffers
+    if( mesh->vertexBuffer != 0 )
+    {
+        ext_glBindBuffer( GL_ARRAY_BUFFER, mesh->vertexBuffer );
+        ext_glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, mesh->indexBuffer );
+        base = NULL;
+    }
+    else
+    {
+        base = (const char*)mesh->vertices;
+    }
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_NORMAL_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glVertexPointer( 3, GL_FLOAT, sizeof(TerrainVertex),
+                     base + offsetof( TerrainVertex, position ) );
+    glNormalPointer( GL_FLOAT, sizeof(TerrainVertex),
+                     base + offsetof( TerrainVertex, normal ) );
+    glColorPointer( 3, GL_FLOAT, sizeof(TerrainVertex),
+                    base + offsetof( TerrainVertex, color ) );
+
+    // Draw each column's visible run of chunks with one call. Within the
+    // chunks in the frustum, each column's segment is checked against the
+    // horizon by itself, since hills hide much less of a whole chunk.
+    for( column = 0; column < mesh->gridWidth - 1; column++ )
+    {
+        chunk_column = column / CHUNK_SIZE;
+        first_row = last_row = -1;
+
+        for( chunk_row = 0; chunk_row < mesh->chunks; chunk_row++ )
+        {
+            hidden = 0;
+            if( mesh->chunkVisible[chunk_row * mesh->chunks + chunk_column] &&
+                horizon != NULL &&
+                segment_hidden( mesh, horizon, column, chunk_row ) )
+            {
+                hidden = 1;
+                (*occluded)++;
+            }
+
+            if( mesh->chunkVisible[chunk_row * mesh->chunks + chunk_column] &&
+                !hidden )
+            {
+                if( first_row < 0 )
+                    first_row = chunk_row * CHUNK_SIZE;
+                last_row = chunk_row * CHUNK_SIZE + CHUNK_SIZE;
+                if( last_row > mesh->gridWidth - 1 )
+                    last_row = mesh->gridWidth - 1;
+            }
+            else if( first_row >= 0 )
+            {
+                draw_strip( mesh, column, first_row, last_row,
+                            draw_calls, vertices );
+                first_row = -1;
+            }
+        }
+        if( first_row >= 0 )
+            draw_strip( mesh, column, first_row, last_row,
+                        draw_calls, vertices );
+    }
+
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glDisableClientState(GL_COLOR_ARRAY);
+
+    // Leave no buffers bound, or other modules' vertex arrays would be taken
+    // as offsets into them
+    if( mesh->vertexBuffer != 0 )
+    {
+        ext_glBindBuffer( GL_ARRAY_BUFFER, 0 );
+        ext_glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, 0 );
+    }
+}
+
+
+/*******************************************************************************
+ * INTERNAL FUNCTIONS
+ ******************************************************************************/
+/**
+ * Reallocates the mesh for a landscape `grid_width` points wide, leaving it
+ * empty.
+ */
+void resize_mesh( TerrainMesh* mesh, int grid_width )
+{
+    int row, column;
+    GLuint* index;
+
+    free_mesh(mesh);
+
+    mesh->gridWidth = grid_width;
+    mesh->chunks = (grid_width - 1 + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    mesh->empty = 1;
+
+    mesh->vertices = (TerrainVertex*)malloc( sizeof(TerrainVertex) *
+                                             grid_width * grid_width );
+    mesh->indices = (GLuint*)malloc( sizeof(GLuint) *
+                                     (grid_width - 1) * grid_width * 2 );
+    mesh->chunkMin = malloc( sizeof(float) * 3 * mesh->chunks * mesh->chunks );
+    mesh->chunkMax = malloc( sizeof(float) * 3 * mesh->chunks * mesh->chunks );
+    mesh->chunkVisible = (unsigned char*)malloc( mesh->chunks * mesh->chunks );
+    mesh->tiles = (grid_width - 1 + TILE_SIZE - 1) / TILE_SIZE;
+    mesh->tileHeights = (float*)malloc( sizeof(float) * mesh->tiles *
+                                        mesh->tiles );
+    mesh->segmentHeights = (float*)malloc( sizeof(float) * mesh->chunks *
+                                           (grid_width - 1) );
+    mesh->rowVersions = (unsigned int*)calloc( grid_width,
+                                               sizeof(unsigned int) );
+
+    // Each column is a strip zig-zagging between its left and right edges
+    index = mesh->indices;
+    for( column = 0; column < grid_width - 1; column++ )
+    {
+        for( row = 0; row < grid_width; row++ )
+        {
+            *index++ = row * grid_width + column;
+            *index++ = row * grid_width + column + 1;
+        }
+    }
+
+    if( glext_has_buffers() )
+    {
+        ext_glGenBuffers( 1, &mesh->vertexBuffer );
+        ext_glBindBuffer( GL_ARRAY_BUFFER, mesh->vertexBuffer );
+        ext_glBufferData( GL_ARRAY_BUFFER,
+                          sizeof(TerrainVertex) * grid_width * grid_width,
+                          NULL, GL_DYNAMIC_DRAW );
+        ext_glBindBuffer( GL_ARRAY_BUFFER, 0 );
+
+        ext_glGenBuffers( 1, &mesh->indexBuffer );
+        ext_glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, mesh->indexBuffer );
+        ext_glBufferData( GL_ELEMENT_ARRAY_BUFFER,
+                          sizeof(GLuint) * (grid_width - 1) * grid_width * 2,
+                          mesh->indices, GL_STATIC_DRAW );
+        ext_glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, 0 );
+    }
+}
+
+void free_mesh( TerrainMesh* mesh )
+{
+    if( mesh->vertexBuffer != 0 )
+    {
+        ext_glDeleteBuffers( 1, &mesh->vertexBuffer );
+        ext_glDeleteBuffers( 1, &mesh->indexBuffer );
+    }
+    mesh->vertexBuffer = mesh->indexBuffer = 0;
+
+    free( mesh->vertices );
+    free( mesh->indices );
+    free( mesh->chunkMin );
+    free( mesh->chunkMax );
+    free( mesh->chunkVisible );
+    free( mesh->tileHeights );
+    free( mesh->segmentHeights );
+    free( mesh->rowVersions );
+    mesh->vertices = NULL;
+    mesh->indices = NULL;
+    mesh->chunkMin = mesh->chunkMax = NULL;
+    mesh->chunkVisible = NULL;
+    mesh->tileHeights = mesh->segmentHeights = NULL;
+    mesh->rowVersions = NULL;
+    mesh->gridWidth = mesh->chunks = mesh->tiles = 0;
+}
+
+void copy_row( TerrainMesh* mesh, Landscape* landscape, int row )
+{
+    TerrainVertex* vertex = &mesh->vertices[row * mesh->gridWidth];
+    int column;
+
+    for( column = 0; column < mesh->gridWidth; column++, vertex++ )
+    {
+        memcpy( vertex->position, landscape->pointMap[row][column],
+                sizeof(GLfloat) * 3 );
+        memcpy( vertex->normal, landscape->normalMap[row][column],
+                sizeof(GLfloat) * 3 );
+        memcpy( vertex->color, landscape->colorMap[row][column],
+                sizeof(GLfloat) * 3 );
+    }
+
+    mesh->rowVersions[row] = landscape->rowVersions[row];
+}
+
+/**
+ * Recalculates the bounds of every chunk with points in the given rows.
+ */
+void update_chunk_bounds( TerrainMesh* mesh, int first_row, int last_row )
+{
+    int first_chunk_row, last_chunk_row, chunk_row, chunk_column,
+        row, column, row_end, column_end, i, k;
+    float *min, *max, *position;
+
+    // The rows on a chunk's edge are shared with the next chunk
+    first_chunk_row = first_row > 0 ? (first_row - 1) / CHUNK_SIZE : 0;
+    last_chunk_row = last_row / CHUNK_SIZE;
+    if( last_chunk_row >= mesh->chunks )
+        last_chunk_row = mesh->chunks - 1;
+
+    for( chunk_row = first_chunk_row; chunk_row <= last_chunk_row;
+         chunk_row++ )
+    {
+        for( chunk_column = 0; chunk_column < mesh->chunks; chunk_column++ )
+        {
+            i = chunk_row * mesh->chunks + chunk_column;
+            min = mesh->chunkMin[i];
+            max = mesh->chunkMax[i];
+            memcpy( min, mesh->vertices[chunk_row * CHUNK_SIZE *
+                                        mesh->gridWidth +
+                                        chunk_column * CHUNK_SIZE].position,
+                    sizeof(float) * 3 );
+            memcpy( max, min, sizeof(float) * 3 );
+
+            row_end = chunk_row * CHUNK_SIZE + CHUNK_SIZE;
+            if( row_end > mesh->gridWidth - 1 )
+                row_end = mesh->gridWidth - 1;
+            column_end = chunk_column * CHUNK_SIZE + CHUNK_SIZE;
+            if( column_end > mesh->gridWidth - 1 )
+                column_end = mesh->gridWidth - 1;
+
+            for( row = chunk_row * CHUNK_SIZE; row <= row_end; row++ )
+            {
+                for( column = chunk_column * CHUNK_SIZE; column <= column_end;
+                     column++ )
+                {
+                    position =
+                        mesh->vertices[row * mesh->gridWidth + column].position;
+                    for( k = 0; k < 3; k++ )
+                    {
+                        if( position[k] < min[k] )
+                            min[k] = position[k];
+                        if( position[k] > max[k] )
+                            max[k] = position[k];
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Recalculates the lowest height of every occluder tile with points in the
+ * given rows.
+ */
+void update_tile_heights( TerrainMesh* mesh, int first_row, int last_row )
+{
+    int first_tile_row, last_tile_row, tile_row, tile_column,
+        row, column, row_end, column_end;
+    float *lowest, height;
+
+    // As with chunks, the rows on a tile's edge are shared with the next
+    first_tile_row = first_row > 0 ? (first_row - 1) / TILE_SIZE : 0;
+    last_tile_row = last_row / TILE_SIZE;
+    if( last_tile_row >= mesh->tiles )
+        last_tile_row = mesh->tiles - 1;
+
+    for( tile_row = first_tile_row; tile_row <= last_tile_row; tile_row++ )
+    {
+        row_end = last_point( mesh, tile_row * TILE_SIZE, TILE_SIZE );
+        for( tile_column = 0; tile_column < mesh->tiles; tile_column++ )
+        {
+            lowest = &mesh->tileHeights[tile_row * mesh->tiles + tile_column];
+            column_end = last_point( mesh, tile_column * TILE_SIZE,
+                                     TILE_SIZE );
+            *lowest = mesh->vertices[tile_row * TILE_SIZE * mesh->gridWidth +
+                                     tile_column * TILE_SIZE].position[1];
+
+            for( row = tile_row * TILE_SIZE; row <= row_end; row++ )
+            {
+                for( column = tile_column * TILE_SIZE; column <= column_end;
+                     column++ )
+                {
+                    height =
+                        mesh->vertices[row * mesh->gridWidth + column]
+                            .position[1];
+                    if( height < *lowest )
+                        *lowest = height;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Recalculates the highest point of every column's segment with points in
+ * the given rows.
+ */
+void update_segment_heights( TerrainMesh* mesh, int first_row, int last_row )
+{
+    int first_chunk_row, last_chunk_row, chunk_row, column, row, row_end;
+    float *highest, *left, *right;
+
+    first_chunk_row = first_row > 0 ? (first_row - 1) / CHUNK_SIZE : 0;
+    last_chunk_row = last_row / CHUNK_SIZE;
+    if( last_chunk_row >= mesh->chunks )
+        last_chunk_row = mesh->chunks - 1;
+
+    for( chunk_row = first_chunk_row; chunk_row <= last_chunk_row;
+         chunk_row++ )
+    {
+        row_end = last_point( mesh, chunk_row * CHUNK_SIZE, CHUNK_SIZE );
+        for( column = 0; column < mesh->gridWidth - 1; column++ )
+        {
+            highest = &mesh->segmentHeights[chunk_row * (mesh->gridWidth - 1) +
+                                            column];
+            *highest = mesh->vertices[chunk_row * CHUNK_SIZE *
+                                      mesh->gridWidth + column].position[1];
+
+            for( row = chunk_row * CHUNK_SIZE; row <= row_end; row++ )
+            {
+                left = mesh->vertices[row * mesh->gridWidth + column].position;
+                right = mesh->vertices[row * mesh->gridWidth + column + 1]
+                            .position;
+                if( left[1] > *highest )
+                    *highest = left[1];
+                if( right[1] > *highest )
+                    *highest = right[1];
+            }
+        }
+    }
+}
+
+/**
+ * Returns true if the horizon hides the segment of a column's strip in the
+ * given row of chunks.
+ */
+int segment_hidden( TerrainMesh* mesh, Horizon* horizon, int column,
+                    int chunk_row )
+{
+    float min[3], max[3], *first, *last;
+    int row = chunk_row * CHUNK_SIZE,
+        row_end = last_point( mesh, row, CHUNK_SIZE );
+
+    first = mesh->vertices[row * mesh->gridWidth + column].position;
+    last = mesh->vertices[row_end * mesh->gridWidth + column + 1].position;
+    min[0] = first[0] < last[0] ? first[0] : last[0];
+    max[0] = first[0] < last[0] ? last[0] : first[0];
+    min[2] = first[2] < last[2] ? first[2] : last[2];
+    max[2] = first[2] < last[2] ? last[2] : first[2];
+    min[1] = max[1] =
+        mesh->segmentHeights[chunk_row * (mesh->gridWidth - 1) + column];
+
+    return Horizon_hides( horizon, min, max );
+}
+
+/**
+ * Returns the last point of a chunk or tile `size` divisions wide starting at
+ * point `first`, which is cut short at the edge of the landscape.
+ */
+int last_point( TerrainMesh* mesh, int first, int size )
+{
+    return first + size > mesh->gridWidth - 1 ? mesh->gridWidth - 1 :
+                                                first + size;
+}
+
+/**
+ * Draws part of a column's strip, from `first_row` to `last_row`.
+ */
+void draw_strip( TerrainMesh* mesh, int column, int first_row, int last_row,
+                 int* draw_calls, int* vertices )
+{
+    int count = (last_row - first_row + 1) * 2,
+        first = column * mesh->gridWidth * 2 + first_row * 2;
+
+    if( mesh->indexBuffer != 0 )
+        glDrawElements( GL_QUAD_STRIP, count, GL_UNSIGNED_INT,
+                        (const GLvoid*)(sizeof(GLuint) * first) );
+    else
+        glDrawElements( GL_QUAD_STRIP, count, GL_UNSIGNED_INT,
+                        &mesh->indices[first] );
+
+    (*draw_calls)++;
+    *vertices += count;
+}
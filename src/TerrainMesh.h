@@ -0,0 +1,100 @@
+#ifndef TERRAINMESH_H_
+#define TERRAINMESH_H_
+/**
+ * TerrainMesh.h
+ * The landscape, as vertex and index buffers OpenGL can draw from directly.
+ *
+ * The mesh is brought up to date once per frame, copying (and uploading, if
+ * there are buffer objects) only the rows of the landscape that have changed
+ * since. Every view then draws from the same buffers, skipping the chunks of
+ * the landscape outside its frustum.
+ *
+ * The landscape is drawn as one quad strip per column, as it always was; the
+ * chunks a strip passes through that are visible are drawn with one call.
+ *
+ * The parts of the strips hidden behind nearer hills can be skipped too,
+ * given a horizon for the view (see Horizon.h), a chunk's worth of a strip at
+ * a time. The mesh provides the horizon's occluders: small tiles, each solid
+ * up to its lowest point.
+ */
+
+#include "Landscape.h"
+#include "Horizon.h"
+#include "maths.h"
+#include <GL/gl.h>
+
+/*******************************************************************************
+ * TYPE DEFINITIONS
+ ******************************************************************************/
+typedef struct {
+    GLfloat position[3];
+    GLfloat normal[3];
+    GLfloat color[3];
+} TerrainVertex;
+
+typedef struct {
+    int gridWidth; // The width of the landscape, in points
+    int chunks; // The number of chunks along each side
+
+    // One vertex per point, row by row
+    TerrainVertex* vertices;
+    // Each column's quad strip, one after another
+    GLuint* indices;
+    // Buffer objects holding the above (0 without buffer objects)
+    GLuint vertexBuffer, indexBuffer;
+
+    // The bounds of each chunk, row of chunks by row of chunks
+    float (*chunkMin)[3];
+    float (*chunkMax)[3];
+    // Whether each chunk is visible to the view being drawn
+    unsigned char* chunkVisible;
+
+    // The number of occluder tiles along each side, and the lowest height in
+    // each, row of tiles by row of tiles
+    int tiles;
+    float* tileHeights;
+    // The highest point of each column's segment in each row of chunks (the
+    // pieces checked against a horizon), row of chunks by row of chunks
+    float* segmentHeights;
+
+    // The game and row versions the mesh was last brought up to date with
+    unsigned int generation;
+    unsigned int* rowVersions;
+    int empty; // True until the mesh is first filled
+} TerrainMesh;
+
+/*******************************************************************************
+ * CONSTRUCTORS/DESTRUCTORS
+ ******************************************************************************/
+/**
+ * Creates an empty terrain mesh. Requires a current OpenGL context.
+ */
+TerrainMesh* TerrainMesh_new();
+/**
+ * Deletes a terrain mesh, and its buffers.
+ */
+void TerrainMesh_delete( TerrainMesh* mesh );
+
+/*******************************************************************************
+ * TERRAIN MESH FUNCTIONS
+ ******************************************************************************/
+/**
+ * Brings the mesh up to date with the landscape of game `generation`.
+ */
+void TerrainMesh_update( TerrainMesh* mesh, Landscape* landscape,
+                         unsigned int generation );
+/**
+ * Adds the mesh's occluders that might hide anything inside `frustum` to a
+ * horizon being built.
+ */
+void TerrainMesh_addOccluders( TerrainMesh* mesh, Horizon* horizon,
+                               Frustum* frustum );
+/**
+ * Draws the parts of the mesh inside `frustum` and not hidden by `horizon`
+ * (which may be NULL), adding the draw calls and vertices submitted, and the
+ * strip segments the horizon hid, to the counts given.
+ */
+void TerrainMesh_draw( TerrainMesh* mesh, Frustum* frustum, Horizon* horizon,
+                       int* draw_calls, int* vertices, int* occluded );
+
+#endif /*TERRAINMESH_H_*/
@@ -0,0 +1,439 @@
+#include "TubeMesh.h"
+#include "glext.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <float.h>
+#include <math.h>
+
+/*******************************************************************************
+ * GLOBALS AND CONSTANTS
+ ******************************************************************************/
+// The vertices around each ring
+#define TUBE_SIDES 8
+// The indices joining one ring to the next (a quad per side)
+#define SEGMENT_INDICES (TUBE_SIDES * 4)
+
+// The fewest rings a mesh holds
+#define MIN_CAPACITY 256
+
+// The most a ring is widened at a corner, to keep the tube's thickness
+#define MAX_MITRE 1.5f
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+
+/*******************************************************************************
+ * INTERNAL FUNCTION PROTOTYPES
+ ******************************************************************************/
+void resize_tube( TubeMesh* mesh, int rings );
+void free_tube( TubeMesh* mesh );
+int joint_is_held( unsigned int joint, unsigned int oldest,
+                   unsigned int newest );
+void write_joint( TubeMesh* mesh, PlayerSnapshot* player, unsigned int joint,
+                  int upload );
+void write_ends( TubeMesh* mesh, PlayerSnapshot* player, int upload );
+void write_ring( TubeMesh* mesh, unsigned int ring, float position[3],
+                 float* older, float* newer, int upload );
+int direction( float from[3], float to[3], float result[3] );
+void find_bounds( TubeMesh* mesh, PlayerSnapshot* player );
+void extend_bounds( TubeMesh* mesh, float min[3], float max[3] );
+
+
+/*******************************************************************************
+ * CONSTRUCTORS/DESTRUCTORS
+ ******************************************************************************/
+TubeMesh* TubeMesh_new()
+{
+    TubeMesh* mesh = (TubeMesh*)calloc( 1, sizeof(TubeMesh) );
+
+    mesh->empty = 1;
+
+    return mesh;
+}
+
+void TubeMesh_delete( TubeMesh* mesh )
+{
+    if( mesh == NULL )
+        return;
+
+    free_tube(mesh);
+    free(mesh);
+}
+
+
+/*******************************************************************************
+ * TUBE MESH FUNCTIONS
+ ******************************************************************************/
+void TubeMesh_update( TubeMesh* mesh, PlayerSnapshot* player, float radius,
+                      unsigned int generation )
+{
+    unsigned int newest = player->bodySerial,
+                 oldest = newest - player->bodyLength + 1, joint;
+    int refill, i;
+
+    // Joints are only ever added at the head, so the head going backwards
+    // means a different body altogether; and they all move with the ground
+    refill = mesh->empty || mesh->generation != generation ||
+             mesh->radius != radius ||
+             mesh->groundVersion != player->groundVersion ||
+             (int)(newest - mesh->newestJoint) < 0;
+
+    // Leave room for the head and tail
+    if( player->bodyLength + 2 > mesh->capacity )
+    {
+        resize_tube( mesh, player->bodyLength + 2 );
+        refill = 1;
+    }
+
+    mesh->radius = radius;
+    if( mesh->vertexBuffer != 0 )
+        ext_glBindBuffer( GL_ARRAY_BUFFER, mesh->vertexBuffer );
+
+    if( refill )
+    {
+        for( i = 0; i < player->bodyLength; i++ )
+            write_joint( mesh, player, newest - i, 0 );
+        write_ends( mesh, player, 0 );
+
+        if( mesh->vertexBuffer != 0 )
+            ext_glBufferSubData( GL_ARRAY_BUFFER, 0,
+                sizeof(TubeVertex) * TUBE_SIDES * mesh->capacity,
+                mesh->vertices );
+    }
+    else
+    {
+        // The joints laid since the last update
+        joint = mesh->newestJoint + 1;
+        if( (int)(oldest - joint) > 0 )
+            joint = oldest;
+        for( ; (int)(newest - joint) >= 0; joint++ )
+            write_joint( mesh, player, joint, 1 );
+
+        // The last update's newest joint used to lead to the head, and now
+        // leads to a joint (its corner has only just been turned)
+        if( mesh->newestJoint != newest &&
+            joint_is_held( mesh->newestJoint, oldest, newest ) )
+            write_joint( mesh, player, mesh->newestJoint, 1 );
+
+        // The joints at either end lead to the moving head and tail
+        if( player->bodyLength > 0 )
+        {
+            write_joint( mesh, player, newest, 1 );
+            write_joint( mesh, player, oldest, 1 );
+        }
+        write_ends( mesh, player, 1 );
+    }
+
+    if( mesh->vertexBuffer != 0 )
+        ext_glBindBuffer( GL_ARRAY_BUFFER, 0 );
+
+    find_bounds( mesh, player );
+
+    // Joints dropped off the tail are left where they are, to be written over
+    mesh->oldestJoint = oldest;
+    mesh->newestJoint = newest;
+    mesh->joints = player->bodyLength;
+    mesh->generation = generation;
+    mesh->groundVersion = player->groundVersion;
+    mesh->empty = 0;
+}
+
+void TubeMesh_draw( TubeMesh* mesh, Frustum* frustum,
+                    int* draw_calls, int* vertices )
+{
+    const char* base;
+    int first, count;
+
+    if( mesh->empty ||
+        !frustum_contains_box( frustum, mesh->min, mesh->max ) )
+        return;
+
+    // With buffer objects, pointers are offsets into the buffers
+    if( mesh->vertexBuffer != 0 )
+    {
+        ext_glBindBuffer( GL_ARRAY_BUFFER, mesh->vertexBuffer );
+        ext_glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, mesh->indexBuffer );
+        base = NULL;
+    }
+    else
+    {
+        base = (const char*)mesh->vertices;
+    }
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_NORMAL_ARRAY);
+    glVertexPointer( 3, GL_FLOAT, sizeof(TubeVertex),
+                     base + offsetof( TubeVertex, position ) );
+    glNormalPointer( GL_FLOAT, sizeof(TubeVertex),
+                     base + offsetof( TubeVertex, normal ) );
+
+    // From the tail's ring, through every joint's, to the head's
+    first = ((mesh->oldestJoint - 1) & (mesh->capacity - 1)) *
+            SEGMENT_INDICES;
+    count = (mesh->joints + 1) * SEGMENT_INDICES;
+    if( mesh->indexBuffer != 0 )
+        glDrawElements( GL_QUADS, count, GL_UNSIGNED_INT,
+                        (const GLvoid*)(sizeof(GLuint) * first) );
+    else
+        glDrawElements( GL_QUADS, count, GL_UNSIGNED_INT,
+                        &mesh->indices[first] );
+
+    (*draw_calls)++;
+    *vertices += count;
+
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glDisableClientState(GL_NORMAL_ARRAY);
+
+    // Leave no buffers bound, or other modules' vertex arrays would be taken
+    // as offsets into them
+    if( mesh->vertexBuffer != 0 )
+    {
+        ext_glBindBuffer( GL_ARRAY_BUFFER, 0 );
+        ext_glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, 0 );
+    }
+}
+
+
+/*******************************************************************************
+ * INTERNAL FUNCTIONS
+ ******************************************************************************/
+/**
+ * Reallocates the mesh to hold at least `rings` rings, leaving it empty.
+ */
+void resize_tube( TubeMesh* mesh, int rings )
+{
+    int capacity, segment, side, ring, next;
+    GLuint* index;
+
+    // Leave room to grow
+    for( capacity = MIN_CAPACITY; capacity < rings * 2; capacity *= 2 )
+        ;
+
+    free_tube(mesh);
+
+    mesh->capacity = capacity;
+    mesh->empty = 1;
+
+    mesh->vertices = (TubeVertex*)calloc( capacity * TUBE_SIDES,
+                                          sizeof(TubeVertex) );
+    mesh->indices = (GLuint*)malloc( sizeof(GLuint) * 2 * capacity *
+                                     SEGMENT_INDICES );
+
+    // Each segment joins a ring to the one in the next slot, wrapping around
+    index = mesh->indices;
+    for( segment = 0; segment < 2 * capacity; segment++ )
+    {
+        ring = (segment & (capacity - 1)) * TUBE_SIDES;
+        next = ((segment + 1) & (capacity - 1)) * TUBE_SIDES;
+        for( side = 0; side < TUBE_SIDES; side++ )
+        {
+            *index++ = ring + side;
+            *index++ = next + side;
+            *index++ = next + (side + 1) % TUBE_SIDES;
+            *index++ = ring + (side + 1) % TUBE_SIDES;
+        }
+    }
+
+    if( glext_has_buffers() )
+    {
+        ext_glGenBuffers( 1, &mesh->vertexBuffer );
+        ext_glBindBuffer( GL_ARRAY_BUFFER, mesh->vertexBuffer );
+        ext_glBufferData( GL_ARRAY_BUFFER,
+                          sizeof(TubeVertex) * TUBE_SIDES * capacity,
+                          NULL, GL_DYNAMIC_DRAW );
+        ext_glBindBuffer( GL_ARRAY_BUFFER, 0 );
+
+        ext_glGenBuffers( 1, &mesh->indexBuffer );
+        ext_glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, mesh->indexBuffer );
+        ext_glBufferData( GL_ELEMENT_ARRAY_BUFFER,
+                          sizeof(GLuint) * 2 * capacity * SEGMENT_INDICES,
+                          mesh->indices, GL_STATIC_DRAW );
+        ext_glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, 0 );
+    }
+}
+
+void free_tube( TubeMesh* mesh )
+{
+    if( mesh->vertexBuffer != 0 )
+    {
+        ext_glDeleteBuffers( 1, &mesh->vertexBuffer );
+        ext_glDeleteBuffers( 1, &mesh->indexBuffer );
+    }
+    mesh->vertexBuffer = mesh->indexBuffer = 0;
+
+    free( mesh->vertices );
+    free( mesh->indices );
+    mesh->vertices = NULL;
+    mesh->indices = NULL;
+    mesh->capacity = 0;
+}
+
+/**
+ * Returns true if `joint` is one of the joints from `oldest` to `newest`.
+ */
+int joint_is_held( unsigned int joint, unsigned int oldest,
+                   unsigned int newest )
+{
+    return (int)(joint - oldest) >= 0 && (int)(newest - joint) >= 0;
+}
+
+/**
+ * Writes the ring of one of the player's joints, by number.
+ */
+void write_joint( TubeMesh* mesh, PlayerSnapshot* player, unsigned int joint,
+                  int upload )
+{
+    int i = player->bodySerial - joint;
+
+    write_ring( mesh, joint, player->body[i],
+                i == player->bodyLength - 1 ? player->tailPosition :
+                                              player->body[i + 1],
+                i == 0 ? player->headPosition : player->body[i - 1],
+                upload );
+}
+
+/**
+ * Writes the rings of the head and tail, either side of the joints.
+ */
+void write_ends( TubeMesh* mesh, PlayerSnapshot* player, int upload )
+{
+    int last = player->bodyLength - 1;
+    unsigned int newest = player->bodySerial;
+
+    write_ring( mesh, newest + 1, player->headPosition,
+                last < 0 ? player->tailPosition : player->body[0], NULL,
+                upload );
+    write_ring( mesh, newest - last - 1, player->tailPosition, NULL,
+                last < 0 ? player->headPosition : player->body[last],
+                upload );
+}
+
+/**
+ * Writes a ring around `position`, square to the tube as it comes from
+ * `older` and goes on to `newer` (either of which may be NULL), in the slot
+ * for ring number `ring`. Uploads it if `upload` is set.
+ */
+void write_ring( TubeMesh* mesh, unsigned int ring, float position[3],
+                 float* older, float* newer, int upload )
+{
+    float in[3], out[3], along[3], side[3], up[3], vertical[3] = { 0, 1, 0 };
+    float mitre = 1.0f, angle, c, s;
+    int has_in, has_out, slot = ring & (mesh->capacity - 1), i, k;
+    TubeVertex* vertex = &mesh->vertices[slot * TUBE_SIDES];
+
+    has_in = older != NULL && direction( older, position, in );
+    has_out = newer != NULL && direction( position, newer, out );
+
+    // At a corner, the ring lies halfway between the two segments, and is
+    // widened across the corner so the tube doesn't pinch
+    if( has_in && has_out )
+    {
+        addVector( in, out, along );
+        // Doubling back
+        if( along[0] == 0.0f && along[1] == 0.0f && along[2] == 0.0f )
+            memcpy( along, in, sizeof(along) );
+        else
+            normaliseVector(along);
+        mitre = 1.0f / dot( along, in );
+        if( mitre > MAX_MITRE )
+            mitre = MAX_MITRE;
+    }
+    else if( has_in )
+        memcpy( along, in, sizeof(along) );
+    else if( has_out )
+        memcpy( along, out, sizeof(along) );
+    else
+    {
+        along[0] = 1.0f;
+        along[1] = along[2] = 0.0f;
+    }
+
+    cross_product( along, vertical, &side );
+    if( side[0] == 0.0f && side[1] == 0.0f && side[2] == 0.0f )
+    {
+        side[0] = 1.0f;
+        side[1] = side[2] = 0.0f;
+    }
+    normaliseVector(side);
+    cross_product( side, along, &up );
+
+    for( i = 0; i < TUBE_SIDES; i++, vertex++ )
+    {
+        angle = 2.0f * M_PI * i / TUBE_SIDES;
+        c = cosf(angle);
+        s = sinf(angle);
+        for( k = 0; k < 3; k++ )
+        {
+            vertex->normal[k] = c * side[k] + s * up[k];
+            vertex->position[k] = position[k] +
+                mesh->radius * (c * mitre * side[k] + s * up[k]);
+        }
+    }
+
+    if( upload && mesh->vertexBuffer != 0 )
+        ext_glBufferSubData( GL_ARRAY_BUFFER,
+                             sizeof(TubeVertex) * TUBE_SIDES * slot,
+                             sizeof(TubeVertex) * TUBE_SIDES,
+                             &mesh->vertices[slot * TUBE_SIDES] );
+}
+
+/**
+ * Finds the direction from one point to another. Returns false if they're
+ * the same point.
+ */
+int direction( float from[3], float to[3], float result[3] )
+{
+    result[0] = to[0] - from[0];
+    result[1] = to[1] - from[1];
+    result[2] = to[2] - from[2];
+
+    if( result[0] == 0.0f && result[1] == 0.0f && result[2] == 0.0f )
+        return 0;
+
+    normaliseVector(result);
+    return 1;
+}
+
+/**
+ * Finds the bounds of the tube from the bounds of the body's runs, so they
+ * follow the body around rather than holding everywhere it's been.
+ */
+void find_bounds( TubeMesh* mesh, PlayerSnapshot* player )
+{
+    // No ring reaches further from its centre than this
+    float reach = mesh->radius * MAX_MITRE;
+    int i;
+
+    for( i = 0; i < 3; i++ )
+    {
+        mesh->min[i] = FLT_MAX;
+        mesh->max[i] = -FLT_MAX;
+    }
+
+    for( i = 0; i < player->runCount; i++ )
+        extend_bounds( mesh, player->runs[i].min, player->runs[i].max );
+    extend_bounds( mesh, player->headPosition, player->headPosition );
+    extend_bounds( mesh, player->tailPosition, player->tailPosition );
+
+    for( i = 0; i < 3; i++ )
+    {
+        mesh->min[i] -= reach;
+        mesh->max[i] += reach;
+    }
+}
+
+void extend_bounds( TubeMesh* mesh, float min[3], float max[3] )
+{
+    int i;
+
+    for( i = 0; i < 3; i++ )
+    {
+        if( min[i] < mesh->min[i] )
+            mesh->min[i] = min[i];
+        if( max[i] > mesh->max[i] )
+            mesh->max[i] = max[i];
+    }
+}
@@ -0,0 +1,83 @@
+#ifndef TUBEMESH_H_
+#define TUBEMESH_H_
+/**
+ * TubeMesh.h
+ * A player's body, as a tube swept through its joints from tail to head.
+ *
+ * Each joint, and the head and tail, is a ring of vertices in a ring buffer,
+ * at the slot given by the joint's number. Joints only move when the ground
+ * under them does, so as a player moves only the rings of the joints laid
+ * since the last frame, and of the few joints next to the (moving) head and
+ * tail, are written and uploaded; joints dropped off the tail are forgotten
+ * just by moving the start of the tube along. The whole tube is drawn with
+ * one call.
+ */
+
+#include "snapshot.h"
+#include "maths.h"
+#include <GL/gl.h>
+
+/*******************************************************************************
+ * TYPE DEFINITIONS
+ ******************************************************************************/
+typedef struct {
+    GLfloat position[3];
+    GLfloat normal[3];
+} TubeVertex;
+
+typedef struct {
+    int capacity; // The number of rings the store holds (a power of two)
+    float radius;
+
+    // `capacity` rings of vertices, one ring per slot
+    TubeVertex* vertices;
+    // Quads joining each ring to the next, through the slots twice over, so
+    // that any run of rings is a contiguous range of indices
+    GLuint* indices;
+    // Buffer objects holding the above (0 without buffer objects)
+    GLuint vertexBuffer, indexBuffer;
+
+    // The numbers of the oldest and newest joints in the tube; the tail's
+    // ring is in the slot before the oldest's, and the head's after the
+    // newest's
+    unsigned int oldestJoint, newestJoint;
+    int joints;
+
+    // Bounds holding the whole tube, from the bounds of the body's runs
+    float min[3], max[3];
+
+    // The game, and the landscape's version, the mesh was last brought up to
+    // date with
+    unsigned int generation, groundVersion;
+    int empty; // True until the mesh is first filled
+} TubeMesh;
+
+/*******************************************************************************
+ * CONSTRUCTORS/DESTRUCTORS
+ ******************************************************************************/
+/**
+ * Creates an empty tube mesh. Requires a current OpenGL context.
+ */
+TubeMesh* TubeMesh_new();
+/**
+ * Deletes a tube mesh, and its buffers.
+ */
+void TubeMesh_delete( TubeMesh* mesh );
+
+/*******************************************************************************
+ * TUBE MESH FUNCTIONS
+ ******************************************************************************/
+/**
+ * Brings the mesh up to date with a player of game `generation`, as a tube of
+ * the given radius.
+ */
+void TubeMesh_update( TubeMesh* mesh, PlayerSnapshot* player, float radius,
+                      unsigned int generation );
+/**
+ * Draws the tube, in the current colour, if it's inside `frustum`, adding the
+ * draw calls and vertices submitted to the counts given.
+ */
+void TubeMesh_draw( TubeMesh* mesh, Frustum* frustum,
+                    int* draw_calls, int* vertices );
+
+#endif /*TUBEMESH_H_*/
@@ -70,3 +70,40 @@ void Viewport_apply( Viewport* viewport )
 }
 
 
+
+void Viewport_getFrustum( Frustum* frustum )
+{
+    GLfloat projection[16], modelview[16], clip[16];
+    int row, column, k, i;
+    
+    glGetFloatv( GL_PROJECTION_MATRIX, projection );
+    glGetFloatv( GL_MODELVIEW_MATRIX, modelview );
+    
+    // clip = projection * modelview (both column major)
+    for( column = 0; column < 4; column++ )
+    {
+        for( row = 0; row < 4; row++ )
+        {
+            clip[column * 4 + row] = 0.0f;
+            for( k = 0; k < 4; k++ )
+            {
+                clip[column * 4 + row] += projection[k * 4 + row] *
+                                          modelview[column * 4 + k];
+            }
+        }
+    }
+    
+    /* A point is inside if -w <= x, y, z <= w in clip space, so each plane is
+     * the last row of the matrix plus or minus one of the others (left,
+     * right, bottom, top, near, far). */
+    for( i = 0; i < 6; i++ )
+    {
+        row = i / 2;
+        for( k = 0; k < 4; k++ )
+        {
+            frustum->planes[i][k] = clip[k * 4 + 3] +
+                                    (i % 2 == 0 ? 1.0f : -1.0f) *
+                                    clip[k * 4 + row];
+        }
+    }
+}
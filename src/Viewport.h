@@ -2,6 +2,7 @@
 #define VIEWPORT_H_
 
 #include "Camera.h"
+#include "maths.h"
 
 /*******************************************************************************
  * TYPE DEFINITIONS
@@ -31,4 +32,10 @@ void Viewport_delete( Viewport* viewport );
  */
 void Viewport_apply( Viewport* viewport );
 
+/**
+ * Finds the frustum of the viewport last applied, from the current OpenGL
+ * matrices.
+ */
+void Viewport_getFrustum( Frustum* frustum );
+
 #endif /*VIEWPORT_H_*/
@@ -0,0 +1,342 @@
+#include "batch.h"
+#include "Bot.h"
+#include "replay.h"
+#include "eventlog.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+/*******************************************************************************
+ * GLOBALS AND CONSTANTS
+ ******************************************************************************/
+// Ticks per second, unless told otherwise
+#define DEFAULT_TICK_RATE 60
+// The longest a match may go before it's stopped, unless told otherwise
+// (ten minutes at 60 ticks per second)
+#define DEFAULT_MAX_TICKS 36000
+
+// The longest line in a script
+#define SCRIPT_LINE_LENGTH 256
+
+// The actions' names, in the order of Action
+static const char* action_names[] = { "left", "right", "fire", "grow" };
+#define ACTIONS 4
+
+
+/*******************************************************************************
+ * TYPE DEFINITIONS
+ ******************************************************************************/
+/**
+ * A batch being played, shared by the threads playing it.
+ */
+typedef struct {
+    MatchSpec* spec;
+    MatchResult* results;
+    atomic_int next; // The next match to be played
+} Batch;
+
+
+/*******************************************************************************
+ * INTERNAL FUNCTION PROTOTYPES
+ ******************************************************************************/
+void play_match( MatchSpec* spec, unsigned int seed, MatchResult* result,
+                 FILE* record );
+void* play_matches( void* batch );
+void run_script( GameState* gamestate, MatchSpec* spec, int* next, int tick,
+                 FILE* record );
+void act( GameState* gamestate, int tick, int player_id, Action action,
+          FILE* record );
+
+
+/*******************************************************************************
+ * BATCH FUNCTIONS
+ ******************************************************************************/
+void batch_default_spec( MatchSpec* spec )
+{
+    int i;
+
+    spec->first_seed = 1;
+    spec->matches = 1;
+    for( i = 0; i < BATCH_MAX_PLAYERS; i++ )
+        spec->controllers[i] = CONTROLLER_BOT;
+    spec->script = NULL;
+    spec->script_length = 0;
+    rules_default( &spec->rules );
+    spec->tick_rate = DEFAULT_TICK_RATE;
+    spec->max_ticks = DEFAULT_MAX_TICKS;
+    spec->verbose = 0;
+}
+
+void batch_play_match( MatchSpec* spec, unsigned int seed,
+                       MatchResult* result )
+{
+    play_match( spec, seed, result, NULL );
+}
+
+int batch_record_match( MatchSpec* spec, unsigned int seed, char* path,
+                        MatchResult* result )
+{
+    FILE* record = fopen( path, "w" );
+
+    if( record == NULL )
+    {
+        fprintf( stderr, "Could not write the replay to %s\n", path );
+        return 0;
+    }
+
+    replay_write_header( record, spec, seed );
+    play_match( spec, seed, result, record );
+    fclose(record);
+
+    return 1;
+}
+
+void batch_run( MatchSpec* spec, int threads, MatchResult* results )
+{
+    Batch batch;
+    pthread_t* workers;
+    int started, i;
+
+    batch.spec = spec;
+    batch.results = results;
+    atomic_init( &batch.next, 0 );
+
+    // The calling thread plays too, so start one fewer
+    workers = (pthread_t*)malloc( sizeof(pthread_t) *
+                                  (threads > 1 ? threads - 1 : 1) );
+    for( started = 0; started < threads - 1; started++ )
+    {
+        if( pthread_create( &workers[started], NULL, play_matches,
+                            &batch ) != 0 )
+        {
+            fprintf( stderr, "Could only start %d of %d threads\n",
+                     started + 1, threads );
+            break;
+        }
+    }
+
+    play_matches(&batch);
+
+    for( i = 0; i < started; i++ )
+        pthread_join( workers[i], NULL );
+    free(workers);
+}
+
+ScriptEvent* batch_read_script( char* path, int* length )
+{
+    FILE* file = fopen( path, "r" );
+    ScriptEvent* script = NULL;
+    char line[SCRIPT_LINE_LENGTH], action[SCRIPT_LINE_LENGTH];
+    int capacity = 0, line_number = 0, last_tick = 0;
+    ScriptEvent event;
+
+    if( file == NULL )
+    {
+        fprintf( stderr, "Could not read the script %s\n", path );
+        return NULL;
+    }
+
+    *length = 0;
+    while( fgets( line, sizeof(line), file ) != NULL )
+    {
+        line_number++;
+        if( line[strspn( line, " \t\r\n" )] == '\0' ||
+            line[strspn( line, " \t" )] == '#' )
+            continue;
+
+        if( sscanf( line, "%d %d %s", &event.tick, &event.player_id,
+                    action ) != 3 ||
+            event.tick < last_tick ||
+            event.player_id < 1 || event.player_id > BATCH_MAX_PLAYERS )
+        {
+            fprintf( stderr, "%s:%d: expected a tick (in order), a player "
+                             "and an action\n", path, line_number );
+            break;
+        }
+
+        if( !batch_parse_action( action, &event.action ) )
+        {
+            fprintf( stderr, "%s:%d: unknown action %s\n", path, line_number,
+                     action );
+            break;
+        }
+
+        if( *length == capacity )
+        {
+            capacity = capacity > 0 ? capacity * 2 : 64;
+            script = (ScriptEvent*)realloc( script,
+                                            sizeof(ScriptEvent) * capacity );
+        }
+        script[(*length)++] = event;
+        last_tick = event.tick;
+    }
+
+    // Stopping early means something was wrong
+    if( !feof(file) )
+    {
+        free(script);
+        script = NULL;
+    }
+    else if( script == NULL )
+    {
+        // An empty script is fine; the players just go straight
+        script = (ScriptEvent*)malloc( sizeof(ScriptEvent) );
+    }
+    fclose(file);
+
+    return script;
+}
+
+
+const char* batch_action_name( Action action )
+{
+    return action >= 0 && action < ACTIONS ? action_names[action] : "?";
+}
+
+int batch_parse_action( const char* name, Action* action )
+{
+    int i;
+
+    for( i = 0; i < ACTIONS; i++ )
+    {
+        if( strcmp( name, action_names[i] ) == 0 )
+        {
+            *action = (Action)i;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+
+/*******************************************************************************
+ * INTERNAL FUNCTIONS
+ ******************************************************************************/
+/**
+ * Plays a match, and records it as a replay if `record` isn't NULL.
+ */
+void play_match( MatchSpec* spec, unsigned int seed, MatchResult* result,
+                 FILE* record )
+{
+    GameState* gamestate = GameState_new(seed);
+    StateHasher* hasher = StateHasher_new();
+    StateHash hash;
+    EventSubscription* log = NULL;
+    Bot* bots[BATCH_MAX_PLAYERS] = { NULL };
+    Action actions[BOT_ACTIONS];
+    float delta = 1000.0f / spec->tick_rate;
+    int tick, next_event = 0, players, count, i, j;
+
+    // Only verbose matches follow their events, so the rest publish to nobody
+    if( spec->verbose )
+        log = EventBus_subscribe( gamestate->events );
+    gamestate->rules = spec->rules;
+    new_game(gamestate);
+
+    players = gamestate->playerCount < BATCH_MAX_PLAYERS ?
+              gamestate->playerCount : BATCH_MAX_PLAYERS;
+    for( i = 0; i < players; i++ )
+    {
+        // The bots' numbers follow from the seed too
+        if( spec->controllers[i] == CONTROLLER_BOT )
+            bots[i] = Bot_new( i + 1, seed * players + i + 1 );
+    }
+
+    for( tick = 0; tick < spec->max_ticks &&
+                   gamestate->mode != MODE_FINISHED; tick++ )
+    {
+        // The script acts first, then the bots, in order of player, so that
+        // actions are always performed in the same order
+        run_script( gamestate, spec, &next_event, tick, record );
+        for( i = 0; i < players; i++ )
+        {
+            if( bots[i] == NULL )
+                continue;
+
+            count = Bot_play( bots[i], gamestate, actions );
+            for( j = 0; j < count; j++ )
+                act( gamestate, tick, i + 1, actions[j], record );
+        }
+
+        update_world( gamestate, delta );
+        if( record != NULL )
+        {
+            StateHasher_hash( hasher, gamestate, &hash );
+            replay_write_hash( record, tick, &hash );
+        }
+        // Between ticks, so that printing doesn't hold up the world
+        if( log != NULL )
+            eventlog_drain( log, stdout );
+    }
+
+    result->seed = seed;
+    result->finished = gamestate->mode == MODE_FINISHED;
+    result->winner = result->finished ? gamestate->winner : 0;
+    result->players = players;
+    for( i = 0; i < players; i++ )
+    {
+        result->scores[i] = gamestate->players[i]->score;
+        result->lengths[i] = gamestate->players[i]->length /
+                             gamestate->landscape->gridDivisionWidth;
+    }
+    result->ticks = tick;
+    result->deformations = gamestate->deformations;
+    StateHasher_hash( hasher, gamestate, &hash );
+    result->hash = hash.total;
+
+    for( i = 0; i < players; i++ )
+        Bot_delete(bots[i]);
+    StateHasher_delete(hasher);
+    GameState_delete(gamestate);
+}
+
+/**
+ * Plays the batch's matches until there are none left. Run on each thread.
+ */
+void* play_matches( void* batch )
+{
+    Batch* playing = (Batch*)batch;
+    int match;
+
+    while( (match = atomic_fetch_add( &playing->next, 1 )) <
+           playing->spec->matches )
+    {
+        batch_play_match( playing->spec, playing->spec->first_seed + match,
+                          &playing->results[match] );
+    }
+
+    return NULL;
+}
+
+/**
+ * Carries out the script's events for this tick, for the players it controls.
+ * `next` is the first event not yet carried out.
+ */
+void run_script( GameState* gamestate, MatchSpec* spec, int* next, int tick,
+                 FILE* record )
+{
+    ScriptEvent* event;
+
+    for( ; *next < spec->script_length &&
+           spec->script[*next].tick <= tick; (*next)++ )
+    {
+        event = &spec->script[*next];
+        if( event->player_id <= gamestate->playerCount &&
+            spec->controllers[event->player_id - 1] == CONTROLLER_SCRIPT )
+            act( gamestate, tick, event->player_id, event->action, record );
+    }
+}
+
+/**
+ * Has a player perform an action, and records it if `record` isn't NULL.
+ */
+void act( GameState* gamestate, int tick, int player_id, Action action,
+          FILE* record )
+{
+    perform_action( gamestate, player_id, action );
+    if( record != NULL )
+        replay_write_action( record, tick, player_id, action );
+}
@@ -0,0 +1,126 @@
+#ifndef BATCH_H_
+#define BATCH_H_
+/**
+ * batch.h
+ * This module plays batches of matches, spread across a pool of threads.
+ *
+ * A batch is described by a MatchSpec: the seeds to play (one match for each),
+ * who controls each player, and the rules to play by. Every match is played on
+ * a gamestate of its own, made from its seed, so its result depends only on
+ * the seed and the spec, and not on which thread played it or when. Threads
+ * take the next match to play from a shared counter, so a long match only
+ * holds up the thread playing it.
+ *
+ * Scripted players follow a list of commands, each given as the tick of the
+ * match it comes at, the player (counting from 1) and what they do. Scripts are read
+ * from files with one command per line, in order of tick:
+ *
+ *     # tick player action
+ *     120 1 left
+ *     120 2 fire
+ *     300 2 right
+ *     600 1 grow
+ */
+
+#include "mechanics.h"
+
+// The most players a batch's matches may have
+#define BATCH_MAX_PLAYERS 16
+
+/*******************************************************************************
+ * TYPE DEFINITIONS
+ ******************************************************************************/
+/**
+ * Who controls a player.
+ */
+typedef enum {
+    CONTROLLER_BOT, // A bot (see Bot.h)
+    CONTROLLER_SCRIPT, // The spec's script
+    CONTROLLER_IDLE // No one; the player goes straight on
+} Controller;
+
+/**
+ * Something the script does to a player at `tick`.
+ */
+typedef struct {
+    int tick;
+    int player_id;
+    Action action;
+} ScriptEvent;
+
+/**
+ * The matches to play, and how.
+ */
+typedef struct {
+    // Matches are played with seeds first_seed, first_seed + 1, ...
+    unsigned int first_seed;
+    int matches;
+    // Who controls each player, for as many players as the rules say (up to
+    // BATCH_MAX_PLAYERS)
+    Controller controllers[BATCH_MAX_PLAYERS];
+    // The commands for scripted players, in order of tick
+    ScriptEvent* script;
+    int script_length;
+    Rules rules;
+    int tick_rate; // Ticks per second of game time
+    int max_ticks; // Matches still going after this many ticks are stopped
+    int verbose; // Print what happens in each match
+} MatchSpec;
+
+/**
+ * How a match went.
+ */
+typedef struct {
+    unsigned int seed;
+    int finished; // False if the match was stopped at the most ticks
+    int winner; // The winning player (counting from 1), or 0 for none
+    int players;
+    int scores[BATCH_MAX_PLAYERS];
+    float lengths[BATCH_MAX_PLAYERS]; // In grid divisions
+    int ticks;
+    unsigned int deformations; // Craters made in the landscape
+    unsigned long long hash; // The final state's hash (see StateHasher.h)
+} MatchResult;
+
+/*******************************************************************************
+ * BATCH FUNCTIONS
+ ******************************************************************************/
+/**
+ * Sets up a spec for a match between bots, by the default rules (so two of
+ * them).
+ */
+void batch_default_spec( MatchSpec* spec );
+/**
+ * Plays the spec's match with the given seed.
+ */
+void batch_play_match( MatchSpec* spec, unsigned int seed,
+                       MatchResult* result );
+/**
+ * Plays the spec's match with the given seed, as batch_play_match does, and
+ * records it to `path` as a replay (see replay.h).
+ *
+ * Returns false if the replay couldn't be written.
+ */
+int batch_record_match( MatchSpec* spec, unsigned int seed, char* path,
+                        MatchResult* result );
+/**
+ * Plays all of the spec's matches on `threads` threads (counting the calling
+ * one), and fills in `results`, in order of seed. Returns once they're all
+ * played.
+ */
+void batch_run( MatchSpec* spec, int threads, MatchResult* results );
+/**
+ * Reads a script (see above), and returns its events, or NULL if it couldn't
+ * be read.
+ */
+ScriptEvent* batch_read_script( char* path, int* length );
+/**
+ * Returns the name of an action in scripts and replays, e.g. "left".
+ */
+const char* batch_action_name( Action action );
+/**
+ * Reads the name of an action. Returns false if there's no such action.
+ */
+int batch_parse_action( const char* name, Action* action );
+
+#endif /*BATCH_H_*/
@@ -0,0 +1,552 @@
+#include "benchmark.h"
+#include "mechanics.h"
+#include "simulation.h"
+#include "render.h"
+#include "Camera.h"
+#include "profile.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <GL/gl.h>
+
+/*******************************************************************************
+ * TYPE DEFINITIONS
+ ******************************************************************************/
+typedef enum {
+    SCRIPT_TURN_LEFT, SCRIPT_TURN_RIGHT, SCRIPT_FIRE, SCRIPT_GROW
+} ScriptAction;
+
+/**
+ * Something the script does to a player, at `frame`, and then every `every`
+ * frames after that (or only once, if `every` is zero).
+ */
+typedef struct {
+    int frame;
+    int every;
+    int player_id;
+    ScriptAction action;
+} ScriptEvent;
+
+/**
+ * A point on the camera path. Positions are fractions of the way across the
+ * world from its south west corner, and heights are multiples of the
+ * landscape's maximum height.
+ */
+typedef struct {
+    float time; // Fraction of the way through the run
+    float x, z, height; // Where the camera is
+    float target_x, target_z; // Where it's looking (at ground level)
+} CameraKeyframe;
+
+/**
+ * Measurements for a single frame.
+ */
+typedef struct {
+    double wall_ms; // Elapsed time
+    double cpu_ms; // CPU time used by the game's thread
+    double process_cpu_ms; // CPU time used by the whole process
+    int draw_calls;
+    int vertices;
+    int occluded; // Chunks and objects hidden behind hills
+} FrameSample;
+
+/*******************************************************************************
+ * GLOBALS AND CONSTANTS
+ ******************************************************************************/
+// The simulated time between frames, in milliseconds
+#define BENCHMARK_FRAME_TIME 16
+
+#define DEFAULT_BENCHMARK_FRAMES 1200
+#define DEFAULT_BENCHMARK_SEED 1
+#define DEFAULT_BENCHMARK_RESULTS "benchmark.json"
+
+// Growth events lengthen a player by this many grid divisions
+#define SCRIPT_GROWTH 12.0f
+
+/* The countdown takes 188 frames, and players cover a grid division every 3.2
+ * frames. Once they're 35 divisions in, the players turn and circle in squares
+ * 32 divisions across, on opposite sides of the map, firing as they go. Their
+ * squares are long enough that they don't run into their own tails, even after
+ * growing. */
+const ScriptEvent benchmark_script[] = {
+    { 300, 100, 1, SCRIPT_TURN_RIGHT },
+    { 300, 100, 2, SCRIPT_TURN_LEFT },
+    { 300, 150, 1, SCRIPT_FIRE },
+    { 375, 150, 2, SCRIPT_FIRE },
+    { 400, 0, 1, SCRIPT_GROW },
+    { 500, 0, 2, SCRIPT_GROW },
+    { 600, 0, 1, SCRIPT_GROW },
+    { 700, 0, 2, SCRIPT_GROW }
+};
+#define SCRIPT_LENGTH (sizeof(benchmark_script) / sizeof(ScriptEvent))
+
+/* Player 1's camera starts high over the southern edge, sweeps low over the
+ * middle of the map, circles round the north, and comes back. */
+const CameraKeyframe camera_path[] = {
+    { 0.00f, 0.50f, 0.00f, 4.0f, 0.50f, 0.50f },
+    { 0.20f, 0.20f, 0.30f, 1.5f, 0.60f, 0.60f },
+    { 0.40f, 0.50f, 0.50f, 1.2f, 0.90f, 0.90f },
+    { 0.60f, 0.80f, 0.80f, 2.0f, 0.20f, 0.80f },
+    { 0.80f, 0.20f, 0.90f, 1.5f, 0.50f, 0.10f },
+    { 1.00f, 0.50f, 0.00f, 4.0f, 0.50f, 0.50f }
+};
+#define CAMERA_KEYFRAMES (sizeof(camera_path) / sizeof(CameraKeyframe))
+
+Camera benchmark_camera;
+
+
+/*******************************************************************************
+ * INTERNAL FUNCTION PROTOTYPES
+ ******************************************************************************/
+void run_script( int frame );
+void follow_camera_path( int frame, int frames );
+double clock_ms( clockid_t clock );
+int should_dump( BenchmarkOptions* options, int frame );
+int dump_frame( BenchmarkOptions* options, int frame, FILE* results,
+                int* first );
+unsigned char* read_frame( int width, int height );
+int write_ppm( char* path, unsigned char* pixels, int width, int height );
+unsigned char* read_ppm( char* path, int width, int height );
+int compare_double( const void* a, const void* b );
+void write_statistics( FILE* results, char* name, double* values, int count );
+
+
+/*******************************************************************************
+ * PUBLIC FUNCTIONS
+ ******************************************************************************/
+void benchmark_default_options( BenchmarkOptions* options )
+{
+    memset( options, 0, sizeof(BenchmarkOptions) );
+    options->frames = DEFAULT_BENCHMARK_FRAMES;
+    options->seed = DEFAULT_BENCHMARK_SEED;
+    options->width = 800;
+    options->height = 600;
+    options->results_path = DEFAULT_BENCHMARK_RESULTS;
+}
+
+int benchmark_run( BenchmarkOptions* options )
+{
+    FrameSample* samples;
+    FrameSample* sample;
+    double *wall, *cpu, *process_cpu, *draw_calls, *vertices, *occluded;
+    double wall_start, cpu_start, process_start, total_wall = 0;
+    RenderStats* stats;
+    FILE* results;
+    int frame, i, mismatches = 0, first_image = 1;
+    long long frame_start;
+
+    results = options->results_path == NULL ?
+              stdout : fopen( options->results_path, "w" );
+    if( results == NULL )
+    {
+        perror( options->results_path );
+        return 0;
+    }
+
+    samples = (FrameSample*)calloc( options->frames, sizeof(FrameSample) );
+
+    // The same seed gives the same landscape and the same edibles
+    simulation_init( options->seed );
+    render_init(BACKEND_OFFSCREEN);
+    window_resized( options->width, options->height );
+    render_set_camera_override( 1, &benchmark_camera );
+    render_set_fixed_timing(1);
+
+    fprintf( results, "{\n" );
+    fprintf( results, "  \"seed\": %u,\n", options->seed );
+    fprintf( results, "  \"frames\": %d,\n", options->frames );
+    fprintf( results, "  \"width\": %d,\n", options->width );
+    fprintf( results, "  \"height\": %d,\n", options->height );
+    fprintf( results, "  \"frame_time_ms\": %d,\n", BENCHMARK_FRAME_TIME );
+    fprintf( results, "  \"images\": [" );
+
+    for( frame = 0; frame < options->frames; frame++ )
+    {
+        run_script(frame);
+        follow_camera_path( frame, options->frames );
+
+        wall_start = clock_ms(CLOCK_MONOTONIC);
+        cpu_start = clock_ms(CLOCK_THREAD_CPUTIME_ID);
+        process_start = clock_ms(CLOCK_PROCESS_CPUTIME_ID);
+
+        // The simulation runs on this thread, so that it's deterministic
+        frame_start = PROFILE_BEGIN();
+        simulation_step(BENCHMARK_FRAME_TIME);
+        render_update(BENCHMARK_FRAME_TIME);
+        render();
+        PROFILE_END( PROFILE_FRAME, frame_start );
+
+        sample = &samples[frame];
+        sample->wall_ms = clock_ms(CLOCK_MONOTONIC) - wall_start;
+        sample->cpu_ms = clock_ms(CLOCK_THREAD_CPUTIME_ID) - cpu_start;
+        sample->process_cpu_ms =
+            clock_ms(CLOCK_PROCESS_CPUTIME_ID) - process_start;
+        stats = render_get_stats();
+        sample->draw_calls = stats->draw_calls;
+        sample->vertices = stats->vertices;
+        sample->occluded = stats->occluded;
+        total_wall += sample->wall_ms;
+
+        if( should_dump( options, frame ) &&
+            !dump_frame( options, frame, results, &first_image ) )
+        {
+            mismatches++;
+        }
+    }
+
+    render_set_camera_override( 1, NULL );
+    render_set_fixed_timing(0);
+
+    fprintf( results, "\n  ],\n" );
+    fprintf( results, "  \"mismatched_images\": %d,\n", mismatches );
+    fprintf( results, "  \"total_wall_ms\": %.3f,\n", total_wall );
+    fprintf( results, "  \"frames_per_second\": %.3f,\n",
+             total_wall > 0 ? options->frames * 1000.0 / total_wall : 0.0 );
+
+    /* Summary statistics */
+    wall = (double*)malloc( sizeof(double) * options->frames );
+    cpu = (double*)malloc( sizeof(double) * options->frames );
+    process_cpu = (double*)malloc( sizeof(double) * options->frames );
+    draw_calls = (double*)malloc( sizeof(double) * options->frames );
+    vertices = (double*)malloc( sizeof(double) * options->frames );
+    occluded = (double*)malloc( sizeof(double) * options->frames );
+    for( i = 0; i < options->frames; i++ )
+    {
+        wall[i] = samples[i].wall_ms;
+        cpu[i] = samples[i].cpu_ms;
+        process_cpu[i] = samples[i].process_cpu_ms;
+        draw_calls[i] = samples[i].draw_calls;
+        vertices[i] = samples[i].vertices;
+        occluded[i] = samples[i].occluded;
+    }
+    write_statistics( results, "wall_ms", wall, options->frames );
+    write_statistics( results, "cpu_ms", cpu, options->frames );
+    write_statistics( results, "process_cpu_ms", process_cpu,
+                      options->frames );
+    write_statistics( results, "draw_calls", draw_calls, options->frames );
+    write_statistics( results, "vertices", vertices, options->frames );
+    write_statistics( results, "occluded", occluded, options->frames );
+    free(wall);
+    free(cpu);
+    free(process_cpu);
+    free(draw_calls);
+    free(vertices);
+    free(occluded);
+
+    /* Every frame */
+    fprintf( results, "  \"per_frame\": [\n" );
+    for( i = 0; i < options->frames; i++ )
+    {
+        fprintf( results, "    { \"wall_ms\": %.3f, \"cpu_ms\": %.3f, "
+                          "\"process_cpu_ms\": %.3f, \"draw_calls\": %d, "
+                          "\"vertices\": %d, \"occluded\": %d }%s\n",
+                 samples[i].wall_ms, samples[i].cpu_ms,
+                 samples[i].process_cpu_ms, samples[i].draw_calls,
+                 samples[i].vertices, samples[i].occluded,
+                 i + 1 < options->frames ? "," : "" );
+    }
+    fprintf( results, "  ]\n}\n" );
+
+    free(samples);
+    if( results != stdout )
+        fclose(results);
+
+    return mismatches == 0;
+}
+
+
+/*******************************************************************************
+ * INTERNAL FUNCTIONS
+ ******************************************************************************/
+/**
+ * Carries out any scripted events for this frame.
+ */
+void run_script( int frame )
+{
+    GameState* gamestate = simulation_gamestate();
+    const ScriptEvent* event;
+    unsigned int i;
+
+    for( i = 0; i < SCRIPT_LENGTH; i++ )
+    {
+        event = &benchmark_script[i];
+
+        if( frame < event->frame )
+            continue;
+        if( event->every == 0 ? frame != event->frame :
+                                (frame - event->frame) % event->every != 0 )
+            continue;
+
+        switch( event->action )
+        {
+        case SCRIPT_TURN_LEFT:
+            change_player_direction( gamestate, event->player_id, TURN_LEFT );
+            break;
+        case SCRIPT_TURN_RIGHT:
+            change_player_direction( gamestate, event->player_id, TURN_RIGHT );
+            break;
+        case SCRIPT_FIRE:
+            fire_player_weapon( gamestate, event->player_id );
+            break;
+        case SCRIPT_GROW:
+            grow_player( gamestate, event->player_id, SCRIPT_GROWTH );
+            break;
+        }
+    }
+}
+
+/**
+ * Moves the benchmark camera to where it should be at this frame.
+ */
+void follow_camera_path( int frame, int frames )
+{
+    Landscape* landscape = simulation_gamestate()->landscape;
+    const CameraKeyframe *from, *to;
+    float time = frames > 1 ? frame / (float)(frames - 1) : 0.0f,
+          t, x, z, height, target_x, target_z;
+    unsigned int i;
+
+    // Find the keyframes either side of this point in time
+    for( i = 1; i < CAMERA_KEYFRAMES - 1; i++ )
+    {
+        if( camera_path[i].time > time )
+            break;
+    }
+    from = &camera_path[i - 1];
+    to = &camera_path[i];
+    t = (time - from->time) / (to->time - from->time);
+
+    x = from->x + t * (to->x - from->x);
+    z = from->z + t * (to->z - from->z);
+    height = from->height + t * (to->height - from->height);
+    target_x = from->target_x + t * (to->target_x - from->target_x);
+    target_z = from->target_z + t * (to->target_z - from->target_z);
+
+    benchmark_camera.position[0] =
+        landscape->westBound + x * landscape->worldWidth;
+    benchmark_camera.position[1] = height * landscape->maxHeight;
+    benchmark_camera.position[2] =
+        landscape->southBound + z * landscape->worldDepth;
+
+    // Cameras store the point they look at as their forward vector
+    benchmark_camera.forward[0] =
+        landscape->westBound + target_x * landscape->worldWidth;
+    benchmark_camera.forward[1] = 0.0f;
+    benchmark_camera.forward[2] =
+        landscape->southBound + target_z * landscape->worldDepth;
+
+    benchmark_camera.up[0] = 0.0f;
+    benchmark_camera.up[1] = 1.0f;
+    benchmark_camera.up[2] = 0.0f;
+}
+
+/**
+ * Reads a clock, in milliseconds.
+ */
+double clock_ms( clockid_t clock )
+{
+    struct timespec now;
+
+    clock_gettime( clock, &now );
+
+    return now.tv_sec * 1000.0 + now.tv_nsec / 1000000.0;
+}
+
+int should_dump( BenchmarkOptions* options, int frame )
+{
+    int i;
+
+    for( i = 0; i < options->dump_frame_count; i++ )
+    {
+        if( options->dump_frames[i] == frame )
+            return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * Saves the current frame, and compares it against its golden image,
+ * recording the outcome in the results.
+ *
+ * Returns false if the frame doesn't match the golden image.
+ */
+int dump_frame( BenchmarkOptions* options, int frame, FILE* results,
+                int* first )
+{
+    char path[1024];
+    unsigned char *pixels, *golden = NULL;
+    int i, difference, max_difference = 0, differing_pixels = 0,
+        pixel_count = options->width * options->height, matched = 1;
+
+    pixels = read_frame( options->width, options->height );
+
+    fprintf( results, "%s\n    { \"frame\": %d", *first ? "" : ",", frame );
+    *first = 0;
+
+    if( options->dump_dir != NULL )
+    {
+        snprintf( path, sizeof(path), "%s/frame_%05d.ppm",
+                  options->dump_dir, frame );
+        if( write_ppm( path, pixels, options->width, options->height ) )
+            fprintf( results, ", \"path\": \"%s\"", path );
+    }
+
+    if( options->golden_dir != NULL )
+    {
+        snprintf( path, sizeof(path), "%s/frame_%05d.ppm",
+                  options->golden_dir, frame );
+        golden = read_ppm( path, options->width, options->height );
+
+        if( golden == NULL )
+        {
+            fprintf( results, ", \"golden\": null" );
+            matched = 0;
+        }
+        else
+        {
+            for( i = 0; i < pixel_count * 3; i++ )
+            {
+                difference = abs( pixels[i] - golden[i] );
+                if( difference > max_difference )
+                    max_difference = difference;
+                // Count each pixel once, on its first differing channel
+                if( difference > options->tolerance &&
+                    (i % 3 == 0 || abs( pixels[i - i % 3] - golden[i - i % 3] )
+                                       <= options->tolerance) &&
+                    (i % 3 != 2 || abs( pixels[i - 1] - golden[i - 1] )
+                                       <= options->tolerance) )
+                {
+                    differing_pixels++;
+                }
+            }
+            matched = differing_pixels == 0;
+
+            fprintf( results, ", \"golden\": \"%s\", \"max_difference\": %d, "
+                              "\"differing_pixels\": %d, \"matched\": %s",
+                     path, max_difference, differing_pixels,
+                     matched ? "true" : "false" );
+            free(golden);
+        }
+    }
+
+    fprintf( results, " }" );
+    free(pixels);
+
+    return matched;
+}
+
+/**
+ * Reads the framebuffer, top row first.
+ */
+unsigned char* read_frame( int width, int height )
+{
+    unsigned char* pixels = (unsigned char*)malloc( width * height * 3 );
+    unsigned char* row = (unsigned char*)malloc( width * 3 );
+    int y;
+
+    glPixelStorei( GL_PACK_ALIGNMENT, 1 );
+    glReadPixels( 0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, pixels );
+
+    // OpenGL reads bottom up, images are stored top down
+    for( y = 0; y < height / 2; y++ )
+    {
+        memcpy( row, pixels + y * width * 3, width * 3 );
+        memcpy( pixels + y * width * 3,
+                pixels + (height - 1 - y) * width * 3, width * 3 );
+        memcpy( pixels + (height - 1 - y) * width * 3, row, width * 3 );
+    }
+
+    free(row);
+    return pixels;
+}
+
+/**
+ * Writes an image as a binary PPM.
+ */
+int write_ppm( char* path, unsigned char* pixels, int width, int height )
+{
+    FILE* file = fopen( path, "wb" );
+
+    if( file == NULL )
+    {
+        perror(path);
+        return 0;
+    }
+
+    fprintf( file, "P6\n%d %d\n255\n", width, height );
+    fwrite( pixels, 3, width * height, file );
+    fclose(file);
+
+    return 1;
+}
+
+/**
+ * Reads a binary PPM written by `write_ppm`. Returns NULL if it can't be read,
+ * or isn't the given size.
+ */
+unsigned char* read_ppm( char* path, int width, int height )
+{
+    FILE* file = fopen( path, "rb" );
+    unsigned char* pixels;
+    int file_width, file_height, max_value;
+
+    if( file == NULL )
+        return NULL;
+
+    if( fscanf( file, "P6 %d %d %d", &file_width, &file_height,
+                &max_value ) != 3 ||
+        file_width != width || file_height != height || max_value != 255 ||
+        fgetc(file) == EOF )
+    {
+        fclose(file);
+        return NULL;
+    }
+
+    pixels = (unsigned char*)malloc( width * height * 3 );
+    if( fread( pixels, 3, width * height, file ) != width * height )
+    {
+        free(pixels);
+        pixels = NULL;
+    }
+
+    fclose(file);
+    return pixels;
+}
+
+int compare_double( const void* a, const void* b )
+{
+    double difference = *(const double*)a - *(const double*)b;
+
+    return difference < 0 ? -1 : difference > 0 ? 1 : 0;
+}
+
+/**
+ * Writes the mean, minimum, maximum and percentiles of a set of values.
+ * Sorts the values.
+ */
+void write_statistics( FILE* results, char* name, double* values, int count )
+{
+    double total = 0;
+    int i;
+
+    if( count == 0 )
+        return;
+
+    qsort( values, count, sizeof(double), compare_double );
+    for( i = 0; i < count; i++ )
+    {
+        total += values[i];
+    }
+
+    // Percentiles are nearest rank
+    fprintf( results, "  \"%s\": { \"mean\": %.3f, \"min\": %.3f, "
+                      "\"p50\": %.3f, \"p90\": %.3f, \"p99\": %.3f, "
+                      "\"max\": %.3f },\n",
+             name, total / count, values[0],
+             values[(int)(0.50 * (count - 1))],
+             values[(int)(0.90 * (count - 1))],
+             values[(int)(0.99 * (count - 1))],
+             values[count - 1] );
+}
@@ -0,0 +1,52 @@
+#ifndef BENCHMARK_H_
+#define BENCHMARK_H_
+/**
+ * benchmark.h
+ * This module runs the deterministic rendering benchmark.
+ *
+ * A benchmark plays a game on a fixed-seed map for a set number of frames,
+ * with a fixed time step. Player 1's viewport flies along a scripted camera
+ * path, while a script turns the players, fires their weapons (deforming the
+ * landscape) and grows them. The time taken by each frame, and the amount of
+ * work it submitted to OpenGL, are written out as JSON.
+ *
+ * Selected frames can be saved as images, and compared against previously
+ * saved "golden" images, to show that a change to the renderer still draws
+ * exactly the same thing.
+ */
+
+// The most frames that can be saved in one run
+#define MAX_DUMP_FRAMES 32
+
+typedef struct {
+    int frames; // The number of frames to run for
+    unsigned int seed; // Seeds the random number generator
+    int width, height; // The size of the framebuffer
+
+    char* results_path; // Where to write the results (NULL for stdout)
+                        // Note: the game prints messages to stdout too
+
+    // Frames to save as images, and compare against golden images
+    int dump_frames[MAX_DUMP_FRAMES];
+    int dump_frame_count;
+    char* dump_dir; // Where to save images (NULL to not save them)
+    char* golden_dir; // Where to find golden images (NULL to not compare)
+    int tolerance; // The largest difference in a channel considered a match
+} BenchmarkOptions;
+
+/**
+ * Fills in the default options.
+ */
+void benchmark_default_options( BenchmarkOptions* options );
+
+/**
+ * Starts a new game and runs the benchmark on it.
+ *
+ * The OpenGL context must already be current (see offscreen.h).
+ *
+ * Returns false if the results couldn't be written, or a frame didn't match
+ * its golden image.
+ */
+int benchmark_run( BenchmarkOptions* options );
+
+#endif /*BENCHMARK_H_*/
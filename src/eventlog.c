@@ -0,0 +1,153 @@
+#include "eventlog.h"
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+/*******************************************************************************
+ * GLOBALS AND CONSTANTS
+ ******************************************************************************/
+// How long the log's thread sleeps when there's nothing to print
+#define EVENTLOG_INTERVAL_MS 10
+
+const char* DIRECTION_NAMES[] = { "north", "south", "east", "west" };
+
+pthread_t eventlog_thread;
+atomic_int eventlog_running = 0;
+
+// The log's subscription, and where it prints to
+EventSubscription* log_subscription = NULL;
+FILE* log_file = NULL;
+
+
+/*******************************************************************************
+ * INTERNAL FUNCTION PROTOTYPES
+ ******************************************************************************/
+void* eventlog_loop( void* unused );
+void report_dropped( unsigned int* reported );
+
+
+/*******************************************************************************
+ * PUBLIC FUNCTIONS
+ ******************************************************************************/
+void eventlog_print( FILE* file, const Event* event )
+{
+    switch( event->type )
+    {
+    case EVENT_TURN:
+        fprintf( file, "Player direction now %s\n",
+                 DIRECTION_NAMES[event->direction] );
+        break;
+    case EVENT_COLLIDE:
+        switch( event->collision.with )
+        {
+        case COLLISION_WALL:
+            fprintf( file, "Player %d crashed into a wall\n", event->player );
+            break;
+        case COLLISION_OWN_BODY:
+            fprintf( file, "Player %d hit their own body\n", event->player );
+            break;
+        case COLLISION_BODY:
+            fprintf( file, "Player %d hit the body of player %d\n",
+                     event->player, event->collision.other );
+            break;
+        case COLLISION_HEAD_ON:
+            fprintf( file, "Players %d and %d collided head on!\n"
+                           "(You guys suck)\n",
+                     event->player, event->collision.other );
+            break;
+        }
+        break;
+    case EVENT_GAME_OVER:
+        if( event->winner > 0 )
+            fprintf( file, "Player %d wins!\n", event->winner );
+        else
+            fprintf( file, "Nobody wins\n" );
+        break;
+    case EVENT_SCORE:
+        fprintf( file, "Player %d score: %d\n", event->player, event->score );
+        break;
+    default:
+        break;
+    }
+}
+
+void eventlog_drain( EventSubscription* subscription, FILE* file )
+{
+    Event event;
+
+    while( EventSubscription_poll( subscription, &event ) )
+        eventlog_print( file, &event );
+}
+
+int eventlog_start( EventBus* bus, FILE* file )
+{
+    if( atomic_load(&eventlog_running) )
+        return 1;
+
+    log_subscription = EventBus_subscribe(bus);
+    if( log_subscription == NULL )
+        return 0;
+    log_file = file;
+
+    atomic_store( &eventlog_running, 1 );
+    if( pthread_create( &eventlog_thread, NULL, eventlog_loop, NULL ) != 0 )
+    {
+        atomic_store( &eventlog_running, 0 );
+        fprintf( stderr, "Could not start the event log thread\n" );
+        return 0;
+    }
+
+    return 1;
+}
+
+void eventlog_stop()
+{
+    if( !atomic_exchange( &eventlog_running, 0 ) )
+        return;
+
+    pthread_join( eventlog_thread, NULL );
+}
+
+
+/*******************************************************************************
+ * INTERNAL FUNCTIONS
+ ******************************************************************************/
+/**
+ * Prints events as they come, until the log's stopped. Run on the log's
+ * thread.
+ */
+void* eventlog_loop( void* unused )
+{
+    struct timespec wait = { 0, EVENTLOG_INTERVAL_MS * 1000000L };
+    unsigned int reported = 0;
+
+    while( atomic_load(&eventlog_running) )
+    {
+        eventlog_drain( log_subscription, log_file );
+        report_dropped(&reported);
+        fflush(log_file);
+        nanosleep( &wait, NULL );
+    }
+
+    // Whatever came in while we slept
+    eventlog_drain( log_subscription, log_file );
+    report_dropped(&reported);
+    fflush(log_file);
+
+    return NULL;
+}
+
+/**
+ * Prints how many events the log's dropped since it last said, if any.
+ */
+void report_dropped( unsigned int* reported )
+{
+    unsigned int dropped = EventSubscription_dropped( log_subscription );
+
+    if( dropped == *reported )
+        return;
+
+    fprintf( log_file, "(%u events missed)\n", dropped - *reported );
+    *reported = dropped;
+}
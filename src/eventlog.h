@@ -0,0 +1,42 @@
+#ifndef EVENTLOG_H_
+#define EVENTLOG_H_
+/**
+ * eventlog.h
+ * This module prints what happens in a game, from its events (see
+ * EventBus.h), as the game used to print it itself.
+ *
+ * The log can run on a thread of its own, taking events from a subscription
+ * to a game's bus every few milliseconds and printing them, so a slow
+ * terminal slows the log down rather than the game. Only one such log runs at
+ * a time.
+ */
+
+#include <stdio.h>
+#include "EventBus.h"
+
+/**
+ * Prints the event to `file`, if it's one that's printed; not every event
+ * is (players firing, eating and making craters aren't).
+ */
+void eventlog_print( FILE* file, const Event* event );
+
+/**
+ * Prints every event waiting in the subscription.
+ */
+void eventlog_drain( EventSubscription* subscription, FILE* file );
+
+/**
+ * Subscribes to the bus, and starts printing its events to `file` on a
+ * thread of its own.
+ *
+ * Returns false if the log couldn't be started.
+ */
+int eventlog_start( EventBus* bus, FILE* file );
+
+/**
+ * Stops the log's thread, if it's running, once it's printed the events
+ * waiting for it.
+ */
+void eventlog_stop();
+
+#endif /*EVENTLOG_H_*/
@@ -0,0 +1,223 @@
+#include "glext.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+/*******************************************************************************
+ * GLOBALS AND CONSTANTS
+ ******************************************************************************/
+PFNGLGENFRAMEBUFFERSPROC ext_glGenFramebuffers = NULL;
+PFNGLDELETEFRAMEBUFFERSPROC ext_glDeleteFramebuffers = NULL;
+PFNGLBINDFRAMEBUFFERPROC ext_glBindFramebuffer = NULL;
+PFNGLCHECKFRAMEBUFFERSTATUSPROC ext_glCheckFramebufferStatus = NULL;
+PFNGLFRAMEBUFFERTEXTURE2DPROC ext_glFramebufferTexture2D = NULL;
+PFNGLFRAMEBUFFERRENDERBUFFERPROC ext_glFramebufferRenderbuffer = NULL;
+PFNGLGENRENDERBUFFERSPROC ext_glGenRenderbuffers = NULL;
+PFNGLDELETERENDERBUFFERSPROC ext_glDeleteRenderbuffers = NULL;
+PFNGLBINDRENDERBUFFERPROC ext_glBindRenderbuffer = NULL;
+PFNGLRENDERBUFFERSTORAGEPROC ext_glRenderbufferStorage = NULL;
+PFNGLBLITFRAMEBUFFERPROC ext_glBlitFramebuffer = NULL;
+PFNGLGENBUFFERSPROC ext_glGenBuffers = NULL;
+PFNGLDELETEBUFFERSPROC ext_glDeleteBuffers = NULL;
+PFNGLBINDBUFFERPROC ext_glBindBuffer = NULL;
+PFNGLBUFFERDATAPROC ext_glBufferData = NULL;
+PFNGLBUFFERSUBDATAPROC ext_glBufferSubData = NULL;
+PFNGLGENQUERIESPROC ext_glGenQueries = NULL;
+PFNGLDELETEQUERIESPROC ext_glDeleteQueries = NULL;
+PFNGLBEGINQUERYPROC ext_glBeginQuery = NULL;
+PFNGLENDQUERYPROC ext_glEndQuery = NULL;
+PFNGLGETQUERYOBJECTIVPROC ext_glGetQueryObjectiv = NULL;
+PFNGLGETQUERYOBJECTUI64VPROC ext_glGetQueryObjectui64v = NULL;
+SwapIntervalProc ext_glXSwapIntervalSGI = NULL;
+SwapIntervalProc ext_glXSwapIntervalMESA = NULL;
+
+int has_framebuffers = 0;
+int has_blit = 0;
+int has_buffers = 0;
+int has_timer_queries = 0;
+
+
+/*******************************************************************************
+ * INTERNAL FUNCTION PROTOTYPES
+ ******************************************************************************/
+GLextFunction find_entry_point( ProcAddressLookup lookup, const char* name,
+                        const char* suffix );
+int has_extension( const char* name );
+
+
+/*******************************************************************************
+ * PUBLIC FUNCTIONS
+ ******************************************************************************/
+int glext_init( ProcAddressLookup lookup )
+{
+    /* The EXT versions of the framebuffer functions behave identically for
+     * our purposes, so fall back to them on OpenGL 2.x drivers. */
+    ext_glGenFramebuffers = (PFNGLGENFRAMEBUFFERSPROC)
+        find_entry_point( lookup, "glGenFramebuffers", "EXT" );
+    ext_glDeleteFramebuffers = (PFNGLDELETEFRAMEBUFFERSPROC)
+        find_entry_point( lookup, "glDeleteFramebuffers", "EXT" );
+    ext_glBindFramebuffer = (PFNGLBINDFRAMEBUFFERPROC)
+        find_entry_point( lookup, "glBindFramebuffer", "EXT" );
+    ext_glCheckFramebufferStatus = (PFNGLCHECKFRAMEBUFFERSTATUSPROC)
+        find_entry_point( lookup, "glCheckFramebufferStatus", "EXT" );
+    ext_glFramebufferTexture2D = (PFNGLFRAMEBUFFERTEXTURE2DPROC)
+        find_entry_point( lookup, "glFramebufferTexture2D", "EXT" );
+    ext_glFramebufferRenderbuffer = (PFNGLFRAMEBUFFERRENDERBUFFERPROC)
+        find_entry_point( lookup, "glFramebufferRenderbuffer", "EXT" );
+    ext_glGenRenderbuffers = (PFNGLGENRENDERBUFFERSPROC)
+        find_entry_point( lookup, "glGenRenderbuffers", "EXT" );
+    ext_glDeleteRenderbuffers = (PFNGLDELETERENDERBUFFERSPROC)
+        find_entry_point( lookup, "glDeleteRenderbuffers", "EXT" );
+    ext_glBindRenderbuffer = (PFNGLBINDRENDERBUFFERPROC)
+        find_entry_point( lookup, "glBindRenderbuffer", "EXT" );
+    ext_glRenderbufferStorage = (PFNGLRENDERBUFFERSTORAGEPROC)
+        find_entry_point( lookup, "glRenderbufferStorage", "EXT" );
+    ext_glBlitFramebuffer = (PFNGLBLITFRAMEBUFFERPROC)
+        find_entry_point( lookup, "glBlitFramebuffer", "EXT" );
+
+    ext_glGenBuffers = (PFNGLGENBUFFERSPROC)
+        find_entry_point( lookup, "glGenBuffers", "ARB" );
+    ext_glDeleteBuffers = (PFNGLDELETEBUFFERSPROC)
+        find_entry_point( lookup, "glDeleteBuffers", "ARB" );
+    ext_glBindBuffer = (PFNGLBINDBUFFERPROC)
+        find_entry_point( lookup, "glBindBuffer", "ARB" );
+    ext_glBufferData = (PFNGLBUFFERDATAPROC)
+        find_entry_point( lookup, "glBufferData", "ARB" );
+    ext_glBufferSubData = (PFNGLBUFFERSUBDATAPROC)
+        find_entry_point( lookup, "glBufferSubData", "ARB" );
+
+    // Queries are core in OpenGL 1.5, but timing them came much later
+    ext_glGenQueries = (PFNGLGENQUERIESPROC)
+        find_entry_point( lookup, "glGenQueries", "ARB" );
+    ext_glDeleteQueries = (PFNGLDELETEQUERIESPROC)
+        find_entry_point( lookup, "glDeleteQueries", "ARB" );
+    ext_glBeginQuery = (PFNGLBEGINQUERYPROC)
+        find_entry_point( lookup, "glBeginQuery", "ARB" );
+    ext_glEndQuery = (PFNGLENDQUERYPROC)
+        find_entry_point( lookup, "glEndQuery", "ARB" );
+    ext_glGetQueryObjectiv = (PFNGLGETQUERYOBJECTIVPROC)
+        find_entry_point( lookup, "glGetQueryObjectiv", "ARB" );
+    ext_glGetQueryObjectui64v = (PFNGLGETQUERYOBJECTUI64VPROC)
+        find_entry_point( lookup, "glGetQueryObjectui64v", "EXT" );
+
+    ext_glXSwapIntervalSGI = (SwapIntervalProc)
+        find_entry_point( lookup, "glXSwapIntervalSGI", NULL );
+    ext_glXSwapIntervalMESA = (SwapIntervalProc)
+        find_entry_point( lookup, "glXSwapIntervalMESA", NULL );
+    
+    has_framebuffers = ext_glGenFramebuffers != NULL &&
+                       ext_glDeleteFramebuffers != NULL &&
+                       ext_glBindFramebuffer != NULL &&
+                       ext_glCheckFramebufferStatus != NULL &&
+                       ext_glFramebufferTexture2D != NULL &&
+                       ext_glFramebufferRenderbuffer != NULL &&
+                       ext_glGenRenderbuffers != NULL &&
+                       ext_glDeleteRenderbuffers != NULL &&
+                       ext_glBindRenderbuffer != NULL &&
+                       ext_glRenderbufferStorage != NULL;
+    // Lookups can succeed for functions the driver doesn't support, so ask
+    has_blit = has_framebuffers && ext_glBlitFramebuffer != NULL &&
+               (has_extension("GL_ARB_framebuffer_object") ||
+                has_extension("GL_EXT_framebuffer_blit"));
+    has_buffers = ext_glGenBuffers != NULL &&
+                  ext_glDeleteBuffers != NULL &&
+                  ext_glBindBuffer != NULL &&
+                  ext_glBufferData != NULL &&
+                  ext_glBufferSubData != NULL &&
+                  has_extension("GL_ARB_vertex_buffer_object");
+    has_timer_queries = ext_glGenQueries != NULL &&
+                        ext_glDeleteQueries != NULL &&
+                        ext_glBeginQuery != NULL &&
+                        ext_glEndQuery != NULL &&
+                        ext_glGetQueryObjectiv != NULL &&
+                        ext_glGetQueryObjectui64v != NULL &&
+                        (has_extension("GL_ARB_timer_query") ||
+                         has_extension("GL_EXT_timer_query"));
+
+    return has_framebuffers;
+}
+
+int glext_has_framebuffers()
+{
+    return has_framebuffers;
+}
+
+int glext_has_blit()
+{
+    return has_blit;
+}
+
+int glext_has_buffers()
+{
+    return has_buffers;
+}
+
+int glext_has_timer_queries()
+{
+    return has_timer_queries;
+}
+
+int glext_set_swap_interval( int interval )
+{
+    if( ext_glXSwapIntervalMESA != NULL &&
+        ext_glXSwapIntervalMESA( interval ) == 0 )
+    {
+        return 1;
+    }
+    // SGI's version can't turn vsync off
+    if( ext_glXSwapIntervalSGI != NULL && interval > 0 &&
+        ext_glXSwapIntervalSGI( interval ) == 0 )
+    {
+        return 1;
+    }
+    
+    return 0;
+}
+
+
+/*******************************************************************************
+ * INTERNAL FUNCTIONS
+ ******************************************************************************/
+/**
+ * Looks up `name`, and failing that, `name` with `suffix` appended.
+ */
+GLextFunction find_entry_point( ProcAddressLookup lookup, const char* name,
+                        const char* suffix )
+{
+    char suffixed_name[64];
+    GLextFunction entry_point = lookup(name);
+
+    if( entry_point == NULL && suffix != NULL )
+    {
+        snprintf( suffixed_name, sizeof(suffixed_name), "%s%s", name, suffix );
+        entry_point = lookup(suffixed_name);
+    }
+
+    return entry_point;
+}
+
+/**
+ * Returns true if the driver lists the named extension.
+ */
+int has_extension( const char* name )
+{
+    const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+    const char* found;
+    size_t length = strlen(name);
+
+    if( extensions == NULL )
+        return 0;
+
+    // Match whole names only, since some names prefix others
+    for( found = strstr( extensions, name ); found != NULL;
+         found = strstr( found + length, name ) )
+    {
+        if( (found == extensions || found[-1] == ' ') &&
+            (found[length] == ' ' || found[length] == '\0') )
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
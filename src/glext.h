@@ -0,0 +1,98 @@
+#ifndef GLEXT_H_
+#define GLEXT_H_
+/**
+ * glext.h
+ * This module loads the OpenGL entry points that aren't part of OpenGL 1.1,
+ * and so have to be looked up at run time.
+ *
+ * Each entry point is a function pointer named after the function, with an
+ * `ext_` prefix (so as not to clash with any prototypes in the system
+ * headers). Entry points that couldn't be found are left NULL.
+ */
+
+#include <GL/gl.h>
+#include <GL/glext.h>
+
+/**
+ * An OpenGL entry point, before being cast to its real type.
+ */
+typedef void (*GLextFunction)( void );
+
+/**
+ * A function which looks up an OpenGL entry point by name, e.g.
+ * glutGetProcAddress or eglGetProcAddress.
+ */
+typedef GLextFunction (*ProcAddressLookup)( const char* name );
+
+/**
+ * Looks up every entry point. Requires a current OpenGL context.
+ *
+ * Returns true if framebuffer objects are available.
+ */
+int glext_init( ProcAddressLookup lookup );
+
+/**
+ * Returns true if framebuffer objects are available.
+ */
+int glext_has_framebuffers();
+
+/**
+ * Returns true if framebuffers can be copied between, with scaling.
+ */
+int glext_has_blit();
+
+/**
+ * Returns true if vertex and index data can be kept in buffer objects.
+ */
+int glext_has_buffers();
+
+/**
+ * Returns true if the GPU can time the commands it runs.
+ */
+int glext_has_timer_queries();
+
+/**
+ * Sets the number of vertical refreshes to wait for when swapping buffers
+ * (0 turns vsync off).
+ * 
+ * Returns false if the driver doesn't let us.
+ */
+int glext_set_swap_interval( int interval );
+
+/* Framebuffer objects (OpenGL 3.0 or EXT_framebuffer_object) */
+extern PFNGLGENFRAMEBUFFERSPROC ext_glGenFramebuffers;
+extern PFNGLDELETEFRAMEBUFFERSPROC ext_glDeleteFramebuffers;
+extern PFNGLBINDFRAMEBUFFERPROC ext_glBindFramebuffer;
+extern PFNGLCHECKFRAMEBUFFERSTATUSPROC ext_glCheckFramebufferStatus;
+extern PFNGLFRAMEBUFFERTEXTURE2DPROC ext_glFramebufferTexture2D;
+extern PFNGLFRAMEBUFFERRENDERBUFFERPROC ext_glFramebufferRenderbuffer;
+extern PFNGLGENRENDERBUFFERSPROC ext_glGenRenderbuffers;
+extern PFNGLDELETERENDERBUFFERSPROC ext_glDeleteRenderbuffers;
+extern PFNGLBINDRENDERBUFFERPROC ext_glBindRenderbuffer;
+extern PFNGLRENDERBUFFERSTORAGEPROC ext_glRenderbufferStorage;
+
+/* Framebuffer blits (OpenGL 3.0 or EXT_framebuffer_blit) */
+extern PFNGLBLITFRAMEBUFFERPROC ext_glBlitFramebuffer;
+
+/* Buffer objects (OpenGL 1.5 or ARB_vertex_buffer_object) */
+extern PFNGLGENBUFFERSPROC ext_glGenBuffers;
+extern PFNGLDELETEBUFFERSPROC ext_glDeleteBuffers;
+extern PFNGLBINDBUFFERPROC ext_glBindBuffer;
+extern PFNGLBUFFERDATAPROC ext_glBufferData;
+extern PFNGLBUFFERSUBDATAPROC ext_glBufferSubData;
+
+/* Timer queries (OpenGL 3.3, ARB_timer_query or EXT_timer_query) */
+extern PFNGLGENQUERIESPROC ext_glGenQueries;
+extern PFNGLDELETEQUERIESPROC ext_glDeleteQueries;
+extern PFNGLBEGINQUERYPROC ext_glBeginQuery;
+extern PFNGLENDQUERYPROC ext_glEndQuery;
+extern PFNGLGETQUERYOBJECTIVPROC ext_glGetQueryObjectiv;
+extern PFNGLGETQUERYOBJECTUI64VPROC ext_glGetQueryObjectui64v;
+
+/* Swap intervals (GLX_SGI_swap_control or GLX_MESA_swap_control). Both take
+ * the interval, and return zero on success. */
+typedef int (*SwapIntervalProc)( unsigned int interval );
+extern SwapIntervalProc ext_glXSwapIntervalSGI;
+extern SwapIntervalProc ext_glXSwapIntervalMESA;
+
+#endif /*GLEXT_H_*/
@@ -1,6 +1,7 @@
 #include "input.h"
 #include "Window.h"
-#include "mechanics.h"
+#include "simulation.h"
+#include "profile.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <ctype.h>
@@ -18,6 +19,11 @@
 #define PAUSE_KEY ' '
 #define DEBUG_KEY '.'   // possibly print some debug output
 #define HELP_KEY '?'    // possibly print usage notes relating to these keys
+#define PROFILE_KEY 'p' // show or hide the stage timings
+#define TRACE_KEY 't'   // start tracing, or stop and write the trace out
+
+// where traces started from the keyboard are written
+#define TRACE_FILE "trace.json"
 
 // keys used by the left player for movement
 #define LEFT_PLAYER_TURN_LEFT 'a'
@@ -47,29 +53,35 @@ void ascii_key_handler(unsigned char key, int x, int y)
     unsigned char keytest = tolower(key);       // ignore shift/capslock
     switch(keytest){
         case LEFT_PLAYER_TURN_LEFT:
-            change_player_direction(LEFT_PLAYER_ID, TURN_LEFT);
+            simulation_turn(LEFT_PLAYER_ID, TURN_LEFT);
             break;
         case LEFT_PLAYER_TURN_RIGHT:
-            change_player_direction(LEFT_PLAYER_ID, TURN_RIGHT);
+            simulation_turn(LEFT_PLAYER_ID, TURN_RIGHT);
             break;
         case LEFT_PLAYER_FIRE:
-            fire_player_weapon(LEFT_PLAYER_ID);
+            simulation_fire(LEFT_PLAYER_ID);
             break;
         case PAUSE_KEY:
-            if( is_running() )
-                pause_game();
-            else if( is_paused() )
-                resume_game();
-            else
-                new_game();
+            simulation_toggle_pause();
             break;
         case DEBUG_KEY:
             fprintf(stderr, "Debug output:\n");
             break;
+        case PROFILE_KEY:
+            profile_set_enabled(!profile_is_enabled());
+            break;
+        case TRACE_KEY:
+            if(profile_is_tracing())
+                profile_stop_trace();
+            else
+                profile_start_trace(TRACE_FILE);
+            break;
         case HELP_KEY:
             fprintf(stderr, "Game Commands:\n");
             fprintf(stderr, "[%c]:\tSee this help\n", HELP_KEY);
             fprintf(stderr, "[%c]:\tSee debug print\n", DEBUG_KEY);
+            fprintf(stderr, "[%c]:\tShow or hide stage timings\n", PROFILE_KEY);
+            fprintf(stderr, "[%c]:\tStart tracing, or write the trace to %s\n", TRACE_KEY, TRACE_FILE);
             fprintf(stderr, "[%c]:\tPause or unpause the game\n", PAUSE_KEY);
             if(EXIT_KEY == 27)
                 fprintf(stderr, "[ESC]:\tExit the game\n");
@@ -85,9 +97,8 @@ void ascii_key_handler(unsigned char key, int x, int y)
         case EXIT_KEY:
             exit(0);
             break;
-        default:
-            fprintf(stderr, "unknown keyboard command\n");
-            break;
+        // Other keys are ignored (the help key lists the ones that aren't),
+        // rather than complained about on the input thread
     }
 }
 
@@ -95,13 +106,13 @@ void special_key_handler(int key, int x, int y)
 {
     switch(key){
         case GLUT_KEY_LEFT:
-            change_player_direction(RIGHT_PLAYER_ID, TURN_LEFT);
+            simulation_turn(RIGHT_PLAYER_ID, TURN_LEFT);
             break;
         case GLUT_KEY_RIGHT:
-            change_player_direction(RIGHT_PLAYER_ID, TURN_RIGHT);
+            simulation_turn(RIGHT_PLAYER_ID, TURN_RIGHT);
             break;
         case GLUT_KEY_UP:
-            fire_player_weapon(RIGHT_PLAYER_ID);
+            simulation_fire(RIGHT_PLAYER_ID);
             break;
         /* default:
             fprintf(stderr, "unknown keyboard command\n");
@@ -4,8 +4,8 @@
  * This module is responsible for handling input.
  * 
  * The module is event driven, with the various handler functions called by GLUT
- * when an input event takes place. These handler functions then invoke
- * functions in the mechanics module, which affect the gamestate.
+ * when an input event takes place. These handler functions then queue commands
+ * for the simulation (see simulation.h), which affect the gamestate.
  * 
  * More generally, this module is used to map keystrokes to player actions.
  */
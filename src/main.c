@@ -1,8 +1,17 @@
 #include "mechanics.h"
+#include "simulation.h"
 #include "input.h"
 #include "render.h"
 #include "Window.h"
+#include "offscreen.h"
+#include "benchmark.h"
+#include "pacing.h"
+#include "profile.h"
+#include "eventlog.h"
+#include "splitscreen.h"
 #include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
 
 /*******************************************************************************
  * MACROS
@@ -19,8 +28,6 @@
 #endif
 
 #include <time.h>
-// The following returns the number of milliseconds since system start
-#define GET_CURRENT_TIME() clock() / (CLOCKS_PER_SEC / 1000.0f)
 
 // Make sure glut.h is included after stdlib.h to keep the VS compiler from
 // throwing a hissy fit
@@ -35,13 +42,57 @@
 #define DEFAULT_WINDOW_X 0
 #define DEFAULT_WINDOW_Y 0
 
+// The number of frames to render when headless, unless told otherwise
+#define DEFAULT_HEADLESS_FRAMES 1000
+
+// Frames per second in a window, unless told otherwise (headless, frames are
+// drawn as fast as possible)
+#define DEFAULT_TARGET_FPS 60
+
+/**
+ * Options given on the command line.
+ */
+typedef struct {
+    // Render offscreen instead of opening a window
+    int headless;
+    int width, height;
+    // The number of frames to render when headless
+    int frames;
+    // Simulation ticks per second, and the most run at once to catch up
+    int tick_rate, max_catch_up;
+    // The number of players, each with a view, or 0 for the default
+    int players;
+    // Target frames per second (negative for the default), and whether to
+    // wait for vsync
+    int fps, vsync;
+    // Draw the players' viewports at a lower resolution when frames are slow
+    int dynamic_resolution;
+    // Skip drawing what's hidden behind hills
+    int occlusion;
+    // Time each stage of the game from the start
+    int profile;
+    // Where to write a trace of the whole run, or NULL
+    char* trace_path;
+    // Run the benchmark instead of a free-running game
+    int benchmark;
+    BenchmarkOptions benchmark_options;
+} Options;
+
 
 /*******************************************************************************
  * FUNCTION PROTOTYPES
  ******************************************************************************/
 void initialize_GLUT( int*, char** );
 void game_loop();
+void schedule_frame();
+void frame_due( int unused );
 void initialize_game();
+int parse_options( int argc, char** argv, Options* options );
+int run_headless( Options* options );
+int run_benchmark( Options* options );
+int parse_frame_list( char* list, BenchmarkOptions* options );
+void set_frame_budget( Options* options, int fps );
+void print_usage( char* program );
 
 
 /*******************************************************************************
@@ -49,11 +100,47 @@ void initialize_game();
  ******************************************************************************/
 int main( int argc, char** argv )
 {
+    Options options;
+    
+    if( !parse_options( argc, argv, &options ) )
+    {
+        print_usage( argv[0] );
+        return 1;
+    }
+    
+    profile_set_enabled(options.profile);
+    render_set_occlusion(options.occlusion);
+    profile_name_thread("main");
+    if( options.trace_path != NULL )
+        profile_start_trace(options.trace_path);
+    // Registered first so that it runs last, once the simulation has stopped
+    atexit(profile_shutdown);
+    
+    /* The benchmark is always headless */
+    if( options.benchmark )
+    {
+        return run_benchmark(&options);
+    }
+    
+    simulation_configure( options.tick_rate, options.max_catch_up );
+    simulation_set_players( options.players );
+    
+    /* Without a display, skip GLUT altogether */
+    if( options.headless )
+    {
+        return run_headless(&options);
+    }
+    
     /* Initialize GLUT */
     initialize_GLUT( &argc, argv );
     
     /* Initialize game modules */
     initialize_game();
+    pacing_init( options.fps < 0 ? DEFAULT_TARGET_FPS : options.fps,
+                 options.vsync );
+    set_frame_budget( &options,
+                      options.fps < 0 ? DEFAULT_TARGET_FPS : options.fps );
+    schedule_frame();
     
     /* Start event processing */
     glutMainLoop();
@@ -88,39 +175,46 @@ void initialize_game()
 {
     int window_id;
     
-    // Seed the random number generator
-    srand( time(NULL) );
-    
 	/* Initialize windowing and rendering */
     window_id = Window_new(PROJECT_TITLE);
 
-    // Create a new game
-    new_game();
+    // Create a new game, seeded from the clock
+    simulation_init( time(NULL) );
     // TODO: show main menu instead of immediately starting the game
     /* Initialize the game mechanics module */
-    //mechanics_init( GET_CURRENT_TIME() );
+    //mechanics_init();
     
     Window_registerReshapeEventHandler( window_id, window_resized );
     
     /* Initialize input */
     input_init(window_id);
     
-	render_init();
+	render_init(BACKEND_GLUT);
 
-    /* Register the game loop */
-    glutIdleFunc(game_loop);
+    /* Print what happens in the game on a thread of its own, so that the
+     * simulation never waits for the terminal */
+    if( !eventlog_start( simulation_gamestate()->events, stdout ) )
+        exit(1);
+    atexit(eventlog_stop);
+    
+    /* Run the simulation on its own thread, and draw on this one */
+    if( !simulation_start() )
+        exit(1);
+    atexit(simulation_stop);
 }
 
 /**
- * The game loop, this function is called periodically to update the game.
+ * The game loop, this function is called periodically to draw the game. The
+ * game itself is updated on the simulation thread.
  */
 void game_loop()
 {
     static int last_time = -1;
     int delta, now;
+    long long frame_start, start;
     
-    /* Update the game */
-    now = GET_CURRENT_TIME();
+    // GLUT's wall clock works without a window
+    now = glutGet(GLUT_ELAPSED_TIME);
     
     if( last_time == -1 )
     {
@@ -128,15 +222,387 @@ void game_loop()
         return;
     }
     
-    // Get the time since the last update (minimum of one millisecond)
-    delta = 1 + now - last_time; // TODO: remove the 1
-    update_world(delta);
+    delta = now - last_time;
+    frame_start = PROFILE_BEGIN();
     
     /* Update the render module */
+    start = PROFILE_BEGIN();
     render_update(delta);
+    PROFILE_END( PROFILE_RENDER_UPDATE, start );
     
     /* Render the game */
     render();
     
+    PROFILE_END( PROFILE_FRAME, frame_start );
     last_time = now;
 }
+
+/**
+ * Asks GLUT to call `frame_due` when the next frame is due. Until then GLUT
+ * waits for events, without using the CPU.
+ */
+void schedule_frame()
+{
+    glutTimerFunc( pacing_time_to_next_frame(), frame_due, 0 );
+}
+
+/**
+ * Draws a frame, once it's due.
+ */
+void frame_due( int unused )
+{
+    // GLUT's timers are only accurate to a millisecond or so
+    pacing_wait();
+    
+    game_loop();
+    pacing_frame_presented();
+    
+    // Draw slowly while there's nothing much to draw
+    pacing_set_low_power( !render_game_is_active() );
+    
+    schedule_frame();
+}
+
+/**
+ * Reads our own options from the command line. Anything we don't recognise is
+ * left for GLUT.
+ * 
+ * Returns false if the options are malformed.
+ */
+int parse_options( int argc, char** argv, Options* options )
+{
+    int i;
+    
+    options->headless = 0;
+    options->width = DEFAULT_WINDOW_WIDTH;
+    options->height = DEFAULT_WINDOW_HEIGHT;
+    options->frames = DEFAULT_HEADLESS_FRAMES;
+    options->tick_rate = DEFAULT_TICK_RATE;
+    options->max_catch_up = DEFAULT_MAX_CATCH_UP;
+    options->players = 0;
+    options->fps = -1;
+    options->vsync = 1;
+    options->dynamic_resolution = 1;
+    options->occlusion = 1;
+    options->profile = 0;
+    options->trace_path = NULL;
+    options->benchmark = 0;
+    benchmark_default_options(&options->benchmark_options);
+    
+    for( i = 1; i < argc; i++ )
+    {
+        if( strcmp( argv[i], "--headless" ) == 0 )
+        {
+            options->headless = 1;
+            // The size is optional
+            if( i + 1 < argc && argv[i + 1][0] != '-' )
+            {
+                i++;
+                if( sscanf( argv[i], "%dx%d",
+                            &options->width, &options->height ) != 2 ||
+                    options->width <= 0 || options->height <= 0 )
+                {
+                    return 0;
+                }
+            }
+        }
+        else if( strcmp( argv[i], "--frames" ) == 0 )
+        {
+            if( i + 1 >= argc ||
+                sscanf( argv[++i], "%d", &options->frames ) != 1 ||
+                options->frames <= 0 )
+            {
+                return 0;
+            }
+            options->benchmark_options.frames = options->frames;
+        }
+        else if( strcmp( argv[i], "--tick-rate" ) == 0 )
+        {
+            if( i + 1 >= argc ||
+                sscanf( argv[++i], "%d", &options->tick_rate ) != 1 ||
+                options->tick_rate <= 0 )
+            {
+                return 0;
+            }
+        }
+        else if( strcmp( argv[i], "--max-catch-up" ) == 0 )
+        {
+            if( i + 1 >= argc ||
+                sscanf( argv[++i], "%d", &options->max_catch_up ) != 1 ||
+                options->max_catch_up <= 0 )
+            {
+                return 0;
+            }
+        }
+        else if( strcmp( argv[i], "--players" ) == 0 )
+        {
+            // Every player needs a view
+            if( i + 1 >= argc ||
+                sscanf( argv[++i], "%d", &options->players ) != 1 ||
+                options->players < 1 || options->players > MAX_SPLIT_VIEWS )
+            {
+                return 0;
+            }
+        }
+        else if( strcmp( argv[i], "--fps" ) == 0 )
+        {
+            if( i + 1 >= argc ||
+                sscanf( argv[++i], "%d", &options->fps ) != 1 ||
+                options->fps < 0 )
+            {
+                return 0;
+            }
+        }
+        else if( strcmp( argv[i], "--no-vsync" ) == 0 )
+        {
+            options->vsync = 0;
+        }
+        else if( strcmp( argv[i], "--no-dynamic-resolution" ) == 0 )
+        {
+            options->dynamic_resolution = 0;
+        }
+        else if( strcmp( argv[i], "--no-occlusion" ) == 0 )
+        {
+            options->occlusion = 0;
+        }
+        else if( strcmp( argv[i], "--profile" ) == 0 )
+        {
+            options->profile = 1;
+        }
+        else if( strcmp( argv[i], "--trace" ) == 0 )
+        {
+            if( i + 1 >= argc )
+                return 0;
+            options->trace_path = argv[++i];
+        }
+        else if( strcmp( argv[i], "--benchmark" ) == 0 )
+        {
+            options->benchmark = 1;
+        }
+        else if( strcmp( argv[i], "--seed" ) == 0 )
+        {
+            if( i + 1 >= argc || sscanf( argv[++i], "%u",
+                                    &options->benchmark_options.seed ) != 1 )
+            {
+                return 0;
+            }
+        }
+        else if( strcmp( argv[i], "--results" ) == 0 )
+        {
+            if( i + 1 >= argc )
+                return 0;
+            options->benchmark_options.results_path = argv[++i];
+        }
+        else if( strcmp( argv[i], "--dump-frames" ) == 0 )
+        {
+            if( i + 1 >= argc ||
+                !parse_frame_list( argv[++i], &options->benchmark_options ) )
+            {
+                return 0;
+            }
+        }
+        else if( strcmp( argv[i], "--dump-dir" ) == 0 )
+        {
+            if( i + 1 >= argc )
+                return 0;
+            options->benchmark_options.dump_dir = argv[++i];
+        }
+        else if( strcmp( argv[i], "--golden-dir" ) == 0 )
+        {
+            if( i + 1 >= argc )
+                return 0;
+            options->benchmark_options.golden_dir = argv[++i];
+        }
+        else if( strcmp( argv[i], "--tolerance" ) == 0 )
+        {
+            if( i + 1 >= argc ||
+                sscanf( argv[++i], "%d",
+                        &options->benchmark_options.tolerance ) != 1 ||
+                options->benchmark_options.tolerance < 0 )
+            {
+                return 0;
+            }
+        }
+    }
+    
+    options->benchmark_options.width = options->width;
+    options->benchmark_options.height = options->height;
+    
+    return 1;
+}
+
+/**
+ * Reads a comma separated list of frame numbers, e.g. "0,300,600".
+ * 
+ * Returns false if the list is malformed or too long.
+ */
+int parse_frame_list( char* list, BenchmarkOptions* options )
+{
+    char* end;
+    long frame;
+    
+    options->dump_frame_count = 0;
+    while( *list != '\0' )
+    {
+        frame = strtol( list, &end, 10 );
+        if( end == list || frame < 0 ||
+            options->dump_frame_count >= MAX_DUMP_FRAMES )
+        {
+            return 0;
+        }
+        options->dump_frames[options->dump_frame_count++] = (int)frame;
+        
+        list = end;
+        if( *list == ',' )
+            list++;
+        else if( *list != '\0' )
+            return 0;
+    }
+    
+    return 1;
+}
+
+/**
+ * Gives the renderer a frame's worth of time at `fps` frames per second to
+ * draw in, unless dynamic resolution is turned off or frames are unlimited.
+ */
+void set_frame_budget( Options* options, int fps )
+{
+    if( options->dynamic_resolution && fps > 0 )
+        render_set_frame_budget( 1000.0f / fps );
+}
+
+/**
+ * Runs the game without a window, rendering `options->frames` frames into an
+ * offscreen framebuffer, then reports how long it took.
+ */
+int run_headless( Options* options )
+{
+    int i, start, elapsed;
+    clock_t cpu_start;
+    PacingStats* pacing = pacing_get_stats();
+    
+    if( !offscreen_init( options->width, options->height ) )
+    {
+        fprintf( stderr, "Could not start the headless backend\n" );
+        return 1;
+    }
+    
+    simulation_init( time(NULL) );
+    render_init(BACKEND_OFFSCREEN);
+    // There's no window to tell us its size
+    window_resized( options->width, options->height );
+    
+    if( !eventlog_start( simulation_gamestate()->events, stdout ) ||
+        !simulation_start() )
+    {
+        eventlog_stop();
+        offscreen_shutdown();
+        return 1;
+    }
+    
+    // There's no display to wait for
+    pacing_init( options->fps < 0 ? 0 : options->fps, 0 );
+    set_frame_budget( options, options->fps < 0 ? 0 : options->fps );
+    
+    start = glutGet(GLUT_ELAPSED_TIME);
+    cpu_start = clock();
+    for( i = 0; i < options->frames; i++ )
+    {
+        pacing_wait();
+        game_loop();
+        pacing_frame_presented();
+    }
+    elapsed = glutGet(GLUT_ELAPSED_TIME) - start;
+    
+    simulation_stop();
+    eventlog_stop();
+    
+    printf( "Rendered %d frames at %dx%d in %d ms (%.1f FPS)\n",
+            options->frames, options->width, options->height, elapsed,
+            elapsed > 0 ? options->frames * 1000.0f / elapsed : 0.0f );
+    // clock() gives the CPU time of every thread
+    printf( "Frame time %.2f +/- %.2f ms, CPU %.0f%% of a core\n",
+            pacing->mean_ms, pacing->deviation_ms,
+            elapsed > 0 ? 100.0f * (clock() - cpu_start) /
+                          (CLOCKS_PER_SEC / 1000.0f) / elapsed : 0.0f );
+    if( options->profile )
+        profile_print_stats();
+    
+    offscreen_shutdown();
+    
+    return 0;
+}
+
+/**
+ * Runs the benchmark in an offscreen framebuffer.
+ */
+int run_benchmark( Options* options )
+{
+    int passed;
+    
+    if( !offscreen_init( options->width, options->height ) )
+    {
+        fprintf( stderr, "Could not start the headless backend\n" );
+        return 1;
+    }
+    
+    passed = benchmark_run(&options->benchmark_options);
+    if( options->profile )
+        profile_print_stats();
+    
+    offscreen_shutdown();
+    
+    return passed ? 0 : 1;
+}
+
+void print_usage( char* program )
+{
+    fprintf( stderr, "Usage: %s [--headless [WIDTHxHEIGHT]] [--frames N] "
+                     "[--tick-rate N] [--max-catch-up N]\n"
+                     "           [--players N] [--fps N] [--no-vsync] "
+                     "[--no-dynamic-resolution] [--no-occlusion]\n"
+                     "           [--profile] [--trace FILE]\n"
+                     "       %s --benchmark [--headless WIDTHxHEIGHT] "
+                     "[--frames N] [--seed N]\n"
+                     "           [--results FILE] [--dump-frames N,N,...] "
+                     "[--dump-dir DIR]\n"
+                     "           [--golden-dir DIR] [--tolerance N]\n"
+                     "  --headless     render offscreen, without a display\n"
+                     "  --frames       number of frames to render when "
+                     "headless (default %d)\n"
+                     "  --tick-rate    simulation ticks per second "
+                     "(default %d)\n"
+                     "  --max-catch-up most ticks run at once after falling "
+                     "behind (default %d)\n"
+                     "  --players      number of players, each with a view "
+                     "(up to %d)\n"
+                     "  --fps          target frames per second, 0 for "
+                     "unlimited (default %d,\n"
+                     "                 or unlimited when headless)\n"
+                     "  --no-vsync     don't wait for vsync\n"
+                     "  --no-dynamic-resolution\n"
+                     "                 always draw at full resolution, "
+                     "even if it drops frames\n"
+                     "  --no-occlusion draw what's hidden behind hills "
+                     "anyway\n"
+                     "  --profile      time each stage of the game, shown "
+                     "on the HUD (and\n"
+                     "                 printed at the end when headless)\n"
+                     "  --trace        write a Chrome trace of the whole run "
+                     "to FILE\n"
+                     "  --benchmark    run the scripted benchmark headless, "
+                     "and write its\n"
+                     "                 frame times as JSON\n"
+                     "  --seed         benchmark map seed\n"
+                     "  --results      where to write benchmark results "
+                     "(default benchmark.json)\n"
+                     "  --dump-frames  benchmark frames to save and compare\n"
+                     "  --dump-dir     directory to save frames in, as PPM\n"
+                     "  --golden-dir   directory of golden frames to "
+                     "compare against\n"
+                     "  --tolerance    largest per-channel difference "
+                     "that still matches\n",
+             program, program, DEFAULT_HEADLESS_FRAMES, DEFAULT_TICK_RATE,
+             DEFAULT_MAX_CATCH_UP, MAX_SPLIT_VIEWS, DEFAULT_TARGET_FPS );
+}
@@ -21,12 +21,6 @@ float distance_between_points( Point point1, Point point2 )
     return sqrt( x + y + z );
 }
 
-float bounded_random( float min, float max )
-{
-//    return 0;// TESTING
-    return min + (max - min) * ((float)rand() / (float)RAND_MAX);
-}
-
 void cross_product( Point v1, Point v2, Point* product )
 {
     (*product)[0] = v1[1]*v2[2] - v1[2]*v2[1];
@@ -109,8 +103,8 @@ float dot(float* v1, float* v2)
 void addVector(float* v1,float* v2,float* result)
 {
 	result[0] = v1[0]+v2[0];
-	result[0] = v1[1]+v2[1];
-	result[0] =	v1[2]+v2[2];
+	result[1] = v1[1]+v2[1];
+	result[2] =	v1[2]+v2[2];
 }
 
 void multiplyScalar(float scalar,float* vector, float* result)
@@ -134,3 +128,25 @@ float dist_point_to_line( float* point, float* line1, float* line2 )
     
     return result;
 }
+
+int frustum_contains_box( Frustum* frustum, float min[3], float max[3] )
+{
+    float* plane;
+    int i;
+    
+    for( i = 0; i < 6; i++ )
+    {
+        plane = frustum->planes[i];
+        // Test the corner furthest along the plane's normal; if even that's
+        // behind the plane, so is the whole box
+        if( plane[0] * (plane[0] >= 0.0f ? max[0] : min[0]) +
+            plane[1] * (plane[1] >= 0.0f ? max[1] : min[1]) +
+            plane[2] * (plane[2] >= 0.0f ? max[2] : min[2]) +
+            plane[3] < 0.0f )
+        {
+            return 0;
+        }
+    }
+    
+    return 1;
+}
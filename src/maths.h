@@ -9,13 +9,17 @@
 #include "Landscape.h"
 
 /**
- * Calculates the distance between two points.
+ * The six planes bounding what a view can see. Each is (a, b, c, d), with the
+ * points inside satisfying ax + by + cz + d >= 0.
  */
-float distance_between_points( Point point1, Point point2 );
+typedef struct {
+    float planes[6][4];
+} Frustum;
+
 /**
- * Generates a random number between min and max.
+ * Calculates the distance between two points.
  */
-float bounded_random( float min, float max );
+float distance_between_points( Point point1, Point point2 );
 /**
  * Calculates the cross product of two vectors.
  */
@@ -37,5 +41,10 @@ void addVector(float* v1,float* v2,float* result);
  * Dot product.
  */
 float dot(float* v1, float* v2);
+/**
+ * Returns false if the box between the corners `min` and `max` is certainly
+ * outside the frustum. (It may return true for some boxes just outside.)
+ */
+int frustum_contains_box( Frustum* frustum, float min[3], float max[3] );
 
 #endif /*MATHS_H_*/
@@ -4,13 +4,11 @@
 #include <stdio.h>
 #include <math.h>
 #include "maths.h"
+#include "profile.h"
 
 /******************************************************************************
  * GLOBALS AND CONSTANTS
  ******************************************************************************/
-// The number of points across the landscape grid
-#define DEFAULT_GRID_SIZE 129
-
 // Define the bounds of the game world
 #define WORLD_WEST_BOUND -4.0f
 #define WORLD_SOUTH_BOUND -4.0f
@@ -24,39 +22,22 @@
 // Distance units per second per second
 #define GRAVITY -4.9
 
-// The players' speed, in grid divisions per second
-#define PLAYER_SPEED 20
-// Initial maximum length of a player, in grid divisions
-#define PLAYER_INITIAL_LENGTH 64
-// Player's radius, in grid divisions
-#define PLAYER_RADIUS 0.5
-
 // Food is generated above the landscape, and falls to the ground.
 // This gives the height above the landscape that it starts
 #define INITIAL_FOOD_HEIGHT 5.0f
-#define POINTS_FOR_FOOD 100
-// The radius of edibles, in grid divisions
-#define FOOD_RADIUS 3.0f
-// The amount of tail food gives you, in grid divisions
-#define FOOD_LENGTH_INCREMENT 64.0f
-
-// Projectile speed, in grid divisions per second
-#define PROJ_SPEED 3.0f
-// deformation amount is the depth in divisions
-// radius is also in divisions
-#define DEFORMATION_RADIUS 80.0f
-#define DEFORMATION_AMOUNT 2.0f
 
-#define COUNTDOWN_TIME 3.0f
+// The rest of the numbers the game's played by are the gamestate's rules
+// (see rules.h)
 
-GameState* gamestate = NULL;
+#define COUNTDOWN_TIME 3.0f
 
 
 /******************************************************************************
  * INTERNAL FUNCTION PROTOTYPES
  ******************************************************************************/
 /* Domain rules:
- *   1. Collisions
+ *   1. Collisions (a player who collides with a wall or a player is out of
+ *      the game, which ends when there's one player left, or none)
  *      1. Between player head and player tail
  *      2. Between player head and wall
  *      3. Between player head and food
@@ -72,46 +53,61 @@ GameState* gamestate = NULL;
  *      4. Food falls
  *   3. Initialization
  *      1. Random landscape is generated
- *      2. Players begin on opposite sides
+ *      2. Players begin spread along the south and north sides
  *      3. Any food or projectiles in the game are destroyed
  *      4. The first edible is generated
  */
-int player_player_collision( int );
-int player_wall_collision( Player*, Direction );
-int player_food_collision( Player* );
-int player_projectile_collision( Player*, Projectile* );
-void projectile_landscape_collision( Projectile*, Landscape* );
-void projectile_wall_collision( Projectile*, Direction );
-void edible_landscape_collision( Edible*, Landscape* );
-
-void update_players( int delta );
-void update_projectiles( int delta );
-void update_projectile( Projectile* projectile, int delta );
-void update_food( int delta );
-void apply_gravity( Object* object, int delta );
-void apply_object_velocity( Object* object, int delta );
-
-int set_next_point( Player* player );
-
-void move_player( Player* player, int delta );
-int test_player_collisions( Player* player, float movement );
-void clear_gamestate();
-void generate_edible();
-
-void update_player_positions( Player* player );
-void calculate_offset_position( Direction dir, float position[3],
-                                float offset, float from[3], float to[3] );
+int player_player_collision( GameState* gamestate, Player*, Player*, int );
+int player_wall_collision( GameState* gamestate, Player*, Direction );
+int player_food_collision( GameState* gamestate, Player* );
+void projectile_landscape_collision( GameState* gamestate, int place,
+                                     Landscape* );
+void projectile_wall_collision( GameState* gamestate, int place, Direction );
+void edible_landscape_collision( ObjectPool* edibles, int place );
+
+void update_players( GameState* gamestate, float delta );
+void update_projectiles( GameState* gamestate, float delta );
+int projectile_outside( GameState* gamestate, int place, Direction* wall );
+int projectile_landing( GameState* gamestate, int place, float delta,
+                        float* hit );
+void despawn_projectile( GameState* gamestate, int place );
+void update_food( GameState* gamestate, float delta );
+
+int set_next_point( GameState* gamestate, Player* player );
+
+void move_player( GameState* gamestate, Player* player, float delta );
+int test_player_collisions( GameState* gamestate, Player* player,
+                            float movement );
+int check_player_collisions( GameState* gamestate, Player* player,
+                             float movement );
+Player* head_near( GameState* gamestate, Player* player, Point position );
+int body_occupies( GameState* gamestate, Player* player, int row, int column,
+                   int skip_newest, int skip_oldest );
+void knock_out_player( GameState* gamestate, Player* player );
+int eliminate_player( GameState* gamestate, Player* player );
+int grid_size( int points );
+void clear_gamestate( GameState* gamestate );
+void generate_edible( GameState* gamestate );
+
+void update_player_positions( GameState* gamestate, Player* player );
+void calculate_offset_position( GameState* gamestate, Direction dir,
+                                float position[3], float offset,
+                                float from[3], float to[3] );
 void set_player_forward_vector( Player* player, Landscape* landscape );
 void set_player_up_vector( Player* player );
 
-void initialize_player( Player* player, int row, int column, Direction dir );
-float distance_to_next_point( Player* player );
+void initialize_players( GameState* gamestate );
+void initialize_player( GameState* gamestate, Player* player,
+                        int row, int column, Direction dir );
+float distance_to_next_point( GameState* gamestate, Player* player );
 void closest_grid_coordinate( float X, float Z, int* row, int* column );
 float get_height_at_point( Landscape* landscape, float X, float Z );
 
-void deform_landscape( float X, float Z, Landscape* landscape );
+void deform_landscape( GameState* gamestate, float X, float Z,
+                       Landscape* landscape );
 
-void print_score();
+Event new_event( GameState* gamestate, EventType type, Player* player );
+void publish_scores( GameState* gamestate );
 
 
 /******************************************************************************
@@ -122,8 +118,10 @@ void mechanics_init( int current_time )
 {
 }
 
-void update_world( int delta )
+void update_world( GameState* gamestate, float delta )
 {
+    long long start;
+
     // If we're counting down to begin the game, count down
     if( gamestate->mode == MODE_COUNTDOWN )
     {
@@ -138,7 +136,9 @@ void update_world( int delta )
             // Decrement the countdown timer
             gamestate->countdown -= delta / 1000.0f;
             // We still want food to drop
-            update_food(delta);
+            start = PROFILE_BEGIN();
+            update_food(gamestate, delta);
+            PROFILE_END( PROFILE_FOOD, start );
         }
     }
     
@@ -146,28 +146,36 @@ void update_world( int delta )
     if( gamestate->mode == MODE_RUNNING )
     {
         // Move players
-        update_players(delta);
+        start = PROFILE_BEGIN();
+        update_players(gamestate, delta);
+        PROFILE_END( PROFILE_UPDATE_PLAYERS, start );
         // Update projectiles
-        update_projectiles(delta);
+        start = PROFILE_BEGIN();
+        update_projectiles(gamestate, delta);
+        PROFILE_END( PROFILE_PROJECTILES, start );
         // Update food
-        update_food(delta);
+        start = PROFILE_BEGIN();
+        update_food(gamestate, delta);
+        PROFILE_END( PROFILE_FOOD, start );
     }
 }
 
-void new_game()
+void new_game( GameState* gamestate )
 {
-    /* If this is the first game, create the gamestate.
-     * Otherwise, clear it. */
-    if( gamestate == NULL )
+    long long start;
+    
+    // Clear the last game, if there was one
+    if( gamestate->landscape != NULL )
     {
-        gamestate = GameState_new();
+        clear_gamestate(gamestate);
     }
-    else
+    // Have as many players as the rules say
+    if( gamestate->playerCount != gamestate->rules.players )
     {
-        clear_gamestate();
+        GameState_clearPlayers(gamestate);
     }
     
-    gamestate->landscape = Landscape_new( DEFAULT_GRID_SIZE,
+    gamestate->landscape = Landscape_new( grid_size(gamestate->rules.gridSize),
                                           WORLD_MINHEIGHT,
                                           WORLD_MAXHEIGHT,
                                           WORLD_SOUTH_BOUND,
@@ -175,55 +183,51 @@ void new_game()
                                           WORLD_WIDTH,
                                           WORLD_DEPTH );
 
+    gamestate->occupancy = OccupancyGrid_new( gamestate->landscape->gridWidth );
+
     gamestate->mode = MODE_COUNTDOWN;
     gamestate->countdown = COUNTDOWN_TIME;
+    gamestate->generation++;
+    gamestate->winner = 0;
+    gamestate->deformations = 0;
+    gamestate->playersLeft = gamestate->playerCount;
     
     /* Set up initial game conditions */
     // Set the player speed.
-    gamestate->playerSpeed = PLAYER_SPEED * gamestate->landscape->gridDivisionWidth;
+    gamestate->playerSpeed = gamestate->rules.playerSpeed *
+                             gamestate->landscape->gridDivisionWidth;
     // Generate the landscape
-    Landscape_generate( gamestate->landscape );
+    start = PROFILE_BEGIN();
+    Landscape_generate( gamestate->landscape, &gamestate->terrainRandom );
+    PROFILE_END( PROFILE_GENERATE_LANDSCAPE, start );
     
     // Put the players on opposite sides
-    // Start player 1 at the southmost edge, in the middle, moving north
-    initialize_player( gamestate->player1,
-                       gamestate->landscape->gridWidth / 2,
-                       0,
-                       DIRECTION_NORTH );
-    // Start player 2 at the northmost edge, in the middle, moving south
-    initialize_player( gamestate->player2,
-                       gamestate->landscape->gridWidth / 2,
-                       gamestate->landscape->gridWidth - 1,
-                       DIRECTION_SOUTH );
+    GameState_indexHeads(gamestate);
+    initialize_players(gamestate);
     
     // Generate the first edible
-    generate_edible();
+    generate_edible(gamestate);
 }
 
-int fire_player_weapon( int player_id )
+int fire_player_weapon( GameState* gamestate, int player_id )
 {
     Player* player;
-    Projectile* projectile;
+    ObjectHandle handle;
+    ObjectPool* projectiles = gamestate->projectiles;
+    Event event;
+    float velocity[3];
+    int place;
     
     if( gamestate->mode != MODE_RUNNING )
     {
         return 0;
     }
     
-    if( player_id == 1 )
-    {
-        player = gamestate->player1;
-        // Don't let them fire if they have a projectile in existance
-        if( gamestate->player1_projectile != NULL )
-            return 0;
-    }
-    else if( player_id == 2 )
-    {
-        player = gamestate->player2;
-        if( gamestate->player2_projectile != NULL )
-            return 0;
-    }
-    else
+    player = GameState_player( gamestate, player_id );
+    if( player == NULL || player->out )
+        return 0;
+    // Don't let them fire if they have a projectile in existance
+    if( !ObjectHandle_isNone(gamestate->playerProjectiles[player->number]) )
         return 0;
     
     // Do not let the player fire their weapon if they're beneath the landscape
@@ -232,54 +236,69 @@ int fire_player_weapon( int player_id )
     
     // Create a new projectile just outside the bounds of the player's head,
     // with an appropriate velocity
-    projectile = Object_new();
-    projectile->velocity[0] = player->forward[0] * gamestate->playerSpeed;
-    projectile->velocity[1] = player->forward[1] * gamestate->playerSpeed;
-    projectile->velocity[2] = player->forward[2] * gamestate->playerSpeed;
+    handle = ObjectPool_spawn( projectiles, OBJECT_PROJECTILE,
+                               player->number );
+    place = ObjectPool_find( projectiles, handle );
+    if( place < 0 )
+        return 0;
+    velocity[0] = player->forward[0] * gamestate->playerSpeed;
+    velocity[1] = player->forward[1] * gamestate->playerSpeed;
+    velocity[2] = player->forward[2] * gamestate->playerSpeed;
     
     // Make it 45 degrees
     float origin[3] = {0, 0, 0};
-    projectile->velocity[1] += distance_between_points(origin, projectile->velocity) / 2.0;
+    velocity[1] += distance_between_points(origin, velocity) / 2.0;
     
     // Normalise the velocity
-    normaliseVector(projectile->velocity);
+    normaliseVector(velocity);
     
     // Make it move fast
-    projectile->velocity[0] *= PROJ_SPEED;
-    projectile->velocity[1] *= PROJ_SPEED;
-    projectile->velocity[2] *= PROJ_SPEED;
+    projectiles->velocity[0][place] = velocity[0] *
+                                      gamestate->rules.projectileSpeed;
+    projectiles->velocity[1][place] = velocity[1] *
+                                      gamestate->rules.projectileSpeed;
+    projectiles->velocity[2][place] = velocity[2] *
+                                      gamestate->rules.projectileSpeed;
     
     // Set the projectile's position
-    projectile->position[0] = player->headPosition[0];
-    projectile->position[1] = player->headPosition[1] +  0.5 *
+    projectiles->position[0][place] = player->headPosition[0];
+    projectiles->position[1][place] = player->headPosition[1] +  0.5 *
     gamestate->landscape->gridDivisionWidth; // TODO: refine this;
-    projectile->position[2] = player->headPosition[2];
+    projectiles->position[2][place] = player->headPosition[2];
     
     // Set the projectile's radius
-    projectile->radius = gamestate->landscape->gridDivisionWidth;
+    projectiles->radius[place] = gamestate->landscape->gridDivisionWidth;
+    
+    // Send it on its way, from where it is at the speed it's going
+    ObjectPool_launch( projectiles, place );
     
     // Set it in the gamestate
-    if( player_id == 1 )
-        gamestate->player1_projectile = projectile;
-    else
-        gamestate->player2_projectile = projectile;
+    gamestate->playerProjectiles[player->number] = handle;
+    
+    event = new_event( gamestate, EVENT_FIRE, player );
+    EventBus_publish( gamestate->events, &event );
     
     return 1;
 }
 
+void grow_player( GameState* gamestate, int player_id, float divisions )
+{
+    Player* player = GameState_player( gamestate, player_id );
+    
+    if( player == NULL )
+        return;
+    
+    player->maxLength += divisions * gamestate->landscape->gridDivisionWidth;
+}
+
 void
-change_player_direction( int player_id, Turn dir )
+change_player_direction( GameState* gamestate, int player_id, Turn dir )
 {
-    Player* player = NULL;
+    Player* player = GameState_player( gamestate, player_id );
+    Event event;
 
-    if( player_id == 1 )
-    {
-        player = gamestate->player1;
-    }
-    else if( player_id == 2 )
-    {
-        player = gamestate->player2;
-    }
+    if( player == NULL )
+        return;
     
     /* Note: a cursory glance at the logic below will show that the directions
      * are all back to front. This is deliberate.
@@ -294,94 +313,130 @@ change_player_direction( int player_id, Turn dir )
         if( dir == TURN_RIGHT )
         {
             player->nextDir = DIRECTION_WEST;
-            printf("Player direction now west\n");
         }
         else
         {
             player->nextDir = DIRECTION_EAST;
-            printf("Player direction now east\n");
         }
         break;
     case DIRECTION_SOUTH:
         if( dir == TURN_RIGHT )
         {
             player->nextDir = DIRECTION_EAST;
-            printf("Player direction now east\n");
         }
         else
         {
             player->nextDir = DIRECTION_WEST;
-            printf("Player direction now west\n");
         }
         break;
     case DIRECTION_EAST:
         if( dir == TURN_RIGHT )
         {
             player->nextDir = DIRECTION_NORTH;
-            printf("Player direction now north\n");
         }
         else
         {
             player->nextDir = DIRECTION_SOUTH;
-            printf("Player direction now south\n");
         }
         break;
     case DIRECTION_WEST:
         if( dir == TURN_RIGHT )
         {
             player->nextDir = DIRECTION_SOUTH;
-            printf("Player direction now south\n");
         }
         else
         {
             player->nextDir = DIRECTION_NORTH;
-            printf("Player direction now north\n");
         }
         break;
     }
+    
+    event = new_event( gamestate, EVENT_TURN, player );
+    event.direction = player->nextDir;
+    EventBus_publish( gamestate->events, &event );
 }
 
-void pause_game(){
+void perform_action( GameState* gamestate, int player_id, Action action )
+{
+    switch( action )
+    {
+    case ACTION_TURN_LEFT:
+        change_player_direction( gamestate, player_id, TURN_LEFT );
+        break;
+    case ACTION_TURN_RIGHT:
+        change_player_direction( gamestate, player_id, TURN_RIGHT );
+        break;
+    case ACTION_FIRE:
+        fire_player_weapon( gamestate, player_id );
+        break;
+    case ACTION_GROW:
+        grow_player( gamestate, player_id, ACTION_GROWTH );
+        break;
+    }
+}
+
+void pause_game( GameState* gamestate ){
     gamestate->mode = MODE_PAUSED;
 }
 
-void resume_game(){
+void resume_game( GameState* gamestate ){
     gamestate->mode = MODE_RUNNING;
 }
 
-int is_paused(){
+int is_paused( GameState* gamestate ){
     return gamestate->mode == MODE_PAUSED;
 }
 
-GameState* get_gamestate()
-{
-    return gamestate;
-}
 
 
 /******************************************************************************
  * PRIVATE FUNCTIONS
  ******************************************************************************/
-void initialize_player( Player* player, int row, int column, Direction dir )
+/**
+ * Starts the players along the south and north edges, moving in, taking
+ * turns: player 1 on the south, player 2 on the north, player 3 on the
+ * south... Each side's players are spread evenly along it, so two players
+ * start in the middle of opposite sides.
+ */
+void initialize_players( GameState* gamestate )
+{
+    int width = gamestate->landscape->gridWidth,
+        count = gamestate->playerCount, i, side, players_on_side;
+    
+    for( i = 0; i < count; i++ )
+    {
+        side = i % 2;
+        players_on_side = (count + 1 - side) / 2;
+        initialize_player( gamestate, gamestate->players[i],
+                           (i / 2 + 1) * width / (players_on_side + 1),
+                           side == 0 ? 0 : width - 1,
+                           side == 0 ? DIRECTION_NORTH : DIRECTION_SOUTH );
+    }
+}
+
+void initialize_player( GameState* gamestate, Player* player,
+                        int row, int column, Direction dir )
 {
     // Set the player's direction
     player->currentDir = player->nextDir = dir;
     
     // Set the player's maximum length to five divisions
-    player->maxLength = gamestate->landscape->gridDivisionWidth * PLAYER_INITIAL_LENGTH;
+    player->maxLength = gamestate->landscape->gridDivisionWidth *
+                        gamestate->rules.playerInitialLength;
     
     // Set their radius
-    player->radius = gamestate->landscape->gridDivisionWidth * PLAYER_RADIUS;
+    player->radius = gamestate->landscape->gridDivisionWidth *
+                     gamestate->rules.playerRadius;
     
     // Set their initial point
-    player->head = player->tail =
-        Body_new( row, column,
-                  gamestate->landscape->pointMap[row][column][0],
-                  gamestate->landscape->pointMap[row][column][1],
-                  gamestate->landscape->pointMap[row][column][2] );
+    player->jointsLaid = 0;
+    Player_clearJoints(player);
+    Player_pushJoint( player, row, column, gamestate->landscape );
+    OccupancyGrid_enter( gamestate->occupancy, row, column, player->number,
+                         0 );
     
     // Set their next point
-    set_next_point(player);
+    set_next_point(gamestate, player);
     
     // Set their head and tail offsets
     player->headOffset = 0.0f;
@@ -392,7 +447,7 @@ void initialize_player( Player* player, int row, int column, Direction dir )
     
     // Update the player. That is, recalculate their head and tail positions,
     // as well as their forward and up vectors.
-    update_player_positions(player);
+    update_player_positions(gamestate, player);
 }
 
 /**
@@ -401,9 +456,9 @@ void initialize_player( Player* player, int row, int column, Direction dir )
  * 
  * Takes as parameter the player whose properties are being set.
  */
-int set_next_point( Player* player )
+int set_next_point( GameState* gamestate, Player* player )
 {
-    int next_point[2];
+    int next_point[2], *head = Player_joint( player, 0 );
     Landscape* landscape = gamestate->landscape;
     
     // Change their direction
@@ -415,20 +470,20 @@ int set_next_point( Player* player )
     switch( player->currentDir )
     {
     case DIRECTION_NORTH:
-        next_point[0] = player->head->gridPosition[0];
-        next_point[1] = player->head->gridPosition[1] + 1;
+        next_point[0] = head[0];
+        next_point[1] = head[1] + 1;
         break;
     case DIRECTION_SOUTH:
-        next_point[0] = player->head->gridPosition[0];
-        next_point[1] = player->head->gridPosition[1] - 1;
+        next_point[0] = head[0];
+        next_point[1] = head[1] - 1;
         break;
     case DIRECTION_EAST:
-        next_point[0] = player->head->gridPosition[0] + 1;
-        next_point[1] = player->head->gridPosition[1];
+        next_point[0] = head[0] + 1;
+        next_point[1] = head[1];
         break;
     case DIRECTION_WEST:
-        next_point[0] = player->head->gridPosition[0] - 1;
-        next_point[1] = player->head->gridPosition[1];
+        next_point[0] = head[0] - 1;
+        next_point[1] = head[1];
         break;
     }
     
@@ -437,37 +492,42 @@ int set_next_point( Player* player )
      * calculate their forward vector if they're on an edge heading out. */
     if( next_point[0] < 0 )
     {
-        return player_wall_collision(player, DIRECTION_WEST);
+        return player_wall_collision(gamestate, player, DIRECTION_WEST);
     }
     else if( next_point[0] >= landscape->gridWidth )
     {
-        return player_wall_collision(player, DIRECTION_EAST);
+        return player_wall_collision(gamestate, player, DIRECTION_EAST);
     }
     if( next_point[1] < 0 )
     {
-        return player_wall_collision(player, DIRECTION_SOUTH);
+        return player_wall_collision(gamestate, player, DIRECTION_SOUTH);
     }
     else if( next_point[1] >= landscape->gridWidth )
     {
-        return player_wall_collision(player, DIRECTION_NORTH);
+        return player_wall_collision(gamestate, player, DIRECTION_NORTH);
     }
     
-    // Create the new body segment
-    Body_push( Body_new( next_point[0],next_point[1],
-         gamestate->landscape->pointMap[next_point[0]][next_point[1]][0],
-         gamestate->landscape->pointMap[next_point[0]][next_point[1]][1],
-         gamestate->landscape->pointMap[next_point[0]][next_point[1]][2] ),
-         &(player->head) );
+    // Lay the new joint
+    Player_pushJoint( player, next_point[0], next_point[1], landscape );
+    OccupancyGrid_enter( gamestate->occupancy, next_point[0], next_point[1],
+                         player->number, player->jointsLaid - 1 );
     
     return 1;
 }
 
-void update_players( int delta )
+void update_players( GameState* gamestate, float delta )
 {
-    move_player(gamestate->player1, delta);
-    update_player_positions(gamestate->player1);
-    move_player(gamestate->player2, delta);
-    update_player_positions(gamestate->player2);
+    Player* player;
+    int i;
+    
+    for( i = 0; i < gamestate->playerCount; i++ )
+    {
+        player = gamestate->players[i];
+        if( player->out )
+            continue;
+        move_player(gamestate, player, delta);
+        update_player_positions(gamestate, player);
+    }
 }
 
 /**
@@ -476,47 +536,52 @@ void update_players( int delta )
  * `player` gives the player who is colliding, and wall gives the wall they're
  * colliding with.
  */
-int player_wall_collision( Player* player, Direction wall )
+int player_wall_collision( GameState* gamestate, Player* player,
+                           Direction wall )
 {
-    // Reverse their direction, and put them back on a viable grid coordinate
+    int* head = Player_joint( player, 0 );
+    Event event;
+    
+    OccupancyGrid_leave( gamestate->occupancy, head[0], head[1],
+                         player->number );
     
     // Reverse their direction, and put them back on a viable grid coordinate
     if( player->currentDir == DIRECTION_NORTH )
     {
         player->currentDir = player->nextDir = DIRECTION_SOUTH;
-        player->head->gridPosition[1]--;
+        head[1]--;
     }
     else if( player->currentDir == DIRECTION_EAST )
     {
         player->currentDir = player->nextDir = DIRECTION_WEST;
-        player->head->gridPosition[0]--;
+        head[0]--;
     }
     else if( player->currentDir == DIRECTION_SOUTH )
     {
         player->currentDir = player->nextDir = DIRECTION_NORTH;   
-        player->head->gridPosition[1]++;
+        head[1]++;
     }
     else if( player->currentDir == DIRECTION_WEST )
     {
         player->currentDir = player->nextDir = DIRECTION_EAST;
-        player->head->gridPosition[0]++;
+        head[0]++;
     }
+    OccupancyGrid_enter( gamestate->occupancy, head[0], head[1],
+                         player->number, player->jointsLaid - 1 );
     
     // Put them on the opposite side of the map
     player->underGround = !player->underGround;
     
     // TODO: this is not enough to make them go underground without errors
-    printf("Player %d wins! (Player %d crashed into a wall)\n",
-           player == gamestate->player1 ? 2 : 1,
-           player == gamestate->player1 ? 1 : 2 );
-    
-    print_score();
+    event = new_event( gamestate, EVENT_COLLIDE, player );
+    event.collision.with = COLLISION_WALL;
+    event.collision.other = 0;
+    EventBus_publish( gamestate->events, &event );
     
-    gamestate->mode = MODE_FINISHED;
-    return 0;
+    return eliminate_player(gamestate, player);
 }
 
-void move_player( Player* player, int delta )
+void move_player( GameState* gamestate, Player* player, float delta )
 {    
     /* Algorithm for moving the player:
      *    1. Find the amount to move them (speed x delta)
@@ -546,6 +611,7 @@ void move_player( Player* player, int delta )
     // Speed is fixed for both players
     float amount_moved = 0;
     float distance;
+    int* tail;
     
     // While we still have to move them
     while( amount_to_move > 0 )
@@ -554,21 +620,21 @@ void move_player( Player* player, int delta )
         amount_moved = 0;
         
         // Work out how far to the next point
-        distance = distance_to_next_point(player);
+        distance = distance_to_next_point(gamestate, player);
         
         // If the amount we need to move them is more than the distance to the
         // next point
         if( amount_to_move > distance )
         {
             // Check for collisions
-            if( !test_player_collisions(player, distance) )
+            if( !test_player_collisions(gamestate, player, distance) )
             {
                 return;
             }
             // Set the amount moved
             amount_moved = distance;
             // Set the next point the player will hit, if we can
-            if( !set_next_point(player) )
+            if( !set_next_point(gamestate, player) )
             {
                 return;
             }
@@ -580,7 +646,7 @@ void move_player( Player* player, int delta )
         else
         {
             // Check for collisions
-            if( !test_player_collisions(player, distance) )
+            if( !test_player_collisions(gamestate, player, distance) )
             {
                 return;
             }
@@ -591,7 +657,7 @@ void move_player( Player* player, int delta )
         }
         
         // Test for collisions
-        //test_player_collisions( player, amount_moved );
+        //test_player_collisions( gamestate, player, amount_moved );
         
         // Increase the player's length by the amount we moved the head
         player->length += amount_moved;
@@ -620,9 +686,10 @@ void move_player( Player* player, int delta )
                 // Set the offset to maximum
                 player->tailOffset = gamestate->landscape->gridDivisionDepth;//TODO
                 // Pop the last point off the tail
-                player->tail = player->tail->previous;
-                Body_delete(player->tail->next);
-                player->tail->next = NULL;
+                tail = Player_joint( player, player->jointCount - 1 );
+                OccupancyGrid_leave( gamestate->occupancy, tail[0], tail[1],
+                                     player->number );
+                Player_popJoint(player);
             }
         }
         
@@ -631,94 +698,229 @@ void move_player( Player* player, int delta )
     }
 }
 
-int test_player_collisions( Player* player, float movement )
+int test_player_collisions( GameState* gamestate, Player* player,
+                            float movement )
+{
+    long long start = PROFILE_BEGIN();
+    int result = check_player_collisions( gamestate, player, movement );
+
+    PROFILE_END( PROFILE_COLLISIONS, start );
+    return result;
+}
+
+int check_player_collisions( GameState* gamestate, Player* player,
+                             float movement )
 {
     // Construct the line from the player's current position to where they will
     // be after the movement
-    Point before, after;
-    Player* other = (player == gamestate->player1 ? gamestate->player2 :
-                                                    gamestate->player1);
-    
-    after[0] = before[0] = player->headPosition[0];
-    after[1] = before[1] = player->headPosition[1];
-    after[2] = before[2] = player->headPosition[2];
+    Point after, food;
+    ObjectPool* edibles = gamestate->edibles;
+    int edible = ObjectPool_find( edibles, gamestate->edible );
+    Player* other;
+    Occupant* occupant;
+    int* joint;
+    
+    after[0] = player->headPosition[0];
+    after[1] = player->headPosition[1];
+    after[2] = player->headPosition[2];
     // The player's new head position
-    calculate_offset_position( player->currentDir, after,
+    calculate_offset_position( gamestate, player->currentDir, after,
                                movement,
                                player->headPosition,
-                               player->head->position );
+                               Player_jointPosition( player, 0,
+                                                     gamestate->landscape ) );
     
     // See if they're going to hit the food
     // (Need the distance between a point and a line)
-    float distance = distance_between_points( after, gamestate->edible->position );
-    if( distance < player->radius + gamestate->edible->radius )
+    if( edible >= 0 )
     {
-        return player_food_collision(player);
+        food[0] = edibles->position[0][edible];
+        food[1] = edibles->position[1][edible];
+        food[2] = edibles->position[2][edible];
+        if( distance_between_points( after, food ) <
+                player->radius + edibles->radius[edible] )
+        {
+            return player_food_collision(gamestate, player);
+        }
     }
     
-    // See if they're going to hit the other player's head
-    distance = distance_between_points( after, other->headPosition );
-    if( distance < 
-        player->radius * 2.0 )
+    // See if they're going to hit another player's head
+    other = head_near( gamestate, player, after );
+    if( other != NULL )
     {
         // Head on collision
-        return player_player_collision(1);
+        return player_player_collision(gamestate, player, other, 1);
     }
     
-    // See if they're going to hit the other player's body
-    Body *body;
-     
-    body = other->head->next;
-    
-    while( body->next != other->tail && body->next != NULL )
+    /* See if they're going to hit another player's body. The occupancy
+     * grid knows whose joints are at each point, so this takes a lookup,
+     * however long and however many the players are. */
+    // The point they've just left, against the other players' joints (not
+    // counting their heads', or the two at the end of their tails)
+    joint = Player_joint( player, 1 );
+    for( occupant = OccupancyGrid_first( gamestate->occupancy, joint[0],
+                                         joint[1] );
+         occupant != NULL;
+         occupant = OccupancyGrid_next( gamestate->occupancy, occupant ) )
     {
-        
-        /*distToBody = dist_line_to_line( body->position,
-                                        body->next->position,
-                                        before,
-                                        after );
-        if( distToBody < radius )
-            return player_player_collision(0);*/
-        
-        if( player->head->next->position[0] == body->position[0] &&
-            player->head->next->position[1] == body->position[1] && 
-            player->head->next->position[2] == body->position[2] )
+        other = gamestate->players[occupant->player];
+        if( other != player &&
+            body_occupies( gamestate, other, joint[0], joint[1], 1, 2 ) )
         {
-            return player_player_collision(0);
+            return player_player_collision(gamestate, player, other, 0);
         }
-        
-        body = body->next;
     }
     
-    body = player->head->next;
-        
-    while( body->next != other->tail && body->next != NULL )
+    // The point they're heading for, against their own joints (not counting
+    // the head's, or the tail's)
+    if( body_occupies( gamestate, player, Player_joint( player, 0 )[0],
+                       Player_joint( player, 0 )[1], 1, 1 ) )
     {
-        
-        /*distToBody = dist_line_to_line( body->position,
-                                        body->next->position,
-                                        before,
-                                        after );
-        if( distToBody < radius )
-            return player_player_collision(0);*/
-        
-        if( after[0] == body->position[0] && 
-            after[1] == body->position[1] && 
-            after[2] == body->position[2] )
+        return player_player_collision(gamestate, player, player, 0);
+    }
+    
+    return 1;
+}
+
+/**
+ * Returns the first of the other players whose head is within two radii of
+ * `position` (where the player's head is about to be), or NULL if none is.
+ * The heads hash gives the heads near it, so this doesn't look at every
+ * player.
+ */
+Player* head_near( GameState* gamestate, Player* player, Point position )
+{
+    SpatialHashQuery query;
+    Player* other, *first = NULL;
+    int i;
+    
+    for( i = SpatialHash_first( gamestate->heads, &query, position[0],
+                                position[2], player->radius * 2.0 );
+         i >= 0; i = SpatialHash_next( gamestate->heads, &query ) )
+    {
+        other = gamestate->players[i];
+        // The hash gives them in no particular order, so take the first by
+        // number, whatever order they're found in
+        if( other == player || ( first != NULL && i > first->number ) )
+            continue;
+        if( distance_between_points( position, other->headPosition ) <
+            player->radius * 2.0 )
         {
-            return player_player_collision(0);
+            first = other;
         }
-        
-        body = body->next;
     }
     
-    return 1;
+    return first;
+}
+
+/**
+ * Returns true if one of the player's joints is at the given grid point, not
+ * counting the newest `skip_newest` and oldest `skip_oldest` joints.
+ */
+int body_occupies( GameState* gamestate, Player* player, int row, int column,
+                   int skip_newest, int skip_oldest )
+{
+    Occupant* occupant = OccupancyGrid_at( gamestate->occupancy, row, column,
+                                           player->number );
+    int* joint;
+    int count, i;
+    
+    if( occupant == NULL )
+        return 0;
+    count = occupant->count;
+    
+    // Take away the skipped joints that are at the point, not counting any
+    // twice if the newest and oldest overlap
+    if( skip_newest > player->jointCount )
+        skip_newest = player->jointCount;
+    if( skip_oldest > player->jointCount - skip_newest )
+        skip_oldest = player->jointCount - skip_newest;
+    for( i = 0; i < skip_newest; i++ )
+    {
+        joint = Player_joint( player, i );
+        count -= joint[0] == row && joint[1] == column;
+    }
+    for( i = player->jointCount - skip_oldest; i < player->jointCount; i++ )
+    {
+        joint = Player_joint( player, i );
+        count -= joint[0] == row && joint[1] == column;
+    }
+    
+    return count > 0;
+}
+
+/**
+ * Takes a player out of the game: off the occupancy grid, so that the others
+ * can pass where their body was, and out of the heads hash.
+ */
+void knock_out_player( GameState* gamestate, Player* player )
+{
+    int* joint;
+    int i;
+    
+    if( player->out )
+        return;
+    
+    for( i = 0; i < player->jointCount; i++ )
+    {
+        joint = Player_joint( player, i );
+        OccupancyGrid_leave( gamestate->occupancy, joint[0], joint[1],
+                             player->number );
+    }
+    SpatialHash_remove( gamestate->heads, player->number );
+    
+    player->out = 1;
+    gamestate->playersLeft--;
+}
+
+/**
+ * Takes a player out of the game, and ends the game if there's one player
+ * left in it, who wins, or none. Returns false, for the player to stop
+ * moving.
+ */
+int eliminate_player( GameState* gamestate, Player* player )
+{
+    Event event;
+    int i;
+    
+    knock_out_player( gamestate, player );
+    if( gamestate->playersLeft > 1 )
+        return 0;
+    
+    gamestate->winner = 0;
+    for( i = 0; i < gamestate->playerCount; i++ )
+    {
+        if( !gamestate->players[i]->out )
+            gamestate->winner = i + 1;
+    }
+    event = new_event( gamestate, EVENT_GAME_OVER, NULL );
+    event.winner = gamestate->winner;
+    EventBus_publish( gamestate->events, &event );
+    
+    publish_scores(gamestate);
+    gamestate->mode = MODE_FINISHED;
+    return 0;
+}
+
+/**
+ * Returns the number of points across a landscape grid of at least `points`
+ * points: one more than a power of two, as the landscape's generated by
+ * halving its grid.
+ */
+int grid_size( int points )
+{
+    int size = 2;
+    
+    while( size + 1 < points )
+        size *= 2;
+    
+    return size + 1;
 }
 
 /**
  * Calculates the distance to the next point from a players current position.
  */
-float distance_to_next_point( Player* player )
+float distance_to_next_point( GameState* gamestate, Player* player )
 {
     float distance, distance_travelled;
     
@@ -741,24 +943,34 @@ float distance_to_next_point( Player* player )
  * Called to indicate that a player has collided with another player, or
  * themself.
  * 
- * This function indicates that `player1` has collided with `player2`.
- * The parameter `head_on` indicates a head on collision, where both players
- * should be penalised.
+ * This function indicates that `player` has collided with the body of
+ * `other` (who may be themself), and is out. The parameter `head_on`
+ * indicates a head on collision with `other`, where both players should be
+ * penalised, and neither wins.
  */
-int player_player_collision( int head_on )
+int player_player_collision( GameState* gamestate, Player* player,
+                             Player* other, int head_on )
 {
+    Event event = new_event( gamestate, EVENT_COLLIDE, player );
+    
+    event.collision.other = other->number + 1;
     if( head_on )
     {
-        printf("Players collided head on!\n(You guys suck)\n");
+        event.collision.with = COLLISION_HEAD_ON;
+        knock_out_player( gamestate, other );
+    }
+    else if( other == player )
+    {
+        event.collision.with = COLLISION_OWN_BODY;
+        event.collision.other = 0;
     }
     else
     {
-        printf("Player hit the body of another player\n");
+        event.collision.with = COLLISION_BODY;
     }
+    EventBus_publish( gamestate->events, &event );
     
-    print_score();
-    gamestate->mode = MODE_FINISHED;
-    return 0;
+    return eliminate_player(gamestate, player);
 }
 
 /**
@@ -766,21 +978,32 @@ int player_player_collision( int head_on )
  * 
  * The purpose of this function is to update a player's head and tail positions.
  */
-void update_player_positions( Player* player )
+void update_player_positions( GameState* gamestate, Player* player )
 {
-    calculate_offset_position( player->currentDir, player->headPosition,
-                               player->headOffset,
-                               player->head->next->position,
-                               player->head->position );
-    calculate_offset_position( player->currentDir, player->tailPosition,
-                                   player->tailOffset,
-                                   player->tail->previous->position,
-                                   player->tail->position );
+    Landscape* landscape = gamestate->landscape;
+    
+    calculate_offset_position( gamestate, player->currentDir,
+                               player->headPosition, player->headOffset,
+                               Player_jointPosition( player, 1, landscape ),
+                               Player_jointPosition( player, 0, landscape ) );
+    calculate_offset_position( gamestate, player->currentDir,
+                                   player->tailPosition, player->tailOffset,
+                                   Player_jointPosition( player,
+                                       player->jointCount - 2, landscape ),
+                                   Player_jointPosition( player,
+                                       player->jointCount - 1, landscape ) );
     set_player_forward_vector( player, gamestate->landscape );
+    
+    if( !player->out )
+    {
+        SpatialHash_place( gamestate->heads, player->number,
+                           player->headPosition[0], player->headPosition[2] );
+    }
 }
 
-void calculate_offset_position( Direction dir, float position[3],
-                                float offset, float from[3], float to[3] )
+void calculate_offset_position( GameState* gamestate, Direction dir,
+                                float position[3], float offset,
+                                float from[3], float to[3] )
 {
     float scalar;
     
@@ -802,10 +1025,10 @@ void set_player_forward_vector( Player* player, Landscape* landscape )
 {
     int next_row, next_col, last_row, last_col;
     
-    next_row = player->head->gridPosition[0];
-    next_col = player->head->gridPosition[1];
-    last_row = player->head->next->gridPosition[0];
-    last_col = player->head->next->gridPosition[1];
+    next_row = Player_joint( player, 0 )[0];
+    next_col = Player_joint( player, 0 )[1];
+    last_row = Player_joint( player, 1 )[0];
+    last_col = Player_joint( player, 1 )[1];
     
     player->forward[0] = landscape->pointMap[next_row][next_col][0] -
                          landscape->pointMap[last_row][last_col][0];
@@ -837,7 +1060,7 @@ void set_player_up_vector( Player* player )
     }
 }
 
-void clear_gamestate()
+void clear_gamestate( GameState* gamestate )
 {
     // Clear the players
     GameState_clearPlayers(gamestate);
@@ -847,120 +1070,169 @@ void clear_gamestate()
     GameState_clearEdibles(gamestate);
     // Destroy the landscape
     Landscape_delete( gamestate->landscape );
+    OccupancyGrid_delete( gamestate->occupancy );
+    gamestate->landscape = NULL;
+    gamestate->occupancy = NULL;
 }
 
-void generate_edible()
+void generate_edible( GameState* gamestate )
 {
     // Create a new edible at a random grid location
-    int row, column;
-    Edible* edible = gamestate->edible = Object_new();
+    int row, column, place;
+    ObjectPool* edibles = gamestate->edibles;
+    
+    gamestate->edible = ObjectPool_spawn( edibles, OBJECT_EDIBLE, -1 );
+    place = ObjectPool_find( edibles, gamestate->edible );
+    if( place < 0 )
+        return;
     
     // Generate random coordinates
-    row = bounded_random(0, gamestate->landscape->gridWidth);
-    column = bounded_random(0, gamestate->landscape->gridWidth);
-    
-    edible->position[0] = gamestate->landscape->pointMap[row][column][0];
-    edible->position[1] = gamestate->landscape->pointMap[row][column][1];
-    edible->position[2] = gamestate->landscape->pointMap[row][column][2];
-    edible->position[1] += INITIAL_FOOD_HEIGHT;
-    edible->radius = gamestate->landscape->gridDivisionWidth * FOOD_RADIUS;
-}
-
-void update_projectiles( int delta )
-{
-    update_projectile(gamestate->player1_projectile, delta);
-    update_projectile(gamestate->player2_projectile, delta);
+    row = bounded_random( &gamestate->foodRandom, 0,
+                          gamestate->landscape->gridWidth );
+    column = bounded_random( &gamestate->foodRandom, 0,
+                             gamestate->landscape->gridWidth );
+    
+    edibles->position[0][place] =
+        gamestate->landscape->pointMap[row][column][0];
+    edibles->position[1][place] =
+        gamestate->landscape->pointMap[row][column][1];
+    edibles->position[2][place] =
+        gamestate->landscape->pointMap[row][column][2];
+    edibles->position[1][place] += INITIAL_FOOD_HEIGHT;
+    edibles->radius[place] = gamestate->landscape->gridDivisionWidth *
+                             gamestate->rules.foodRadius;
 }
 
-void update_projectile( Projectile* projectile, int delta )
+/**
+ * Moves all of the projectiles on together, a step at a time over the whole
+ * pool, rather than one projectile at a time: those that have left the
+ * landscape are despawned, those whose flight meets the ground during the
+ * step explode where it does, and the rest all fly on.
+ */
+void update_projectiles( GameState* gamestate, float delta )
 {
-    float height;
+    ObjectPool* projectiles = gamestate->projectiles;
+    Direction wall;
+    Point impact;
+    float hit;
+    int i, axis;
+    
+    if( projectiles->live == 0 )
+        return;
     
-    if( projectile != NULL )
+    // Check that they're within the boundaries of the landscape
+    for( i = 0; i < projectiles->count; i++ )
     {
-        // Check that it's within the boundaries of the landscape
-        if( projectile->position[0] < gamestate->landscape->westBound )
-        {
-            projectile_wall_collision( projectile, DIRECTION_WEST );
-            return;
-        }
-        else if( projectile->position[0] > gamestate->landscape->eastBound )
-        {
-            projectile_wall_collision( projectile, DIRECTION_EAST );
-            return;
-        }
-        if( projectile->position[2] < gamestate->landscape->southBound )
+        if( ObjectPool_isLive( projectiles, i ) &&
+            projectile_outside( gamestate, i, &wall ) )
         {
-            projectile_wall_collision( projectile, DIRECTION_SOUTH );
-            return;
+            projectile_wall_collision( gamestate, i, wall );
         }
-        else if( projectile->position[2] > gamestate->landscape->northBound )
-        {
-            projectile_wall_collision( projectile, DIRECTION_NORTH );
-            return;
-        }
-        
-        // The height of the landscape at the projectile's location
-        height = Landscape_getHeight( gamestate->landscape,
-                                      projectile->position[0],
-                                      projectile->position[2] );
-        
-        // Apply gravity to the projectile
-        apply_gravity( projectile, delta );
-        
-        // Apply its velocity
-        apply_object_velocity( projectile, delta );
-        
-        // If it is below ground level, deform the landscape
-        if( projectile->position[1] <= height )
+    }
+    
+    // If any meet the ground during the step, however long it is, put them
+    // where they first touch it and deform the landscape there
+    for( i = 0; i < projectiles->count; i++ )
+    {
+        if( ObjectPool_isLive( projectiles, i ) &&
+            projectile_landing( gamestate, i, delta, &hit ) )
         {
-            projectile_landscape_collision( projectile,
+            ObjectPool_arcAt( projectiles, i, GRAVITY, hit, impact );
+            for( axis = 0; axis < 3; axis++ )
+                projectiles->position[axis][i] = impact[axis];
+            projectile_landscape_collision( gamestate, i,
                                             gamestate->landscape );
         }
-        
-        //if( distance_between_points(player->head->position) )
     }
+    
+    // Move the rest along their arcs
+    ObjectPool_fly( projectiles, GRAVITY, delta );
+    
+    ObjectPool_compact(projectiles);
 }
 
-void update_food( int delta )
+/**
+ * Returns true if the projectile at `place` is beyond one of the landscape's
+ * walls, setting `wall` to which.
+ */
+int projectile_outside( GameState* gamestate, int place, Direction* wall )
 {
-    // If there's no food, don't update it
-    if( gamestate->edible == NULL )
-        return;
-    
-    // Apply gravity
-    apply_gravity(gamestate->edible, delta);
-    
-    // Move the object
-    apply_object_velocity( gamestate->edible, delta );
+    Landscape* landscape = gamestate->landscape;
+    float X = gamestate->projectiles->position[0][place],
+          Z = gamestate->projectiles->position[2][place];
+    
+    if( X < landscape->westBound )
+        *wall = DIRECTION_WEST;
+    else if( X > landscape->eastBound )
+        *wall = DIRECTION_EAST;
+    else if( Z < landscape->southBound )
+        *wall = DIRECTION_SOUTH;
+    else if( Z > landscape->northBound )
+        *wall = DIRECTION_NORTH;
+    else
+        return 0;
     
-    // If it's below ground level, it has collided with the landscape
-    if( gamestate->edible->position[1] <= 
-            Landscape_getHeight(gamestate->landscape,
-                                gamestate->edible->position[0],
-                                gamestate->edible->position[2]) )
-    {
-        edible_landscape_collision( gamestate->edible, gamestate->landscape );
-    }
+    return 1;
 }
 
-void apply_gravity( Object* object, int delta )
+/**
+ * Returns true if the projectile at `place` meets the ground in the next
+ * `delta` milliseconds of its flight, setting `hit` to the time into its
+ * flight, in seconds, at which it does.
+ */
+int projectile_landing( GameState* gamestate, int place, float delta,
+                        float* hit )
 {
-    object->velocity[1] += GRAVITY * (delta / 1000.0f);
+    ObjectPool* projectiles = gamestate->projectiles;
+    float origin[3], velocity[3];
+    int axis;
+    
+    for( axis = 0; axis < 3; axis++ )
+    {
+        origin[axis] = projectiles->origin[axis][place];
+        velocity[axis] = projectiles->launch[axis][place];
+    }
+    
+    return Landscape_traceArc( gamestate->landscape, origin, velocity, GRAVITY,
+                               projectiles->flight[place],
+                               projectiles->flight[place] + delta / 1000.0f,
+                               hit );
 }
 
-void apply_object_velocity( Object* object, int delta )
+void update_food( GameState* gamestate, float delta )
 {
-    object->position[0] += object->velocity[0] * delta / 1000.0f;
-    object->position[1] += object->velocity[1] * delta / 1000.0f;
-    object->position[2] += object->velocity[2] * delta / 1000.0f;
+    ObjectPool* edibles = gamestate->edibles;
+    int i;
+    
+    // If there's no food, don't update it
+    if( edibles->live == 0 )
+        return;
+    
+    // Apply gravity, and move the food
+    ObjectPool_integrate( edibles, GRAVITY, delta );
+    
+    // If it's below ground level, it has collided with the landscape
+    Landscape_getHeights( gamestate->landscape, edibles->position[0],
+                          edibles->position[2], edibles->count,
+                          edibles->ground );
+    for( i = 0; i < edibles->count; i++ )
+    {
+        if( ObjectPool_isLive( edibles, i ) &&
+            edibles->position[1][i] <= edibles->ground[i] )
+        {
+            edible_landscape_collision( edibles, i );
+        }
+    }
+    
+    ObjectPool_compact(edibles);
 }
 
 /**
  * Deforms the landscape at the given X/Z coordinates.
  * Note: takes real-space coordinates, not grid coordinates.
  */
-void deform_landscape( float X, float Z, Landscape* landscape )
+void deform_landscape( GameState* gamestate, float X, float Z,
+                       Landscape* landscape )
 {
     // i should be the Row not the column, but it wasn't working right
     // useing the column is a hacky fix, 
@@ -969,17 +1241,25 @@ void deform_landscape( float X, float Z, Landscape* landscape )
     int epicentre_i = Landscape_getColumn(landscape, X);
     Point* epicentre;
     int i = 0, j = 0;
-    int i_min = epicentre_i - DEFORMATION_RADIUS * landscape->gridDivisionWidth;
-    int i_max = epicentre_i + DEFORMATION_RADIUS * landscape->gridDivisionWidth;
-    int j_min = epicentre_j - DEFORMATION_RADIUS * landscape->gridDivisionWidth;
-    int j_max = epicentre_j + DEFORMATION_RADIUS * landscape->gridDivisionWidth;
+    float radius = gamestate->rules.deformationRadius,
+          depth = gamestate->rules.deformationAmount;
+    int i_min = epicentre_i - radius * landscape->gridDivisionWidth;
+    int i_max = epicentre_i + radius * landscape->gridDivisionWidth;
+    int j_min = epicentre_j - radius * landscape->gridDivisionWidth;
+    int j_max = epicentre_j + radius * landscape->gridDivisionWidth;
     Point* point;
     float dist;
 	int dist2;
+    Event event;
     
-    epicentre = Landscape_getPoint(landscape, epicentre_i, epicentre_j);
-	if(!epicentre)
+	if(!Landscape_getPoint(landscape, epicentre_i, epicentre_j))
 		return;
+    
+    // Let anything copying the landscape know which rows are about to change.
+    // That may give the landscape new copies of them, so find the epicentre
+    // after.
+    Landscape_touchRows( landscape, i_min, i_max - 1 );
+    epicentre = Landscape_getPoint(landscape, epicentre_i, epicentre_j);
 
     for(i=i_min; i<i_max; i++){
         if( i < 0 || i > landscape->gridWidth )
@@ -993,8 +1273,8 @@ void deform_landscape( float X, float Z, Landscape* landscape )
             dist = distance_between_points(*point, *epicentre);
 			dist2 = sqrtf(powf(i - epicentre_i,2) + powf(j- epicentre_j,2));
             // to make the square defined by the iterators into a circle
-            if (dist2 <= DEFORMATION_RADIUS * landscape->gridDivisionWidth){
-                (*point)[1] -= DEFORMATION_AMOUNT * landscape->gridDivisionWidth * cosf((DEFORMATION_RADIUS * landscape->gridDivisionWidth - dist2)/DEFORMATION_RADIUS * landscape->gridDivisionWidth);
+            if (dist2 <= radius * landscape->gridDivisionWidth){
+                (*point)[1] -= depth * landscape->gridDivisionWidth * cosf((radius * landscape->gridDivisionWidth - dist2)/radius * landscape->gridDivisionWidth);
 				// this doen't actually work because the landscape is sometimes lower than min_height
                 // prevent it from deforming into a black hole
                 // if((*point)[1] < landscape->minHeight)
@@ -1012,51 +1292,65 @@ void deform_landscape( float X, float Z, Landscape* landscape )
             gamestate->landscape->normalMap[i][j][2] = (*epicentre)[2] - (*point)[2];
         }
     }
+    
+    gamestate->deformations++;
+    
+    event = new_event( gamestate, EVENT_DEFORM, NULL );
+    event.crater.X = X;
+    event.crater.Z = Z;
+    EventBus_publish( gamestate->events, &event );
+    
+    // The players' bodies lie on the landscape, so their bounds move with it
+    for( i = 0; i < gamestate->playerCount; i++ )
+        Player_refitRuns( gamestate->players[i], landscape );
 }
 
-void edible_landscape_collision( Edible* edible, Landscape* landscape )
+/**
+ * Rests the edible at `place` on the ground beneath it, which must have been
+ * found (see Landscape_getHeights).
+ */
+void edible_landscape_collision( ObjectPool* edibles, int place )
 {
-    edible->position[1] =
-        Landscape_getHeight( landscape,
-                             edible->position[0],
-                             edible->position[2] );
-    
-    edible->velocity[0] = 0;
-    edible->velocity[1] = 0;
-    edible->velocity[2] = 0;
+    edibles->position[1][place] = edibles->ground[place];
+    
+    edibles->velocity[0][place] = 0;
+    edibles->velocity[1][place] = 0;
+    edibles->velocity[2][place] = 0;
 }
 
-void projectile_landscape_collision( Projectile* projectile,
+void projectile_landscape_collision( GameState* gamestate, int place,
                                      Landscape* landscape )
 {
+    long long start;
+    
     // Deform the landscape
-    deform_landscape( projectile->position[0],
-                      projectile->position[2],
+    start = PROFILE_BEGIN();
+    deform_landscape( gamestate, gamestate->projectiles->position[0][place],
+                      gamestate->projectiles->position[2][place],
                       landscape );
+    PROFILE_END( PROFILE_DEFORMATION, start );
     
     // Destroy the projectile
-    if( projectile == gamestate->player1_projectile )
-    {
-        Projectile_delete( gamestate->player1_projectile );
-        gamestate->player1_projectile = NULL;
-    }
-    else
-    {
-        Projectile_delete( gamestate->player2_projectile );
-        gamestate->player2_projectile = NULL;
-    }
+    despawn_projectile(gamestate, place);
 }
 
-int player_food_collision( Player* player )
+int player_food_collision( GameState* gamestate, Player* player )
 {
+    Event event;
+    
     // increment the player's score
-    player->score += POINTS_FOR_FOOD;
+    player->score += gamestate->rules.pointsForFood;
     // Destroy the edible
-    Object_delete(gamestate->edible);
+    ObjectPool_despawn( gamestate->edibles, gamestate->edible );
     // Create a new edible
-    generate_edible();
+    generate_edible(gamestate);
     // Increase their length
-    player->maxLength += FOOD_LENGTH_INCREMENT * gamestate->landscape->gridDivisionWidth;
+    player->maxLength += gamestate->rules.foodLengthIncrement *
+                         gamestate->landscape->gridDivisionWidth;
+    
+    event = new_event( gamestate, EVENT_EAT, player );
+    event.score = player->score;
+    EventBus_publish( gamestate->events, &event );
     
     return 0;
 }
@@ -1064,33 +1358,60 @@ int player_food_collision( Player* player )
 /**
  * Make projectiles bounce back from the walls.
  */
-void projectile_wall_collision( Projectile* projectile, Direction wall )
+void projectile_wall_collision( GameState* gamestate, int place,
+                                Direction wall )
 {
     // Reverse its direction
     // Set its position on the edge of the wall, or otherwise ensure that it's
     // within the bounds of the landscape
     
     // For now, destroy the projectile
-    if( projectile == gamestate->player1_projectile )
-    {
-        gamestate->player1_projectile = NULL;
-    }
-    else
+    despawn_projectile(gamestate, place);
+}
+
+/**
+ * Returns a player's projectile to the pool, leaving them free to fire again.
+ */
+void despawn_projectile( GameState* gamestate, int place )
+{
+    // Projectiles belong to the player numbered by their owner
+    gamestate->playerProjectiles[gamestate->projectiles->owner[place]] =
+        OBJECT_NONE;
+    ObjectPool_despawnAt( gamestate->projectiles, place );
+}
+
+/**
+ * Publishes each player's score, at the end of a game.
+ */
+void publish_scores( GameState* gamestate )
+{
+    Event event;
+    int i;
+    
+    for( i = 0; i < gamestate->playerCount; i++ )
     {
-        gamestate->player2_projectile = NULL;
+        event = new_event( gamestate, EVENT_SCORE, gamestate->players[i] );
+        event.score = gamestate->players[i]->score;
+        EventBus_publish( gamestate->events, &event );
     }
-    
-    Object_delete(projectile);
-    
 }
 
-void print_score()
+/**
+ * Starts an event of the given type, in the gamestate's current game, that
+ * happened to `player` (or to nobody in particular, if NULL).
+ */
+Event new_event( GameState* gamestate, EventType type, Player* player )
 {
-    printf( "Player 1 score: %d\n", gamestate->player1->score );
-    printf( "Player 2 score: %d\n", gamestate->player2->score );
+    Event event;
+    
+    event.type = type;
+    event.generation = gamestate->generation;
+    event.player = player != NULL ? player->number + 1 : 0;
+    
+    return event;
 }
 
-int is_running()
+int is_running( GameState* gamestate )
 {
     return gamestate->mode == MODE_RUNNING;
 }
@@ -6,10 +6,31 @@
  * This is the only means by which user input can modify the gamestate. By
  * isolating access to the gamestate like this, we can ensure that the
  * mechanics - the fundamental game rules - which govern the game are enforced.
+ * 
+ * Every function is given the gamestate it works on, and the module keeps no
+ * state of its own, so any number of games may be played at once, each on a
+ * thread of its own.
+ * 
+ * Games are deterministic: given the same seed, rules and tick length, and
+ * the same actions at the same ticks, a game plays out the same way, down to
+ * the last bit. Its random numbers come from streams of its own (one for the
+ * terrain, one for edibles), and the world is always updated in the same
+ * order: the players in turn (player 1 first), then their projectiles, then
+ * food.
+ * 
+ * A game has as many players as its rules say. A player who crashes is out,
+ * and the game ends when there's one player left, who wins, or none.
+ * 
+ * Nothing here prints. What happens in a game is published on its
+ * gamestate's event bus (see EventBus.h), for whoever's following it to log
+ * or show, on their own threads.
  */
 
 #include "GameState.h"
 
+// How much ACTION_GROW lengthens a player, in grid divisions
+#define ACTION_GROWTH 64.0f
+
 /******************************************************************************
  * TYPEDEFS
  ******************************************************************************/
@@ -20,6 +41,13 @@ typedef enum {
     TURN_LEFT, TURN_RIGHT
 } Turn;
 
+/**
+ * Something a player can be told to do, by a script, a bot or a replay
+ */
+typedef enum {
+    ACTION_TURN_LEFT, ACTION_TURN_RIGHT, ACTION_FIRE, ACTION_GROW
+} Action;
+
 /******************************************************************************
  * MODULE FUNCTIONS
  ******************************************************************************/
@@ -32,13 +60,24 @@ void mechanics_init();
  * PLAYER MECHANICS
  *****************************************************************************/
 /**
- * Changes the player's direction.
+ * Changes the player's direction. Players are numbered from 1, here and
+ * below; numbers with no player are ignored.
  */
-void change_player_direction( int player_id, Turn dir );
+void change_player_direction( GameState* gamestate, int player_id, Turn dir );
 /**
  * Fires the player's weapon, if permitted.
  */
-int fire_player_weapon( int player_id );
+int fire_player_weapon( GameState* gamestate, int player_id );
+/**
+ * Lengthens the player by the given number of grid divisions, as if they'd
+ * eaten. Used by scripted benchmarks.
+ */
+void grow_player( GameState* gamestate, int player_id, float divisions );
+/**
+ * Has the player do what they've been told to. Growing lengthens them by
+ * ACTION_GROWTH grid divisions.
+ */
+void perform_action( GameState* gamestate, int player_id, Action action );
 
 /******************************************************************************
  * WORLD MECHANICS
@@ -46,39 +85,35 @@ int fire_player_weapon( int player_id );
 /**
  * Updates the world, given the number of milliseconds that have passed.
  */
-void update_world( int delta );
+void update_world( GameState* gamestate, float delta );
 
 /******************************************************************************
  * GAME MECHANICS
  *****************************************************************************/
 /**
- * Starts a new game, clearing the current one if already running.
+ * Starts a new game, clearing the current one if already running. A
+ * gamestate's games follow one another from its random seed.
  */
-void new_game();
+void new_game( GameState* gamestate );
 /**
  * Returns true if the game is running.
  */
-int is_running();
+int is_running( GameState* gamestate );
 /**
  * Pauses a running game.
  */
-void pause_game();
+void pause_game( GameState* gamestate );
 /**
  * Checks if the game is paused.
  */
-int is_paused();
+int is_paused( GameState* gamestate );
 /**
  * Resume game.
  */
-void resume_game();
+void resume_game( GameState* gamestate );
 /**
  * End the game.
  */
-void end_game();
-
-/*******************************************************************************
- * GAMESTATE FUNCTIONS
- ******************************************************************************/
-GameState* get_gamestate();
+void end_game( GameState* gamestate );
 
 #endif /*MECHANICS_H_*/
@@ -0,0 +1,211 @@
+#include "offscreen.h"
+#include "glext.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+/*******************************************************************************
+ * GLOBALS AND CONSTANTS
+ ******************************************************************************/
+EGLDisplay offscreen_display = EGL_NO_DISPLAY;
+EGLContext offscreen_context = EGL_NO_CONTEXT;
+
+// The framebuffer we render into, and its colour and depth buffers
+GLuint offscreen_framebuffer = 0,
+       offscreen_color_buffer = 0,
+       offscreen_depth_buffer = 0;
+
+int offscreen_width = 0,
+    offscreen_height = 0;
+
+
+/*******************************************************************************
+ * INTERNAL FUNCTION PROTOTYPES
+ ******************************************************************************/
+int create_context();
+int create_framebuffer( int width, int height );
+
+
+/*******************************************************************************
+ * PUBLIC FUNCTIONS
+ ******************************************************************************/
+int offscreen_init( int width, int height )
+{
+    if( width <= 0 || height <= 0 )
+    {
+        fprintf( stderr, "Invalid framebuffer size %dx%d\n", width, height );
+        return 0;
+    }
+
+    if( !create_context() )
+    {
+        offscreen_shutdown();
+        return 0;
+    }
+
+    if( !glext_init(eglGetProcAddress) )
+    {
+        fprintf( stderr, "Framebuffer objects are not supported\n" );
+        offscreen_shutdown();
+        return 0;
+    }
+
+    if( !create_framebuffer( width, height ) )
+    {
+        offscreen_shutdown();
+        return 0;
+    }
+
+    offscreen_width = width;
+    offscreen_height = height;
+
+    return 1;
+}
+
+void offscreen_shutdown()
+{
+    if( offscreen_context != EGL_NO_CONTEXT && glext_has_framebuffers() )
+    {
+        ext_glBindFramebuffer( GL_FRAMEBUFFER, 0 );
+        ext_glDeleteFramebuffers( 1, &offscreen_framebuffer );
+        ext_glDeleteRenderbuffers( 1, &offscreen_color_buffer );
+        ext_glDeleteRenderbuffers( 1, &offscreen_depth_buffer );
+    }
+    offscreen_framebuffer = offscreen_color_buffer =
+        offscreen_depth_buffer = 0;
+
+    if( offscreen_display != EGL_NO_DISPLAY )
+    {
+        eglMakeCurrent( offscreen_display, EGL_NO_SURFACE, EGL_NO_SURFACE,
+                        EGL_NO_CONTEXT );
+        if( offscreen_context != EGL_NO_CONTEXT )
+            eglDestroyContext( offscreen_display, offscreen_context );
+        eglTerminate( offscreen_display );
+    }
+    offscreen_context = EGL_NO_CONTEXT;
+    offscreen_display = EGL_NO_DISPLAY;
+}
+
+void offscreen_swap_buffers()
+{
+    // There's nothing to present, but the frame isn't done until the driver
+    // says so, and we want frame times to include the cost of rendering
+    glFinish();
+}
+
+int offscreen_get_width()
+{
+    return offscreen_width;
+}
+
+int offscreen_get_height()
+{
+    return offscreen_height;
+}
+
+
+/*******************************************************************************
+ * INTERNAL FUNCTIONS
+ ******************************************************************************/
+/**
+ * Creates an OpenGL context with no surface, and makes it current.
+ */
+int create_context()
+{
+    PFNEGLGETPLATFORMDISPLAYEXTPROC get_platform_display;
+    EGLConfig config;
+    EGLint config_count;
+    EGLint config_attributes[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE
+    };
+
+    get_platform_display = (PFNEGLGETPLATFORMDISPLAYEXTPROC)
+        eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if( get_platform_display == NULL )
+    {
+        fprintf( stderr, "EGL platform displays are not supported\n" );
+        return 0;
+    }
+
+    offscreen_display = get_platform_display( EGL_PLATFORM_SURFACELESS_MESA,
+                                              EGL_DEFAULT_DISPLAY, NULL );
+    if( offscreen_display == EGL_NO_DISPLAY ||
+        !eglInitialize( offscreen_display, NULL, NULL ) )
+    {
+        fprintf( stderr, "Could not open a surfaceless EGL display\n" );
+        offscreen_display = EGL_NO_DISPLAY;
+        return 0;
+    }
+
+    if( !eglBindAPI(EGL_OPENGL_API) )
+    {
+        fprintf( stderr, "Desktop OpenGL is not supported by EGL\n" );
+        return 0;
+    }
+
+    // We never render to an EGL surface, so any config will do
+    if( !eglChooseConfig( offscreen_display, config_attributes, &config, 1,
+                          &config_count ) || config_count == 0 )
+    {
+        fprintf( stderr, "No suitable EGL config\n" );
+        return 0;
+    }
+
+    offscreen_context = eglCreateContext( offscreen_display, config,
+                                          EGL_NO_CONTEXT, NULL );
+    if( offscreen_context == EGL_NO_CONTEXT )
+    {
+        fprintf( stderr, "Could not create an OpenGL context\n" );
+        return 0;
+    }
+
+    if( !eglMakeCurrent( offscreen_display, EGL_NO_SURFACE, EGL_NO_SURFACE,
+                         offscreen_context ) )
+    {
+        fprintf( stderr, "Surfaceless contexts are not supported\n" );
+        return 0;
+    }
+
+    return 1;
+}
+
+/**
+ * Creates a framebuffer with colour and depth buffers, and binds it as the
+ * default target for rendering.
+ */
+int create_framebuffer( int width, int height )
+{
+    ext_glGenRenderbuffers( 1, &offscreen_color_buffer );
+    ext_glBindRenderbuffer( GL_RENDERBUFFER, offscreen_color_buffer );
+    ext_glRenderbufferStorage( GL_RENDERBUFFER, GL_RGBA8, width, height );
+
+    ext_glGenRenderbuffers( 1, &offscreen_depth_buffer );
+    ext_glBindRenderbuffer( GL_RENDERBUFFER, offscreen_depth_buffer );
+    ext_glRenderbufferStorage( GL_RENDERBUFFER, GL_DEPTH_COMPONENT24,
+                               width, height );
+
+    ext_glGenFramebuffers( 1, &offscreen_framebuffer );
+    ext_glBindFramebuffer( GL_FRAMEBUFFER, offscreen_framebuffer );
+    ext_glFramebufferRenderbuffer( GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                                   GL_RENDERBUFFER, offscreen_color_buffer );
+    ext_glFramebufferRenderbuffer( GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
+                                   GL_RENDERBUFFER, offscreen_depth_buffer );
+
+    if( ext_glCheckFramebufferStatus(GL_FRAMEBUFFER) !=
+        GL_FRAMEBUFFER_COMPLETE )
+    {
+        fprintf( stderr, "Could not create a %dx%d framebuffer\n",
+                 width, height );
+        return 0;
+    }
+
+    // Reads and writes both go to the framebuffer's colour buffer
+    glDrawBuffer(GL_COLOR_ATTACHMENT0);
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+
+    return 1;
+}
+
@@ -0,0 +1,42 @@
+#ifndef OFFSCREEN_H_
+#define OFFSCREEN_H_
+/**
+ * offscreen.h
+ * This module provides a headless rendering backend, for machines with no
+ * display (and possibly no GPU).
+ *
+ * Instead of opening a window, it creates an OpenGL context through EGL's
+ * surfaceless platform (provided by Mesa, and backed by llvmpipe when there's
+ * no GPU), and renders into a framebuffer object the size of the "window".
+ * Everything else - rendering, viewports and so on - works exactly as it does
+ * with a window.
+ */
+
+/**
+ * Creates the OpenGL context and framebuffer, and makes them current.
+ *
+ * Returns false, having printed the reason, if this isn't possible.
+ */
+int offscreen_init( int width, int height );
+
+/**
+ * Frees the OpenGL context and framebuffer.
+ */
+void offscreen_shutdown();
+
+/**
+ * The equivalent of swapping buffers: waits for the frame to finish.
+ */
+void offscreen_swap_buffers();
+
+/**
+ * Returns the framebuffer's width.
+ */
+int offscreen_get_width();
+
+/**
+ * Returns the framebuffer's height.
+ */
+int offscreen_get_height();
+
+#endif /*OFFSCREEN_H_*/
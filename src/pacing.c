@@ -0,0 +1,183 @@
+#include "pacing.h"
+#include "glext.h"
+#include <math.h>
+#include <time.h>
+
+/*******************************************************************************
+ * GLOBALS AND CONSTANTS
+ ******************************************************************************/
+#define NANOSECONDS_PER_SECOND 1000000000LL
+#define NANOSECONDS_PER_MILLISECOND 1000000LL
+
+// How long before a frame is due to stop sleeping and start spinning
+#define SPIN_TIME 500000LL
+
+// The number of frames statistics are kept over
+#define PACING_HISTORY 120
+
+// How often the CPU utilisation is measured
+#define CPU_SAMPLE_PERIOD NANOSECONDS_PER_SECOND
+
+int target_fps = 0;
+int low_power = 0;
+
+// When the next frame is due, on the monotonic clock
+long long next_frame_time = 0;
+// When the last frame was presented
+long long last_present_time = 0;
+
+// Recent times between frames, in nanoseconds
+long long frame_times[PACING_HISTORY];
+
+// The start of the current CPU utilisation sample
+long long sample_wall_time = 0, sample_cpu_time = 0;
+
+PacingStats pacing_stats;
+
+
+/*******************************************************************************
+ * INTERNAL FUNCTION PROTOTYPES
+ ******************************************************************************/
+long long frame_period();
+long long read_clock( clockid_t clock );
+void update_statistics( long long frame_time, long long now );
+
+
+/*******************************************************************************
+ * PUBLIC FUNCTIONS
+ ******************************************************************************/
+void pacing_init( int fps, int vsync )
+{
+    target_fps = fps;
+    low_power = 0;
+
+    pacing_stats.frames = 0;
+    pacing_stats.fps = 0.0f;
+    pacing_stats.mean_ms = pacing_stats.deviation_ms = 0.0f;
+    pacing_stats.cpu_percent = 0.0f;
+    pacing_stats.vsync = vsync && glext_set_swap_interval(1);
+
+    next_frame_time = last_present_time = read_clock(CLOCK_MONOTONIC);
+    sample_wall_time = next_frame_time;
+    sample_cpu_time = read_clock(CLOCK_PROCESS_CPUTIME_ID);
+}
+
+void pacing_set_low_power( int enabled )
+{
+    // Coming out of low power, don't make the player wait out a slow frame
+    if( low_power && !enabled )
+        next_frame_time = read_clock(CLOCK_MONOTONIC);
+
+    low_power = enabled;
+}
+
+int pacing_time_to_next_frame()
+{
+    long long remaining = next_frame_time - read_clock(CLOCK_MONOTONIC);
+
+    // Wake up early enough to sleep the rest precisely
+    remaining -= SPIN_TIME;
+    if( remaining <= 0 )
+        return 0;
+
+    return remaining / NANOSECONDS_PER_MILLISECOND;
+}
+
+void pacing_wait()
+{
+    struct timespec until;
+    long long sleep_until = next_frame_time - SPIN_TIME;
+
+    if( sleep_until > read_clock(CLOCK_MONOTONIC) )
+    {
+        until.tv_sec = sleep_until / NANOSECONDS_PER_SECOND;
+        until.tv_nsec = sleep_until % NANOSECONDS_PER_SECOND;
+        clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &until, NULL );
+    }
+
+    while( read_clock(CLOCK_MONOTONIC) < next_frame_time )
+        ;
+}
+
+void pacing_frame_presented()
+{
+    long long now = read_clock(CLOCK_MONOTONIC),
+              period = frame_period();
+
+    update_statistics( now - last_present_time, now );
+    last_present_time = now;
+
+    /* Keep to a steady beat, but if we've fallen more than a frame behind,
+     * start again from now rather than rushing out frames to catch up */
+    next_frame_time += period;
+    if( next_frame_time < now - period || next_frame_time > now + period )
+        next_frame_time = now + period;
+}
+
+PacingStats* pacing_get_stats()
+{
+    return &pacing_stats;
+}
+
+
+/*******************************************************************************
+ * INTERNAL FUNCTIONS
+ ******************************************************************************/
+/**
+ * Returns the time between frames, in nanoseconds.
+ */
+long long frame_period()
+{
+    if( low_power )
+        return NANOSECONDS_PER_SECOND / LOW_POWER_FPS;
+    // Vsync paces the frames by itself
+    if( target_fps <= 0 || pacing_stats.vsync )
+        return 0;
+
+    return NANOSECONDS_PER_SECOND / target_fps;
+}
+
+long long read_clock( clockid_t clock )
+{
+    struct timespec now;
+
+    clock_gettime( clock, &now );
+
+    return now.tv_sec * NANOSECONDS_PER_SECOND + now.tv_nsec;
+}
+
+void update_statistics( long long frame_time, long long now )
+{
+    long long cpu_time;
+    double mean = 0.0, variance = 0.0;
+    int i, count;
+
+    frame_times[pacing_stats.frames % PACING_HISTORY] = frame_time;
+    pacing_stats.frames++;
+
+    count = pacing_stats.frames < PACING_HISTORY ?
+            pacing_stats.frames : PACING_HISTORY;
+    for( i = 0; i < count; i++ )
+    {
+        mean += frame_times[i];
+    }
+    mean /= count;
+    for( i = 0; i < count; i++ )
+    {
+        variance += (frame_times[i] - mean) * (frame_times[i] - mean);
+    }
+    variance /= count;
+
+    pacing_stats.mean_ms = mean / NANOSECONDS_PER_MILLISECOND;
+    pacing_stats.deviation_ms = sqrt(variance) / NANOSECONDS_PER_MILLISECOND;
+    pacing_stats.fps = mean > 0.0 ? NANOSECONDS_PER_SECOND / mean : 0.0f;
+
+    if( now - sample_wall_time >= CPU_SAMPLE_PERIOD )
+    {
+        cpu_time = read_clock(CLOCK_PROCESS_CPUTIME_ID);
+        pacing_stats.cpu_percent = 100.0 * (cpu_time - sample_cpu_time) /
+                                   (now - sample_wall_time);
+        sample_cpu_time = cpu_time;
+        sample_wall_time = now;
+    }
+}
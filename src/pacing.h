@@ -0,0 +1,67 @@
+#ifndef PACING_H_
+#define PACING_H_
+/**
+ * pacing.h
+ * This module decides when frames are drawn.
+ *
+ * Frames are drawn at a target rate. If vsync is available, swapping buffers
+ * waits for the display, and that paces the frames; otherwise the pacer
+ * sleeps until each frame is due. Sleeps are made with the monotonic clock,
+ * and the last fraction of a millisecond is spun, since the scheduler can't
+ * be trusted to wake us that precisely.
+ *
+ * While the game isn't being played (paused, finished, or in the menu) there's
+ * little to draw, so frames drop to a low rate to save power.
+ *
+ * The pacer also keeps statistics: the frame rate, the mean frame time and
+ * its standard deviation over the last few frames, and the proportion of a
+ * core the whole process has been using.
+ */
+
+// Frames per second while the game isn't being played
+#define LOW_POWER_FPS 10
+
+typedef struct {
+    int frames; // Frames presented so far
+    float fps; // Frames per second, over the recent frames
+    float mean_ms; // The mean time between recent frames
+    float deviation_ms; // The standard deviation of the time between them
+    float cpu_percent; // Process CPU time, as a percentage of one core
+    int vsync; // True if buffer swaps are waiting for vsync
+} PacingStats;
+
+/**
+ * Starts pacing frames at `target_fps` frames per second (0 for as fast as
+ * possible), using vsync if `vsync` is true and the driver lets us.
+ *
+ * The OpenGL context must be current, if vsync is wanted.
+ */
+void pacing_init( int target_fps, int vsync );
+
+/**
+ * Turns low power mode on or off.
+ */
+void pacing_set_low_power( int enabled );
+
+/**
+ * Returns the number of whole milliseconds until the next frame is due, which
+ * may be spent waiting for events.
+ */
+int pacing_time_to_next_frame();
+
+/**
+ * Sleeps until the next frame is due.
+ */
+void pacing_wait();
+
+/**
+ * Records that a frame has been presented.
+ */
+void pacing_frame_presented();
+
+/**
+ * Returns the statistics so far.
+ */
+PacingStats* pacing_get_stats();
+
+#endif /*PACING_H_*/
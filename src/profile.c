@@ -0,0 +1,564 @@
+#include "profile.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*******************************************************************************
+ * TYPE DEFINITIONS
+ ******************************************************************************/
+/**
+ * A timing or counter value in a trace.
+ */
+typedef struct {
+    long long start; // When the stage began, or the counter's value was taken
+    long long value; // The stage's duration, or the counter's value
+    int id; // The stage, or TRACE_COUNTER_ID plus the counter
+} TraceEvent;
+
+/**
+ * Everything recorded by one thread. Only that thread writes to it.
+ */
+typedef struct {
+    // The last timings, for the statistics
+    atomic_ullong samples[PROFILE_RING_SIZE];
+    // The number of timings ever recorded; the oldest are overwritten
+    atomic_uint count;
+
+    // The trace, allocated when the thread first traces anything
+    TraceEvent* events;
+    atomic_int eventCount;
+    atomic_int dropped; // Events that didn't fit
+    // The trace the events belong to; they're thrown away when a new one
+    // starts
+    atomic_uint traceNumber;
+
+    char name[32]; // Guarded by profile_thread_lock
+} ProfileThread;
+
+
+/*******************************************************************************
+ * GLOBALS AND CONSTANTS
+ ******************************************************************************/
+#define NANOSECONDS_PER_SECOND 1000000000LL
+#define NANOSECONDS_PER_MILLISECOND 1000000.0f
+#define NANOSECONDS_PER_MICROSECOND 1000.0
+
+// The most threads timings are kept for
+#define PROFILE_MAX_THREADS 8
+
+// How often the statistics are worked out again
+#define STATS_PERIOD (NANOSECONDS_PER_SECOND / 2)
+
+// Each timing is kept as its stage, in the top byte, and its duration in
+// nanoseconds, in the rest
+#define SAMPLE_STAGE_SHIFT 56
+#define SAMPLE_DURATION_MASK ((1ULL << SAMPLE_STAGE_SHIFT) - 1)
+
+// The most events traced on each thread; about a quarter of an hour of frames
+#define TRACE_CAPACITY (1 << 20)
+// Trace event ids from here on are counters
+#define TRACE_COUNTER_ID 256
+
+#define TRACE_PROCESS_NAME "Project 2"
+
+atomic_int profiling = 0;
+_Thread_local long long profile_allocations = 0;
+
+// Every thread that has recorded anything
+ProfileThread* profile_threads[PROFILE_MAX_THREADS];
+atomic_int profile_thread_count = 0;
+pthread_mutex_t profile_thread_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// This thread's record, once it has one
+_Thread_local ProfileThread* this_thread = NULL;
+// Set if this thread couldn't have one
+_Thread_local int untracked_thread = 0;
+
+// The statistics, and when they were last worked out
+ProfileStats profile_stats[PROFILE_STAGES];
+long long stats_time = 0;
+
+// The timings of every thread, gathered to work the statistics out from
+unsigned long long gathered_samples[PROFILE_MAX_THREADS * PROFILE_RING_SIZE];
+
+// The current trace (numbered from 1), when it started, and where it's going
+atomic_uint trace_number = 0;
+long long trace_start = 0;
+char trace_path[256];
+
+// Writes stopped traces out, so that whoever stopped them needn't wait. Set
+// while it's writing, during which the threads' traces are left alone.
+pthread_t trace_writer;
+atomic_int trace_writing = 0;
+// Whether trace_writer has been started, and not yet joined
+int trace_writer_started = 0;
+
+char* stage_names[PROFILE_STAGES] = {
+    "frame",
+    "render update",
+    "prepare frame",
+    "terrain mesh",
+    "viewport",
+    "horizon",
+    "landscape",
+    "players",
+    "objects",
+    "minimap",
+    "hud",
+    "swap",
+    "tick",
+    "update players",
+    "collisions",
+    "projectiles",
+    "deformation",
+    "food",
+    "publish",
+    "generate landscape"
+};
+
+char* counter_names[PROFILE_COUNTERS] = {
+    "segments",
+    "draw calls",
+    "vertices",
+    "occluded",
+    "allocations"
+};
+
+
+/*******************************************************************************
+ * INTERNAL FUNCTION PROTOTYPES
+ ******************************************************************************/
+ProfileThread* get_thread();
+void add_sample( ProfileThread* thread, ProfileStage stage,
+                 long long duration );
+void add_event( ProfileThread* thread, int id, long long start,
+                long long value );
+int write_trace();
+void* trace_writer_run( void* unused );
+void join_trace_writer();
+void update_stats();
+int compare_samples( const void* a, const void* b );
+
+
+/*******************************************************************************
+ * PUBLIC FUNCTIONS
+ ******************************************************************************/
+void profile_set_enabled( int enabled )
+{
+    if( enabled )
+        atomic_fetch_or( &profiling, PROFILE_STATISTICS );
+    else
+        atomic_fetch_and( &profiling, ~PROFILE_STATISTICS );
+}
+
+int profile_is_enabled()
+{
+    return (atomic_load_explicit( &profiling, memory_order_relaxed ) &
+            PROFILE_STATISTICS) != 0;
+}
+
+ProfileStats* profile_get_stats()
+{
+    long long now = profile_clock();
+
+    if( now - stats_time >= STATS_PERIOD )
+    {
+        update_stats();
+        stats_time = now;
+    }
+    return profile_stats;
+}
+
+char* profile_stage_name( ProfileStage stage )
+{
+    return stage_names[stage];
+}
+
+void profile_print_stats()
+{
+    ProfileStats* stats;
+    int i;
+
+    update_stats();
+    stats = profile_stats;
+
+    printf( "%-18s %8s %9s %9s %9s\n",
+            "Stage", "Samples", "Min ms", "Mean ms", "P99 ms" );
+    for( i = 0; i < PROFILE_STAGES; i++ )
+    {
+        if( stats[i].samples == 0 )
+            continue;
+
+        printf( "%-18s %8d %9.3f %9.3f %9.3f\n", stage_names[i],
+                stats[i].samples, stats[i].min_ms, stats[i].mean_ms,
+                stats[i].p99_ms );
+    }
+}
+
+void profile_name_thread( char* name )
+{
+    ProfileThread* thread = get_thread();
+
+    if( thread == NULL )
+        return;
+
+    pthread_mutex_lock( &profile_thread_lock );
+    strncpy( thread->name, name, sizeof(thread->name) - 1 );
+    pthread_mutex_unlock( &profile_thread_lock );
+}
+
+void profile_start_trace( char* path )
+{
+    if( profile_is_tracing() )
+        return;
+    // The threads' buffers are still being read from
+    if( atomic_load( &trace_writing ) )
+    {
+        fprintf( stderr, "Still writing the last trace to %s\n", trace_path );
+        return;
+    }
+    join_trace_writer();
+
+    strncpy( trace_path, path, sizeof(trace_path) - 1 );
+    trace_start = profile_clock();
+    // Each thread throws its last trace away when it next records anything
+    atomic_fetch_add( &trace_number, 1 );
+    atomic_fetch_or( &profiling, PROFILE_TRACE );
+}
+
+int profile_stop_trace()
+{
+    if( !profile_is_tracing() )
+        return 0;
+
+    atomic_fetch_and( &profiling, ~PROFILE_TRACE );
+
+    // Nothing's added to the trace now it's stopped, so it can be read on
+    // another thread
+    join_trace_writer();
+    atomic_store( &trace_writing, 1 );
+    if( pthread_create( &trace_writer, NULL, trace_writer_run, NULL ) != 0 )
+    {
+        atomic_store( &trace_writing, 0 );
+        return write_trace();
+    }
+    trace_writer_started = 1;
+
+    return 1;
+}
+
+int profile_is_tracing()
+{
+    return (atomic_load( &profiling ) & PROFILE_TRACE) != 0;
+}
+
+long long profile_take_allocations()
+{
+    long long allocations = profile_allocations;
+
+    profile_allocations = 0;
+    return allocations;
+}
+
+void profile_shutdown()
+{
+    if( profile_is_tracing() )
+        profile_stop_trace();
+    join_trace_writer();
+}
+
+long long profile_clock()
+{
+    struct timespec now;
+
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    return now.tv_sec * NANOSECONDS_PER_SECOND + now.tv_nsec;
+}
+
+void profile_record( ProfileStage stage, long long start )
+{
+    ProfileThread* thread = get_thread();
+    long long duration = profile_clock() - start;
+    int recording = atomic_load_explicit( &profiling, memory_order_relaxed );
+
+    if( thread == NULL )
+        return;
+
+    if( recording & PROFILE_STATISTICS )
+        add_sample( thread, stage, duration );
+    if( recording & PROFILE_TRACE )
+        add_event( thread, stage, start, duration );
+}
+
+void profile_record_counter( ProfileCounter counter, long long value )
+{
+    ProfileThread* thread = get_thread();
+
+    if( thread != NULL )
+        add_event( thread, TRACE_COUNTER_ID + counter, profile_clock(), value );
+}
+
+
+/*******************************************************************************
+ * INTERNAL FUNCTIONS
+ ******************************************************************************/
+/**
+ * Returns this thread's record, creating it on the thread's first timing.
+ * Returns NULL if there are too many threads.
+ */
+ProfileThread* get_thread()
+{
+    ProfileThread* thread;
+    int count;
+
+    if( this_thread != NULL || untracked_thread )
+        return this_thread;
+
+    pthread_mutex_lock( &profile_thread_lock );
+    count = atomic_load( &profile_thread_count );
+    if( count < PROFILE_MAX_THREADS &&
+        (thread = calloc( 1, sizeof(ProfileThread) )) != NULL )
+    {
+        profile_threads[count] = thread;
+        atomic_store( &profile_thread_count, count + 1 );
+        this_thread = thread;
+    }
+    else
+    {
+        fprintf( stderr, "Profiler: too many threads, not timing this one\n" );
+        untracked_thread = 1;
+    }
+    pthread_mutex_unlock( &profile_thread_lock );
+
+    return this_thread;
+}
+
+/**
+ * Adds a timing to a thread's statistics.
+ */
+void add_sample( ProfileThread* thread, ProfileStage stage,
+                 long long duration )
+{
+    // Only this thread writes to its ring, so the count needn't be
+    // incremented atomically; it's published after the timing so that readers
+    // never see a slot that hasn't been filled
+    unsigned int count = atomic_load_explicit( &thread->count,
+                                               memory_order_relaxed );
+
+    atomic_store_explicit( &thread->samples[count % PROFILE_RING_SIZE],
+                           ((unsigned long long)stage << SAMPLE_STAGE_SHIFT) |
+                           (duration & SAMPLE_DURATION_MASK),
+                           memory_order_relaxed );
+    atomic_store_explicit( &thread->count, count + 1, memory_order_release );
+}
+
+/**
+ * Adds an event to a thread's trace, starting the thread's part of the
+ * current trace if it hasn't yet.
+ */
+void add_event( ProfileThread* thread, int id, long long start,
+                long long value )
+{
+    unsigned int number = atomic_load_explicit( &trace_number,
+                                                 memory_order_acquire );
+    int count;
+
+    if( atomic_load_explicit( &thread->traceNumber,
+                              memory_order_relaxed ) != number )
+    {
+        if( thread->events == NULL )
+            thread->events = malloc( sizeof(TraceEvent) * TRACE_CAPACITY );
+        atomic_store_explicit( &thread->eventCount, 0, memory_order_relaxed );
+        atomic_store_explicit( &thread->dropped, 0, memory_order_relaxed );
+        atomic_store_explicit( &thread->traceNumber, number,
+                               memory_order_release );
+    }
+
+    count = atomic_load_explicit( &thread->eventCount, memory_order_relaxed );
+    if( thread->events == NULL || count == TRACE_CAPACITY )
+    {
+        atomic_fetch_add_explicit( &thread->dropped, 1, memory_order_relaxed );
+        return;
+    }
+
+    // As with the samples, the event is published by the count
+    thread->events[count].start = start;
+    thread->events[count].value = value;
+    thread->events[count].id = id;
+    atomic_store_explicit( &thread->eventCount, count + 1,
+                           memory_order_release );
+}
+
+/**
+ * Writes the current trace to trace_path, in Chrome's trace event format.
+ * Events still being added while it's written are left out.
+ */
+int write_trace()
+{
+    unsigned int number = atomic_load( &trace_number );
+    int threads = atomic_load( &profile_thread_count );
+    int written = 0, dropped = 0, i, j, count;
+    ProfileThread* thread;
+    TraceEvent* event;
+    FILE* file;
+
+    if( (file = fopen( trace_path, "w" )) == NULL )
+    {
+        fprintf( stderr, "Could not write the trace to %s\n", trace_path );
+        return 0;
+    }
+
+    fprintf( file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n" );
+    fprintf( file, "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, "
+                   "\"args\": {\"name\": \"%s\"}}", TRACE_PROCESS_NAME );
+
+    pthread_mutex_lock( &profile_thread_lock );
+    for( i = 0; i < threads; i++ )
+    {
+        thread = profile_threads[i];
+        if( atomic_load_explicit( &thread->traceNumber,
+                                  memory_order_acquire ) != number )
+            continue;
+        count = atomic_load_explicit( &thread->eventCount,
+                                      memory_order_acquire );
+
+        if( thread->name[0] != '\0' )
+            fprintf( file, ",\n{\"name\": \"thread_name\", \"ph\": \"M\", "
+                           "\"pid\": 1, \"tid\": %d, "
+                           "\"args\": {\"name\": \"%s\"}}",
+                     i + 1, thread->name );
+
+        for( j = 0; j < count; j++ )
+        {
+            event = &thread->events[j];
+            // Stages that were under way when the trace started
+            if( event->start < trace_start )
+                continue;
+
+            if( event->id >= TRACE_COUNTER_ID )
+            {
+                fprintf( file, ",\n{\"name\": \"%s\", \"ph\": \"C\", "
+                               "\"ts\": %.3f, \"pid\": 1, \"tid\": %d, "
+                               "\"args\": {\"value\": %lld}}",
+                         counter_names[event->id - TRACE_COUNTER_ID],
+                         (event->start - trace_start) /
+                         NANOSECONDS_PER_MICROSECOND,
+                         i + 1, event->value );
+            }
+            else
+            {
+                fprintf( file, ",\n{\"name\": \"%s\", \"ph\": \"X\", "
+                               "\"ts\": %.3f, \"dur\": %.3f, "
+                               "\"pid\": 1, \"tid\": %d}",
+                         stage_names[event->id],
+                         (event->start - trace_start) /
+                         NANOSECONDS_PER_MICROSECOND,
+                         event->value / NANOSECONDS_PER_MICROSECOND, i + 1 );
+            }
+            written++;
+        }
+        dropped += atomic_load( &thread->dropped );
+    }
+    pthread_mutex_unlock( &profile_thread_lock );
+
+    fprintf( file, "\n]}\n" );
+    fclose(file);
+
+    printf( "Wrote %d trace events to %s\n", written, trace_path );
+    if( dropped > 0 )
+        fprintf( stderr, "%d trace events didn't fit, and were dropped\n",
+                 dropped );
+
+    return 1;
+}
+
+/**
+ * Writes the trace that's just stopped, on the trace writer's thread.
+ */
+void* trace_writer_run( void* unused )
+{
+    write_trace();
+    atomic_store( &trace_writing, 0 );
+
+    return NULL;
+}
+
+/**
+ * Waits for the trace writer to finish the trace it's writing, if there is
+ * one.
+ */
+void join_trace_writer()
+{
+    if( !trace_writer_started )
+        return;
+
+    pthread_join( trace_writer, NULL );
+    trace_writer_started = 0;
+}
+
+/**
+ * Works out the statistics from the timings of every thread.
+ */
+void update_stats()
+{
+    int threads = atomic_load( &profile_thread_count );
+    int gathered = 0, i, j, first, stage, kept;
+    unsigned int recorded;
+    unsigned long long total;
+    ProfileThread* thread;
+
+    for( i = 0; i < threads; i++ )
+    {
+        thread = profile_threads[i];
+        recorded = atomic_load_explicit( &thread->count, memory_order_acquire );
+        kept = recorded < PROFILE_RING_SIZE ? recorded : PROFILE_RING_SIZE;
+
+        // The oldest of these may be overwritten as they're read, which only
+        // swaps one recent timing for another
+        for( j = 0; j < kept; j++ )
+            gathered_samples[gathered++] =
+                atomic_load_explicit( &thread->samples[j],
+                                      memory_order_relaxed );
+    }
+
+    // With the stage in the top byte, this sorts by stage, then duration
+    qsort( gathered_samples, gathered, sizeof(unsigned long long),
+           compare_samples );
+
+    for( i = 0; i < PROFILE_STAGES; i++ )
+    {
+        profile_stats[i].samples = 0;
+        profile_stats[i].min_ms = profile_stats[i].mean_ms =
+            profile_stats[i].p99_ms = 0.0f;
+    }
+
+    for( first = 0; first < gathered; first = j )
+    {
+        stage = gathered_samples[first] >> SAMPLE_STAGE_SHIFT;
+
+        total = 0;
+        for( j = first; j < gathered &&
+             (gathered_samples[j] >> SAMPLE_STAGE_SHIFT) == stage; j++ )
+            total += gathered_samples[j] & SAMPLE_DURATION_MASK;
+
+        profile_stats[stage].samples = j - first;
+        profile_stats[stage].min_ms =
+            (gathered_samples[first] & SAMPLE_DURATION_MASK) /
+            NANOSECONDS_PER_MILLISECOND;
+        profile_stats[stage].mean_ms =
+            total / (float)(j - first) / NANOSECONDS_PER_MILLISECOND;
+        profile_stats[stage].p99_ms =
+            (gathered_samples[first + (j - first - 1) * 99 / 100] &
+             SAMPLE_DURATION_MASK) / NANOSECONDS_PER_MILLISECOND;
+    }
+}
+
+int compare_samples( const void* a, const void* b )
+{
+    unsigned long long x = *(const unsigned long long*)a;
+    unsigned long long y = *(const unsigned long long*)b;
+
+    return (x > y) - (x < y);
+}
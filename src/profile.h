@@ -0,0 +1,187 @@
+#ifndef PROFILE_H_
+#define PROFILE_H_
+/**
+ * profile.h
+ * This module times the stages of the game loop, simulation and renderer.
+ *
+ * A stage is timed by bracketing it:
+ *
+ *     long long start = PROFILE_BEGIN();
+ *     render_landscape( ... );
+ *     PROFILE_END( PROFILE_LANDSCAPE, start );
+ *
+ * Each thread records its timings into buffers of its own, so timing takes no
+ * locks. Timings go to one or both of:
+ *  - statistics: a ring buffer of the last PROFILE_RING_SIZE timings on each
+ *    thread, from which the minimum, mean and 99th percentile of each stage
+ *    are worked out when asked for;
+ *  - a trace: every timing, and the counters given to PROFILE_COUNTER, from
+ *    when tracing starts until it stops and the trace is written out as a
+ *    Chrome trace file (which chrome://tracing and Perfetto both open).
+ *
+ * While neither is on, PROFILE_BEGIN is a single load and PROFILE_END a
+ * single test. Defining NO_PROFILING compiles them out altogether.
+ */
+
+#include <stdatomic.h>
+
+/**
+ * The stages timed. Stages may be nested; each is timed from beginning to
+ * end, including any stages inside it.
+ */
+typedef enum {
+    // Drawing (the GLUT thread)
+    PROFILE_FRAME, // The whole of game_loop
+    PROFILE_RENDER_UPDATE, // Picking up a snapshot, and moving the cameras
+    PROFILE_PREPARE_FRAME, // Lighting, and filling the buffers
+    PROFILE_TERRAIN_MESH, // Bringing the terrain mesh up to date
+    PROFILE_VIEWPORT, // Each player's viewport
+    PROFILE_HORIZON, // Finding what the landscape hides from a viewport
+    PROFILE_LANDSCAPE,
+    PROFILE_PLAYERS,
+    PROFILE_OBJECTS,
+    PROFILE_MINIMAP,
+    PROFILE_HUD,
+    PROFILE_SWAP,
+    // The simulation (its own thread)
+    PROFILE_TICK, // The whole of a tick
+    PROFILE_UPDATE_PLAYERS,
+    PROFILE_COLLISIONS, // Each call to test_player_collisions
+    PROFILE_PROJECTILES,
+    PROFILE_DEFORMATION, // Each crater a projectile makes
+    PROFILE_FOOD,
+    PROFILE_PUBLISH, // Publishing the snapshot
+    PROFILE_GENERATE_LANDSCAPE, // A new game's landscape
+    PROFILE_STAGES
+} ProfileStage;
+
+/**
+ * Values traced over time.
+ */
+typedef enum {
+    PROFILE_SEGMENTS, // The joints in both players' bodies, per frame
+    PROFILE_DRAW_CALLS, // Per frame
+    PROFILE_VERTICES, // Per frame
+    PROFILE_OCCLUDED, // Chunks and objects hidden behind hills, per frame
+    PROFILE_ALLOCATIONS, // Game objects allocated, per tick
+    PROFILE_COUNTERS
+} ProfileCounter;
+
+// What's being recorded (the bits of `profiling`)
+#define PROFILE_STATISTICS 1
+#define PROFILE_TRACE 2
+
+// The number of timings kept for each thread's statistics
+#define PROFILE_RING_SIZE 4096
+
+typedef struct {
+    int samples; // The number of timings the rest are from
+    float min_ms, mean_ms, p99_ms;
+} ProfileStats;
+
+extern atomic_int profiling;
+extern _Thread_local long long profile_allocations;
+
+#ifdef NO_PROFILING
+#define PROFILE_BEGIN() 0LL
+#define PROFILE_END( stage, start ) ((void)(start))
+#define PROFILE_COUNTER( counter, value ) ((void)0)
+#define PROFILE_ALLOCATION() ((void)0)
+#else
+/**
+ * Returns the time to pass to PROFILE_END, or 0 if nothing's being recorded.
+ */
+#define PROFILE_BEGIN() \
+    (atomic_load_explicit( &profiling, memory_order_relaxed ) ? \
+     profile_clock() : 0LL)
+#define PROFILE_END( stage, start ) \
+    do { if( (start) != 0 ) profile_record( (stage), (start) ); } while( 0 )
+/**
+ * Traces a counter's value. `value` is only evaluated while tracing.
+ */
+#define PROFILE_COUNTER( counter, value ) \
+    do { \
+        if( atomic_load_explicit( &profiling, memory_order_relaxed ) & \
+            PROFILE_TRACE ) \
+            profile_record_counter( (counter), (value) ); \
+    } while( 0 )
+/**
+ * Counts an allocation made by this thread, while tracing.
+ */
+#define PROFILE_ALLOCATION() \
+    do { \
+        if( atomic_load_explicit( &profiling, memory_order_relaxed ) & \
+            PROFILE_TRACE ) \
+            profile_allocations++; \
+    } while( 0 )
+#endif
+
+/**
+ * Turns the statistics on or off.
+ */
+void profile_set_enabled( int enabled );
+
+/**
+ * Returns true if the statistics are on.
+ */
+int profile_is_enabled();
+
+/**
+ * Returns statistics for every stage, from the timings recorded on every
+ * thread. They're worked out again at most twice a second, so this may be
+ * called every frame.
+ */
+ProfileStats* profile_get_stats();
+
+/**
+ * Returns the name of a stage.
+ */
+char* profile_stage_name( ProfileStage stage );
+
+/**
+ * Prints a table of the statistics.
+ */
+void profile_print_stats();
+
+/**
+ * Names the calling thread in traces.
+ */
+void profile_name_thread( char* name );
+
+/**
+ * Starts a new trace, to be written to `path` when it stops. Does nothing
+ * while the last trace is still being written.
+ */
+void profile_start_trace( char* path );
+
+/**
+ * Stops tracing, and writes the trace out on a thread of its own, so the
+ * caller isn't held up while it's written. Returns false if there was no
+ * trace, or (if it had to be written on the calling thread) it couldn't be
+ * written.
+ */
+int profile_stop_trace();
+
+/**
+ * Returns true while tracing.
+ */
+int profile_is_tracing();
+
+/**
+ * Returns the number of allocations this thread has counted since it last
+ * asked, for PROFILE_ALLOCATIONS.
+ */
+long long profile_take_allocations();
+
+/**
+ * Writes out the trace, if there is one, and waits for it to be written.
+ * Call before exiting, once the other threads have stopped.
+ */
+void profile_shutdown();
+
+/* Used by the macros above */
+long long profile_clock();
+void profile_record( ProfileStage stage, long long start );
+void profile_record_counter( ProfileCounter counter, long long value );
+
+#endif /*PROFILE_H_*/
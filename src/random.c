@@ -0,0 +1,62 @@
+#include "random.h"
+
+/*******************************************************************************
+ * GLOBALS AND CONSTANTS
+ ******************************************************************************/
+#define RANDOM_MASK (RANDOM_STATE_SIZE - 1)
+
+// The lags of the feedback: each number is the sum of the ones this far back
+#define LONG_LAG 31
+#define SHORT_LAG 3
+
+// The numbers made and thrown away after seeding, to mix the seed in
+#define WARM_UP 310
+
+
+/*******************************************************************************
+ * RANDOM FUNCTIONS
+ ******************************************************************************/
+void random_seed( Random* random, unsigned int seed )
+{
+    long long word;
+    int i;
+
+    // The first numbers come from a multiplicative generator
+    random->state[0] = seed == 0 ? 1 : seed;
+    for( i = 1; i < LONG_LAG; i++ )
+    {
+        word = (16807LL * (int)random->state[i - 1]) % 2147483647LL;
+        if( word < 0 )
+            word += 2147483647LL;
+        random->state[i] = (unsigned int)word;
+    }
+    // ... and the next few repeat them
+    for( ; i < LONG_LAG + SHORT_LAG; i++ )
+        random->state[i & RANDOM_MASK] =
+            random->state[(i - LONG_LAG) & RANDOM_MASK];
+    random->next = i & RANDOM_MASK;
+
+    for( i = 0; i < WARM_UP; i++ )
+        random_next(random);
+}
+
+int random_next( Random* random )
+{
+    unsigned int* number = &random->state[random->next];
+
+    // The ring holds the last 32 numbers, so the one 31 back is just after
+    // this one's slot
+    *number = random->state[(random->next + RANDOM_STATE_SIZE - LONG_LAG) &
+                            RANDOM_MASK] +
+              random->state[(random->next + RANDOM_STATE_SIZE - SHORT_LAG) &
+                            RANDOM_MASK];
+    random->next = (random->next + 1) & RANDOM_MASK;
+
+    return (int)(*number >> 1);
+}
+
+float bounded_random( Random* random, float min, float max )
+{
+    return min + (max - min) * ((float)random_next(random) /
+                                (float)RANDOM_MAX);
+}
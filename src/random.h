@@ -0,0 +1,47 @@
+#ifndef RANDOM_H_
+#define RANDOM_H_
+/**
+ * random.h
+ * Random number generators that each keep their own state.
+ *
+ * Each game has generators of its own, rather than sharing the C library's,
+ * so games running side by side neither race over one nor disturb each
+ * other's numbers, and a game's numbers depend only on its seed. A generator
+ * is plain data, so copying one copies where it is in its sequence.
+ *
+ * The numbers are the same as glibc's rand() gives after srand() with the
+ * same seed (an additive feedback generator, r[i] = r[i - 3] + r[i - 31]),
+ * so seeds give the same games they always have.
+ */
+
+/*******************************************************************************
+ * TYPE DEFINITIONS
+ ******************************************************************************/
+// The largest number `random_next` returns
+#define RANDOM_MAX 2147483647
+
+// The generator's state is the last 31 numbers it made, kept in a ring of 32
+#define RANDOM_STATE_SIZE 32
+
+typedef struct {
+    unsigned int state[RANDOM_STATE_SIZE];
+    int next; // Where the next number goes in `state`
+} Random;
+
+/*******************************************************************************
+ * RANDOM FUNCTIONS
+ ******************************************************************************/
+/**
+ * Starts the generator's sequence afresh from `seed`.
+ */
+void random_seed( Random* random, unsigned int seed );
+/**
+ * Returns the next number in the generator's sequence, from 0 to RANDOM_MAX.
+ */
+int random_next( Random* random );
+/**
+ * Generates a random number between min and max.
+ */
+float bounded_random( Random* random, float min, float max );
+
+#endif /*RANDOM_H_*/
@@ -1,31 +1,96 @@
 #include "render.h"
 #include "Camera.h"
 #include "Viewport.h"
-#include "GameState.h"
-#include "Player.h"
-#include "mechanics.h"
+#include "ScaledTarget.h"
+#include "TerrainMesh.h"
+#include "TubeMesh.h"
+#include "Horizon.h"
+#include "splitscreen.h"
+#include "snapshot.h"
 #include <stdlib.h>
 #include <string.h>
+#include <stddef.h>
 #include <GL/glut.h>
+// For glutGetProcAddress
+#include <GL/freeglut_ext.h>
 #include <stdio.h>
 #include "maths.h"
 #include <math.h>
+#include <time.h>
 #include "text.h"
+#include "offscreen.h"
+#include "glext.h"
+#include "pacing.h"
+#include "profile.h"
 
 /*******************************************************************************
  * TYPE DEFINITIONS
  ******************************************************************************/
+typedef struct {
+    GLfloat position[3];
+    GLfloat normal[3];
+} BodyVertex;
+
+/**
+ * Where a player's head and tail cubes are in the body buffer, and the bounds
+ * of both.
+ */
+typedef struct {
+    int head, tail; // The first vertex of each
+    float min[3], max[3];
+} PlayerBatch;
 
 /*******************************************************************************
  * GLOBALS AND CONSTANTS
  ******************************************************************************/
-Viewport *player1_viewport, *player2_viewport, *minimap, *hud;
+// The players' views are in the split screen module
+Viewport *minimap, *hud;
+
+// The share of the frame budget spent drawing the players' viewports; the
+// rest is left for the minimap, HUD and presenting the frame
+#define VIEWPORT_BUDGET_SHARE 0.8f
+
+// The landscape, brought up to date once a frame and drawn by every view
+TerrainMesh* terrain_mesh = NULL;
+
+// The players' bodies, brought up to date once a frame and drawn by every
+// view, one for each player
+TubeMesh** player_tubes = NULL;
+int player_tube_count = 0;
+
+// What the landscape hides from the view being drawn, built afresh for each
+// view that looks out over the landscape
+Horizon* horizon = NULL;
+int occlusion_enabled = 1;
+
+// Every player's head and tail cubes, filled once a frame and drawn by every
+// view
+BodyVertex* body_vertices = NULL;
+int body_vertex_count = 0, body_vertex_capacity = 0;
+// The buffer object they're uploaded to (0 without buffer objects)
+GLuint body_buffer = 0;
+// Where each player's cubes are (as many as there are player tubes)
+PlayerBatch* player_batches = NULL;
+
+// The backend we're rendering through
+RenderBackend render_backend = BACKEND_GLUT;
+
+// Used to draw projectiles and, without GLUT, edibles
+GLUquadric* sphere_quadric = NULL;
+
+// Counts of the work done for the last frame
+RenderStats render_stats;
+
+// The snapshot being drawn, interpolated between the last two ticks
+RenderSnapshot interpolated_snapshot;
+RenderSnapshot* current_snapshot = NULL;
 
 // The current frames per second
 float fps = 0.0f;
 
-// Do we prefer horizontal or vertical split screen?
-//#define PREFER_VERTICAL
+// If set, time passes only by the amounts given to render_update
+int fixed_timing = 0;
+int fixed_time = 0;
 
 // Draw normals
 //#define DRAW_NORMALS
@@ -43,11 +108,19 @@ float min_camera_height = 0.0f;
 #define SKY_G 0.91796875f
 #define SKY_B 0.953125f
 
+// The vertices in a cube, drawn as quads
+#define CUBE_VERTICES 24
+
 #define FOG_START 0.5
 #define FOG_END 0.6
 
-// The minimum number of milliseconds to wait before redrawing the scene
-#define MIN_REDRAW_DELAY 0
+// Where the profiler's table starts on the HUD, and the space between lines
+#define PROFILE_TOP 530
+#define PROFILE_LINE_HEIGHT 14
+#define PROFILE_MIN_X 160
+#define PROFILE_MEAN_X 220
+#define PROFILE_P99_X 280
+
 
 
 /*******************************************************************************
@@ -55,35 +128,57 @@ float min_camera_height = 0.0f;
  ******************************************************************************/
 void setup_cameras();
 void update_cameras( int delta );
+PlayerSnapshot* player_snapshot( RenderSnapshot* snapshot, int player_id );
 void set_up_GL();
 void set_up_lighting();
-void render_landscape( Landscape* landscape, float actual_width );
-void render_player( Player* player, float scale );
-void render_projectiles( Projectile* proj1, Projectile* proj2 );
-void render_edibles( Edible* edible );
-int should_render();
-void render_viewport( Viewport* viewport, GameState* gamestate );
-void render_hud( Viewport* viewport, GameState* gamestate );
+void prepare_frame( RenderSnapshot* snapshot );
+void fill_body_buffer( RenderSnapshot* snapshot );
+void fit_player_meshes( int count );
+void fill_player_batch( PlayerBatch* batch, PlayerSnapshot* player,
+                        float size );
+void add_cube( float centre[3], float size, PlayerBatch* batch );
+Horizon* build_horizon( Viewport* viewport, Landscape* landscape,
+                        Frustum* frustum );
+int eye_above_landscape( Landscape* landscape, float eye[3] );
+int hidden( Horizon* horizon, float min[3], float max[3] );
+int object_hidden( Horizon* horizon, float position[3], float radius );
+void render_landscape( Landscape* landscape, Frustum* frustum,
+                       Horizon* horizon );
+void render_player( PlayerSnapshot* player, PlayerBatch* batch,
+                    TubeMesh* tube, Frustum* frustum, Horizon* horizon );
+void render_projectiles( ObjectSnapshot* projectiles, int count,
+                         Horizon* horizon );
+void render_edible( ObjectSnapshot* edible, Horizon* horizon );
+void render_viewport( Viewport* viewport, RenderSnapshot* snapshot );
+void render_view( PlayerView* view, RenderSnapshot* snapshot );
+void render_hud( Viewport* viewport, RenderSnapshot* snapshot );
+void render_profile( Viewport* hud );
 void calc_fps();
+float interpolation_fraction( RenderSnapshot* snapshot );
+void swap_buffers();
+void draw_sphere( float radius, int slices, int stacks );
+void count_draw_call( int vertices );
 void set_3_4_view( Camera* camera, float position[3], float forward[3], float up[3], int delta );
 //void draw_segment( Point start, Point end, )
 
 /*******************************************************************************
  * PUBLIC FUNCTIONS
  ******************************************************************************/
-void render_init()
+void render_init( RenderBackend backend )
 {
-    GameState* gamestate = get_gamestate();
-    // Create cameras for both players
-    player1_viewport = Viewport_new( 0, 0, 800, 300 );
-    player2_viewport = Viewport_new( 0, 300, 800, 300 );
+    Landscape* landscape;
+    
+    render_backend = backend;
+    snapshot_interpolate( snapshot_acquire(), 1.0f, &interpolated_snapshot );
+    current_snapshot = &interpolated_snapshot;
+    landscape = current_snapshot->landscape;
     
     minimap = Viewport_new( 350, 250, 100, 100 );
     minimap->ortho = 1;
-    minimap->bottom = gamestate->landscape->southBound;
-    minimap->top = gamestate->landscape->northBound;
-    minimap->left = gamestate->landscape->westBound;
-    minimap->right = gamestate->landscape->eastBound;
+    minimap->bottom = landscape->southBound;
+    minimap->top = landscape->northBound;
+    minimap->left = landscape->westBound;
+    minimap->right = landscape->eastBound;
     
     hud = Viewport_new( 0, 0, 800, 600 );
     hud->ortho = 1;
@@ -92,8 +187,29 @@ void render_init()
     hud->left = -1;
     hud->right = 1;
     
+    // GLUT's context needs its extensions loading (the offscreen backend
+    // loads its own)
+    if( backend == BACKEND_GLUT )
+        glext_init(glutGetProcAddress);
+    
+    // Create a view for each player in the game (which needs the extensions
+    // loaded, to be scaled)
+    splitscreen_init( current_snapshot->playerCount );
+    splitscreen_layout( 800, 600 );
+    
+    // Create the buffers drawn from
+    terrain_mesh = TerrainMesh_new();
+    fit_player_meshes( current_snapshot->playerCount );
+    horizon = Horizon_new();
+    if( glext_has_buffers() )
+        ext_glGenBuffers( 1, &body_buffer );
+    
     // Set up the scene
     set_up_GL();
+    sphere_quadric = gluNewQuadric();
+    
+    // Build the font atlas
+    text_init();
     
     // Set the cameras up
     setup_cameras();
@@ -102,13 +218,12 @@ void render_init()
 
 void render()
 {
-    GameState* gamestate;
+    int i;
+    long long start;
     
-    if( !should_render() )
-        return;
-    
-    // Get the gamestate
-    gamestate = get_gamestate();
+    render_stats.draw_calls = 0;
+    render_stats.vertices = 0;
+    render_stats.occluded = 0;
     
     // Set the default buffer colour to black
     glClearColor( SKY_R, SKY_G, SKY_B, 1.0f );
@@ -116,19 +231,38 @@ void render()
     // Clear the colour and depth buffers
     glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
     
-    // Draw player 1's viewport
-    render_viewport( player1_viewport, gamestate );
-    // Draw player 2's viewport
-    render_viewport( player2_viewport, gamestate );
+    // Do everything that doesn't depend on the view once
+    start = PROFILE_BEGIN();
+    prepare_frame( current_snapshot );
+    PROFILE_END( PROFILE_PREPARE_FRAME, start );
     
-    // Turn off depth buffering for the minimap and HUD
+    // Draw each player's view
+    for( i = 0; i < splitscreen_count(); i++ )
+    {
+        start = PROFILE_BEGIN();
+        render_view( splitscreen_view(i), current_snapshot );
+        PROFILE_END( PROFILE_VIEWPORT, start );
+    }
+    
+    // Turn off depth buffering for the minimap and HUD (which are always drawn
+    // at full resolution)
     glDisable(GL_DEPTH_TEST);
-    render_viewport( minimap, gamestate );
-    render_hud( hud, gamestate );
+    start = PROFILE_BEGIN();
+    render_viewport( minimap, current_snapshot );
+    PROFILE_END( PROFILE_MINIMAP, start );
+    start = PROFILE_BEGIN();
+    render_hud( hud, current_snapshot );
+    PROFILE_END( PROFILE_HUD, start );
     glEnable(GL_DEPTH_TEST);
     
     // Swap the buffers
-    glutSwapBuffers();
+    start = PROFILE_BEGIN();
+    swap_buffers();
+    PROFILE_END( PROFILE_SWAP, start );
+    
+    PROFILE_COUNTER( PROFILE_DRAW_CALLS, render_stats.draw_calls );
+    PROFILE_COUNTER( PROFILE_VERTICES, render_stats.vertices );
+    PROFILE_COUNTER( PROFILE_OCCLUDED, render_stats.occluded );
 
     // Calculate the framerate
     calc_fps();
@@ -137,36 +271,9 @@ void render()
 void window_resized( int width, int height )
 {
     /* Adjust the viewports to match the new window dimensions */
+    splitscreen_layout( width, height );
     
-    if(
-#ifdef PREFER_VERTICAL
-        width > height  // If equal, choose vertical
-#else
-        width <= height // If equal, choose horizontal
-#endif
-      )
-    {
-        // Horizontal split screen
-        player1_viewport->x = player1_viewport->y = 0; // Player 1 on bottom
-        player2_viewport->x = 0; player2_viewport->y = height / 2;
-        
-        player1_viewport->width = player2_viewport->width = width;
-        player1_viewport->height = player2_viewport->height = height / 2;
-        
-        minimap->height = minimap->width = height / 6;
-    }
-    else
-    {
-        // Vertical split screen
-        player1_viewport->x = width / 2; player1_viewport->y = 0;
-        // Player 1 on right
-        player2_viewport->x = player2_viewport->y = 0;
-        
-        player1_viewport->width = player2_viewport->width = width / 2;
-        player1_viewport->height = player2_viewport->height = height;
-        
-        minimap->height = minimap->width = width / 6;
-    }
+    minimap->height = minimap->width = (width > height ? width : height) / 6;
     
     minimap->x = width / 2 - minimap->width / 2;
     minimap->y = height / 2 - minimap->width / 2;
@@ -177,8 +284,65 @@ void window_resized( int width, int height )
 
 void render_update( int delta )
 {
+    RenderSnapshot* latest = snapshot_acquire();
+    
+    // Draw the latest state of the game, or rather, the state between the
+    // last two ticks that corresponds to now
+    snapshot_interpolate( latest, interpolation_fraction(latest),
+                          &interpolated_snapshot );
+    current_snapshot = &interpolated_snapshot;
+    
     update_cameras(delta);
     // Update anything else that changes with time
+    fixed_time += delta;
+}
+
+RenderStats* render_get_stats()
+{
+    return &render_stats;
+}
+
+void render_set_camera_override( int player_id, Camera* camera )
+{
+    int i;
+    
+    for( i = 0; i < splitscreen_count(); i++ )
+    {
+        if( splitscreen_view(i)->player_id == player_id )
+            splitscreen_view(i)->camera_override = camera;
+    }
+}
+
+int render_game_is_active()
+{
+    return current_snapshot->mode == MODE_RUNNING ||
+           current_snapshot->mode == MODE_COUNTDOWN;
+}
+
+void render_set_fixed_timing( int enabled )
+{
+    fixed_timing = enabled;
+    fixed_time = 0;
+}
+
+void render_set_occlusion( int enabled )
+{
+    occlusion_enabled = enabled;
+}
+
+void render_set_frame_budget( float milliseconds )
+{
+    PlayerView* view;
+    int i;
+    
+    for( i = 0; i < splitscreen_count(); i++ )
+    {
+        view = splitscreen_view(i);
+        if( view->target != NULL )
+            ScaledTarget_setBudget( view->target,
+                                    milliseconds * VIEWPORT_BUDGET_SHARE /
+                                    splitscreen_count() );
+    }
 }
 
 /*******************************************************************************
@@ -186,34 +350,35 @@ void render_update( int delta )
  ******************************************************************************/
 void setup_cameras()
 {
-    // Get the players
-    GameState* gamestate = get_gamestate();
-    Player *player1 = gamestate->player1,
-           *player2 = gamestate->player2;
+    Landscape* landscape = current_snapshot->landscape;
+    PlayerSnapshot* player;
+    int i;
     
     // Set camera distance
-    camera_distance = gamestate->landscape->gridDivisionDepth * CAMERA_DISTANCE;
+    camera_distance = landscape->gridDivisionDepth * CAMERA_DISTANCE;
     // Set the minimum camera height above the terrain
-    min_camera_height = gamestate->player1->radius * CAMERA_HEIGHT;
+    min_camera_height = current_snapshot->players[0].radius * CAMERA_HEIGHT;
     
     /* Set up the players' viewports */
-    set_3_4_view( player1_viewport->camera,
-                  player1->headPosition,
-                  player1->forward,
-                  player1->up,
-                  1000000 );
-    set_3_4_view( player2_viewport->camera,
-                  player2->headPosition,
-                  player2->forward,
-                  player2->up,
-                  1000000 );
+    for( i = 0; i < splitscreen_count(); i++ )
+    {
+        player = player_snapshot( current_snapshot,
+                                  splitscreen_view(i)->player_id );
+        if( player == NULL )
+            continue;
+        set_3_4_view( splitscreen_view(i)->viewport->camera,
+                      player->headPosition,
+                      player->forward,
+                      player->up,
+                      1000000 );
+    }
     
     /* Set up the minimap camera */
-    minimap->camera->position[0] = gamestate->landscape->westBound + 
-                                   gamestate->landscape->worldWidth / 2.0f;
-    minimap->camera->position[1] = gamestate->landscape->maxHeight * 10;
-    minimap->camera->position[2] = gamestate->landscape->southBound +
-                                   gamestate->landscape->worldDepth / 2.0f;
+    minimap->camera->position[0] = landscape->westBound + 
+                                   landscape->worldWidth / 2.0f;
+    minimap->camera->position[1] = landscape->maxHeight * 10;
+    minimap->camera->position[2] = landscape->southBound +
+                                   landscape->worldDepth / 2.0f;
     minimap->camera->forward[0] = 0.0f;
     minimap->camera->forward[1] = 0.0f;
     minimap->camera->forward[2] = 0.0f;
@@ -238,21 +403,36 @@ void setup_cameras()
  */
 void update_cameras( int delta )
 {
-    // Get the players
-    GameState* gamestate = get_gamestate();
-    Player *player1 = gamestate->player1,
-           *player2 = gamestate->player2;
+    PlayerView* view;
+    PlayerSnapshot* player;
+    int i;
     
-    set_3_4_view( player1_viewport->camera,
-                  player1->headPosition,
-                  player1->forward,
-                  player1->up,
-                  delta );
-    set_3_4_view( player2_viewport->camera,
-                  player2->headPosition,
-                  player2->forward,
-                  player2->up,
-                  delta );
+    for( i = 0; i < splitscreen_count(); i++ )
+    {
+        view = splitscreen_view(i);
+        player = player_snapshot( current_snapshot, view->player_id );
+        
+        if( view->camera_override != NULL )
+            *view->viewport->camera = *view->camera_override;
+        else if( player != NULL )
+            set_3_4_view( view->viewport->camera,
+                          player->headPosition,
+                          player->forward,
+                          player->up,
+                          delta );
+    }
+}
+
+/**
+ * Finds a player in a snapshot, by ID (counting from 1). Returns NULL if
+ * there's no such player.
+ */
+PlayerSnapshot* player_snapshot( RenderSnapshot* snapshot, int player_id )
+{
+    if( player_id < 1 || player_id > snapshot->playerCount )
+        return NULL;
+    
+    return &snapshot->players[player_id - 1];
 }
 
 void set_3_4_view( Camera* camera, float position[3], float forward[3], float up[3], int delta )
@@ -320,7 +500,7 @@ void set_3_4_view( Camera* camera, float position[3], float forward[3], float up
     camera->up[2] = 0;//ideal_up[2];
 
 	// Ensure that camera is above terrain
-	Landscape* landscape = get_gamestate()->landscape;
+	Landscape* landscape = current_snapshot->landscape;
 	float terrain_height =
 		Landscape_getHeight( landscape,
 							 camera->position[0],
@@ -331,27 +511,6 @@ void set_3_4_view( Camera* camera, float position[3], float forward[3], float up
 	}
 }
 
-/**
- * Implements very simple framerate limiting.
- * 
- * Only redraw the scene if at least MIN_REDRAW_DELAY milliseconds have passed.
- */
-int should_render()
-{
-    static int last_render = 0;
-    int now;
-    
-    now = glutGet(GLUT_ELAPSED_TIME);
-    
-    if( now - last_render >= MIN_REDRAW_DELAY )
-    {
-        last_render = now;
-        return 1;
-    }
-    
-    return 0;
-}
-
 /**
  * Sets up the scene.
  * 
@@ -383,27 +542,32 @@ void set_up_GL()
 /**
  * Sets up lighting.
  * 
- * Remember that lights are affected by the current model/view matrix.
+ * Remember that lights are affected by the current model/view matrix. The
+ * cameras' transforms are kept in the projection matrix, so the light is set
+ * up once a frame, for every view.
  */
 void set_up_lighting()
 {
-    GameState* gamestate = get_gamestate();
+    Landscape* landscape = current_snapshot->landscape;
     
     glMatrixMode(GL_MODELVIEW);
     glPushMatrix();
-    glScalef( gamestate->landscape->worldWidth,
-              gamestate->landscape->worldWidth,
-              gamestate->landscape->worldWidth );
+    glLoadIdentity();
+    glScalef( landscape->worldWidth,
+              landscape->worldWidth,
+              landscape->worldWidth );
     
     // Create a light
     GLfloat light_color[]    = { 1.0f, 1.0f, 1.0f, 1.0f },
-            light_position[3],
+            light_position[4],
             ambient          = 0.2f,
             diffuse          = 0.9,
             specular         = 0.4f;
     
+    // A point light, over the middle of the landscape
     light_position[0] = light_position[2] = 0;
-    light_position[1] = gamestate->landscape->maxHeight;
+    light_position[1] = landscape->maxHeight;
+    light_position[3] = 1.0f;
     
     GLfloat ambient_light[] = { ambient * light_color[0],
                                 ambient * light_color[1],
@@ -430,52 +594,116 @@ void set_up_lighting()
 }
 
 /**
- * Renders the given landscape.
+ * Does the work for a frame that's the same for every view: lighting, and
+ * bringing the landscape and players' buffers up to date.
  */
-void render_landscape( Landscape* landscape, float actual_width )
+void prepare_frame( RenderSnapshot* snapshot )
 {
-    // The column and row numbers give the location in the height map.
-    // X and Z values are inferred from our position in the array.
-    // Columns map to X values, rows map to Z values.
-    int column, row;
-    
-    glMatrixMode(GL_MODELVIEW);
-    glPushMatrix();
-    
-    // Scale
-    //glScalef( actual_width, actual_width / 4.0f, actual_width );
     float ambient = 0.0,
           diffuse = 0.0,
           specular = 1.0, specular_focus = 60;
+    long long start;
+    int segments = 0, i;
     GLfloat ambient_colour[] = { ambient, ambient, ambient, 1.0f };
     GLfloat diffuse_colour[] = { diffuse, diffuse, diffuse, 1.0f };
     GLfloat specular_colour[] = { specular, specular, specular, 0.0f };
+    
+    // Everything is drawn with the landscape's material (colour material
+    // takes care of the ambient and diffuse colours)
     glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT, ambient_colour);
     glMaterialfv(GL_FRONT_AND_BACK, GL_DIFFUSE, diffuse_colour);
     glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, specular_colour);
     glMateriali(GL_FRONT_AND_BACK, GL_SHININESS, specular_focus);
     
-    // Set up lighting in the context of the landscape
     set_up_lighting();
+    
+    start = PROFILE_BEGIN();
+    TerrainMesh_update( terrain_mesh, snapshot->landscape,
+                        snapshot->generation );
+    PROFILE_END( PROFILE_TERRAIN_MESH, start );
+    fill_body_buffer(snapshot);
+    for( i = 0; i < snapshot->playerCount; i++ )
+        segments += snapshot->players[i].bodyLength;
+    PROFILE_COUNTER( PROFILE_SEGMENTS, segments );
+}
 
-    for( column = 0; column < landscape->gridWidth - 1; column++ )
+/**
+ * Fills the body buffer with every player's head and tail, and uploads it,
+ * and brings their bodies up to date.
+ */
+void fill_body_buffer( RenderSnapshot* snapshot )
+{
+    float size = snapshot->landscape->gridDivisionWidth;
+    int i;
+    
+    fit_player_meshes( snapshot->playerCount );
+    
+    // As thick as the head and tail
+    for( i = 0; i < snapshot->playerCount; i++ )
+        TubeMesh_update( player_tubes[i], &snapshot->players[i], size / 2.0f,
+                         snapshot->generation );
+    
+    body_vertex_count = 0;
+    for( i = 0; i < snapshot->playerCount; i++ )
+        fill_player_batch( &player_batches[i], &snapshot->players[i], size );
+    
+    if( body_buffer != 0 )
     {
-        glBegin(GL_QUAD_STRIP);
-        for( row = 0; row < landscape->gridWidth; row++ )
-        {
-            // Left point
-            glColor3fv( landscape->colorMap[row][column] );
-            glNormal3fv( landscape->normalMap[row][column] );
-            glVertex3fv( landscape->pointMap[row][column] );
-            
-            // Right point
-            glColor3fv( landscape->colorMap[row][column + 1] );
-            glNormal3fv( landscape->normalMap[row][column + 1] );
-            glVertex3fv( landscape->pointMap[row][column + 1] );
-        }
-        glEnd();
-        
+        ext_glBindBuffer( GL_ARRAY_BUFFER, body_buffer );
+        ext_glBufferData( GL_ARRAY_BUFFER,
+                          sizeof(BodyVertex) * body_vertex_count,
+                          body_vertices, GL_STREAM_DRAW );
+        ext_glBindBuffer( GL_ARRAY_BUFFER, 0 );
+    }
+}
+
+/**
+ * Makes sure there's a tube and a batch for each of `count` players.
+ */
+void fit_player_meshes( int count )
+{
+    if( count <= player_tube_count )
+        return;
+    
+    player_tubes = (TubeMesh**)realloc( player_tubes,
+                                        sizeof(TubeMesh*) * count );
+    player_batches = (PlayerBatch*)realloc( player_batches,
+                                            sizeof(PlayerBatch) * count );
+    for( ; player_tube_count < count; player_tube_count++ )
+        player_tubes[player_tube_count] = TubeMesh_new();
+}
+
+void fill_player_batch( PlayerBatch* batch, PlayerSnapshot* player,
+                        float size )
+{
+    memcpy( batch->min, player->headPosition, sizeof(float) * 3 );
+    memcpy( batch->max, player->headPosition, sizeof(float) * 3 );
+    
+    batch->head = body_vertex_count;
+    add_cube( player->headPosition, size, batch );
+    
+    batch->tail = body_vertex_count;
+    add_cube( player->tailPosition, size, batch );
+}
+
+/**
+ * Renders the parts of the landscape inside the frustum, and not hidden by
+ * the horizon (if there is one).
+ */
+void render_landscape( Landscape* landscape, Frustum* frustum,
+                       Horizon* horizon )
+{
+#ifdef DRAW_NORMALS
+    int column, row;
+#endif
+    
+    TerrainMesh_draw( terrain_mesh, frustum, horizon,
+                      &render_stats.draw_calls, &render_stats.vertices,
+                      &render_stats.occluded );
+    
 #ifdef DRAW_NORMALS
+    for( column = 0; column < landscape->gridWidth - 1; column++ )
+    {
         glBegin(GL_LINES);
         for( row = 0; row < landscape->gridWidth; row++ )
         {
@@ -489,26 +717,35 @@ void render_landscape( Landscape* landscape, float actual_width )
             glVertex3fv( landscape->normalMap[row][column + 1] );
         }
         glEnd();
-#endif
     }
-    
-    glPopMatrix();
+#endif
 }
 
 
 /**
- * Renders a player.
+ * Renders a player, from its batch in the body buffer, if it's inside the
+ * frustum and not hidden by the horizon.
  */
-void render_player( Player* player, float scale )
+void render_player( PlayerSnapshot* player, PlayerBatch* batch,
+                    TubeMesh* tube, Frustum* frustum, Horizon* horizon )
 {
-    Body* segment = player->head->next;
+    const char* base = body_buffer != 0 ? NULL : (const char*)body_vertices;
+    
+    // Draw the body, in the colour of the player
+    if( !hidden( horizon, tube->min, tube->max ) )
+    {
+        glColor3fv( player->color );
+        TubeMesh_draw( tube, frustum,
+                       &render_stats.draw_calls, &render_stats.vertices );
+    }
+    
+    if( !frustum_contains_box( frustum, batch->min, batch->max ) ||
+        hidden( horizon, batch->min, batch->max ) )
+        return;
     
     // Push the current modelview matrix
     glMatrixMode(GL_MODELVIEW);
     
-    // Draw in the colour of the player
-    glColor3fv( player->color );
-    
     // Draw the head (in white for debugging)
     glColor3f(1.0f, 1.0f, 1.0f);
     
@@ -518,83 +755,77 @@ void render_player( Player* player, float scale )
                       player->headPosition[1],
                       player->headPosition[2] );
         
-        // Draw forward and up vectors
+        // Draw forward and up vectors (lit from above; the last normal
+        // given is undefined after drawing from vertex arrays)
+        glNormal3f( 0.0f, 1.0f, 0.0f );
         glBegin(GL_LINES);
         glVertex3fv( player->headPosition );
         glVertex3fv( player->forward );
         glVertex3fv( player->headPosition );
         glVertex3fv( player->up );
         glEnd();
-        
-        glutSolidCube( 1.0f * scale );
+        count_draw_call(4);
     glPopMatrix();
     
-    // Draw the body
-    while( segment != NULL && segment->next != NULL )
-    {
-        glPushMatrix();
-            // Translate
-            glTranslatef( segment->position[0],
-                          segment->position[1],
-                          segment->position[2] );
-            
-            glColor3fv( player->color );
-            
-            glutSolidCube(1.0f * scale);
-        glPopMatrix();
-        
-        segment = segment->next;
-    }
+    // The cubes are already in place in the body buffer
+    if( body_buffer != 0 )
+        ext_glBindBuffer( GL_ARRAY_BUFFER, body_buffer );
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_NORMAL_ARRAY);
+    glVertexPointer( 3, GL_FLOAT, sizeof(BodyVertex),
+                     base + offsetof( BodyVertex, position ) );
+    glNormalPointer( GL_FLOAT, sizeof(BodyVertex),
+                     base + offsetof( BodyVertex, normal ) );
+    
+    glDrawArrays( GL_QUADS, batch->head, CUBE_VERTICES );
+    count_draw_call(CUBE_VERTICES);
     
     // Draw the tail (in white for debugging)
     glColor3f(1.0f, 1.0f, 1.0f);
+    glDrawArrays( GL_QUADS, batch->tail, CUBE_VERTICES );
+    count_draw_call(CUBE_VERTICES);
     
-    glPushMatrix();
-        // Translate
-        glTranslatef( player->tailPosition[0],
-                      player->tailPosition[1],
-                      player->tailPosition[2] );
-        
-        glutSolidCube( 1.0f * scale );
-    glPopMatrix();
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glDisableClientState(GL_NORMAL_ARRAY);
+    if( body_buffer != 0 )
+        ext_glBindBuffer( GL_ARRAY_BUFFER, 0 );
 }
 
-void render_projectiles( Projectile* proj1, Projectile* proj2 )
+void render_projectiles( ObjectSnapshot* projectiles, int count,
+                         Horizon* horizon )
 {
+    ObjectSnapshot* projectile;
+    int i;
+    
     glMatrixMode(GL_MODELVIEW);
     
     // Draw projectiles in white
     glColor3f( 1.0f, 1.0f, 1.0f );
     
-    if( proj1 != NULL )
+    for( i = 0; i < count; i++ )
     {
-        glPushMatrix();
-            // Move to the object's location
-            glTranslatef( proj1->position[0],
-                          proj1->position[1],
-                          proj1->position[2] );
-            
-            glutSolidSphere(proj1->radius, 4, 4);
+        projectile = &projectiles[i];
+        if( !projectile->exists ||
+            object_hidden( horizon, projectile->position, projectile->radius ) )
+            continue;
         
-        glPopMatrix();
-    }
-    if( proj2 != NULL )
-    {
         glPushMatrix();
             // Move to the object's location
-            glTranslatef( proj2->position[0],
-                          proj2->position[1],
-                          proj2->position[2] );
+            glTranslatef( projectile->position[0],
+                          projectile->position[1],
+                          projectile->position[2] );
             
-            glutSolidSphere(proj2->radius, 4, 4);
+            draw_sphere( projectile->radius, 4, 4 );
         
         glPopMatrix();
     }
 }
 
-void render_edible( Edible* edible )
+void render_edible( ObjectSnapshot* edible, Horizon* horizon )
 {
-    if( edible == NULL )
+    // The teapot's spout and handle stick out past its radius
+    if( !edible->exists ||
+        object_hidden( horizon, edible->position, edible->radius * 2.0f ) )
         return;
     
     // Draw edibles in red
@@ -605,16 +836,30 @@ void render_edible( Edible* edible )
                       edible->position[1],
                       edible->position[2] );
         
-        // glutSolidSphere( edible->radius, 4, 4 );
         glPolygonMode(GL_BACK, GL_FILL);
-        glutSolidTeapot(edible->radius);
+        // The teapot is GLUT's, so headless we make do with a sphere
+        if( render_backend == BACKEND_GLUT )
+        {
+            glutSolidTeapot(edible->radius);
+            // GLUT doesn't tell us how many vertices it drew
+            count_draw_call(0);
+        }
+        else
+        {
+            draw_sphere( edible->radius, 8, 8 );
+        }
         glPolygonMode(GL_BACK, GL_LINE);
     
     glPopMatrix();
 }
 
-void render_viewport( Viewport* viewport, GameState* gamestate )
+void render_viewport( Viewport* viewport, RenderSnapshot* snapshot )
 {
+    Frustum frustum;
+    Horizon* view_horizon;
+    long long start;
+    int i;
+    
     // Reload the identity matrix
     glMatrixMode(GL_MODELVIEW);
     glLoadIdentity();
@@ -622,16 +867,241 @@ void render_viewport( Viewport* viewport, GameState* gamestate )
     // Apply the viewport to the current OpenGL context (and its camera's
     // perspective)
     Viewport_apply(viewport);
+    Viewport_getFrustum(&frustum);
+    
+    // Find what the landscape hides
+    start = PROFILE_BEGIN();
+    view_horizon = build_horizon( viewport, snapshot->landscape, &frustum );
+    PROFILE_END( PROFILE_HORIZON, start );
     
     // Render the landscape
-    render_landscape( gamestate->landscape, gamestate->landscape->worldWidth );
+    start = PROFILE_BEGIN();
+    render_landscape( snapshot->landscape, &frustum, view_horizon );
+    PROFILE_END( PROFILE_LANDSCAPE, start );
     // Render the players
-    render_player( gamestate->player1, gamestate->landscape->gridDivisionWidth );
-    render_player( gamestate->player2, gamestate->landscape->gridDivisionWidth );
+    start = PROFILE_BEGIN();
+    for( i = 0; i < snapshot->playerCount; i++ )
+        render_player( &snapshot->players[i], &player_batches[i],
+                       player_tubes[i], &frustum, view_horizon );
+    PROFILE_END( PROFILE_PLAYERS, start );
     // Render the objects
-    render_projectiles( gamestate->player1_projectile,
-                        gamestate->player2_projectile );
-    render_edible( gamestate->edible );
+    start = PROFILE_BEGIN();
+    render_projectiles( snapshot->projectiles, snapshot->playerCount,
+                        view_horizon );
+    render_edible( &snapshot->edible, view_horizon );
+    PROFILE_END( PROFILE_OBJECTS, start );
+}
+
+/**
+ * Builds the horizon for what's inside a viewport's frustum, if it looks out
+ * over the landscape from above it. Returns NULL otherwise, when nothing can be said to be hidden.
+ */
+Horizon* build_horizon( Viewport* viewport, Landscape* landscape,
+                        Frustum* frustum )
+{
+    float* eye = viewport->camera->position;
+    float dx, dz;
+    
+    // Looking straight down, nothing's behind anything
+    if( !occlusion_enabled || viewport->ortho ||
+        !eye_above_landscape( landscape, eye ) )
+        return NULL;
+    
+    // Nothing's further away than the far corner
+    dx = fmaxf( eye[0] - landscape->westBound, landscape->eastBound - eye[0] );
+    dz = fmaxf( eye[2] - landscape->southBound,
+                landscape->northBound - eye[2] );
+    
+    Horizon_begin( horizon, eye, sqrtf( dx * dx + dz * dz ) );
+    TerrainMesh_addOccluders( terrain_mesh, horizon, frustum );
+    Horizon_end(horizon);
+    
+    return horizon;
+}
+
+/**
+ * Returns true if `eye` is over the landscape, and above every point around
+ * it. Lines of sight from anywhere else might pass under the landscape's
+ * edge, or start under its surface, so not be blocked by it.
+ */
+int eye_above_landscape( Landscape* landscape, float eye[3] )
+{
+    int row = Landscape_getColumn( landscape, eye[0] ),
+        column = Landscape_getColumn( landscape, eye[2] ), i, j;
+    
+    if( eye[0] <= landscape->westBound || eye[0] >= landscape->eastBound ||
+        eye[2] <= landscape->southBound || eye[2] >= landscape->northBound )
+        return 0;
+    
+    for( i = row - 1; i <= row + 1; i++ )
+    {
+        for( j = column - 1; j <= column + 1; j++ )
+        {
+            if( i >= 0 && i < landscape->gridWidth &&
+                j >= 0 && j < landscape->gridWidth &&
+                eye[1] <= landscape->pointMap[i][j][1] )
+                return 0;
+        }
+    }
+    
+    return 1;
+}
+
+/**
+ * Returns true if the box between `min` and `max` is hidden by the horizon
+ * (if there is one), counting it if so.
+ */
+int hidden( Horizon* horizon, float min[3], float max[3] )
+{
+    if( horizon == NULL || !Horizon_hides( horizon, min, max ) )
+        return 0;
+    
+    render_stats.occluded++;
+    return 1;
+}
+
+/**
+ * Returns true if an object `radius` across at `position` is hidden by the
+ * horizon.
+ */
+int object_hidden( Horizon* horizon, float position[3], float radius )
+{
+    float min[3] = { position[0] - radius, position[1] - radius,
+                     position[2] - radius },
+          max[3] = { position[0] + radius, position[1] + radius,
+                     position[2] + radius };
+    
+    return hidden( horizon, min, max );
+}
+
+/**
+ * Renders a player's view, through its scaled target if it has one.
+ */
+void render_view( PlayerView* view, RenderSnapshot* snapshot )
+{
+    if( view->target == NULL )
+    {
+        render_viewport( view->viewport, snapshot );
+        return;
+    }
+    
+    render_viewport( ScaledTarget_begin( view->target, view->viewport ),
+                     snapshot );
+    ScaledTarget_end( view->target );
+}
+
+/**
+ * Presents the finished frame through the current backend.
+ */
+void swap_buffers()
+{
+    if( render_backend == BACKEND_GLUT )
+        glutSwapBuffers();
+    else
+        offscreen_swap_buffers();
+}
+
+/**
+ * Adds a cube centred on `centre` to the body buffer, as glutSolidCube would
+ * draw it there (glutSolidCube can't be used without a GLUT window), and
+ * grows the batch's bounds to fit it.
+ */
+void add_cube( float centre[3], float size, PlayerBatch* batch )
+{
+    static const GLfloat normals[6][3] = {
+        { -1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 1.0f, 0.0f, 0.0f },
+        { 0.0f, -1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, -1.0f }
+    };
+    static const int faces[6][4] = {
+        { 0, 1, 2, 3 }, { 3, 2, 6, 7 }, { 7, 6, 5, 4 },
+        { 4, 5, 1, 0 }, { 5, 6, 2, 1 }, { 7, 4, 0, 3 }
+    };
+    GLfloat vertices[8][3];
+    BodyVertex* vertex;
+    float half = size / 2.0f;
+    int i, j;
+    
+    if( body_vertex_count + CUBE_VERTICES > body_vertex_capacity )
+    {
+        body_vertex_capacity = body_vertex_capacity == 0 ?
+                               CUBE_VERTICES * 64 : body_vertex_capacity * 2;
+        body_vertices = (BodyVertex*)realloc( body_vertices,
+                            sizeof(BodyVertex) * body_vertex_capacity );
+    }
+    
+    for( i = 0; i < 8; i++ )
+    {
+        vertices[i][0] = centre[0] + (i < 4 ? -half : half);
+        vertices[i][1] = centre[1] + (i % 4 < 2 ? -half : half);
+        vertices[i][2] = centre[2] + (i % 4 == 0 || i % 4 == 3 ? -half : half);
+    }
+    
+    vertex = &body_vertices[body_vertex_count];
+    for( i = 5; i >= 0; i-- )
+    {
+        for( j = 0; j < 4; j++, vertex++ )
+        {
+            memcpy( vertex->position, vertices[faces[i][j]],
+                    sizeof(GLfloat) * 3 );
+            memcpy( vertex->normal, normals[i], sizeof(GLfloat) * 3 );
+        }
+    }
+    body_vertex_count += CUBE_VERTICES;
+    
+    for( i = 0; i < 3; i++ )
+    {
+        if( centre[i] - half < batch->min[i] )
+            batch->min[i] = centre[i] - half;
+        if( centre[i] + half > batch->max[i] )
+            batch->max[i] = centre[i] + half;
+    }
+}
+
+/**
+ * Draws a sphere centred on the origin.
+ */
+void draw_sphere( float radius, int slices, int stacks )
+{
+    gluSphere( sphere_quadric, radius, slices, stacks );
+    // GLU draws a quad strip per stack
+    render_stats.draw_calls += stacks;
+    render_stats.vertices += stacks * (slices + 1) * 2;
+}
+
+/**
+ * Records a draw call, for the frame's statistics.
+ */
+void count_draw_call( int vertices )
+{
+    render_stats.draw_calls++;
+    render_stats.vertices += vertices;
+}
+
+/**
+ * Works out how far between the snapshot's previous and current state to draw.
+ * 
+ * A snapshot shows the game as of some time `t`, and the previous one as of
+ * `t - tick`. By drawing the game as it was one tick ago, there are always two
+ * states to draw between, until the next snapshot arrives.
+ */
+float interpolation_fraction( RenderSnapshot* snapshot )
+{
+    struct timespec now;
+    float fraction;
+    
+    // Fixed timing draws ticks exactly, so that frames are reproducible
+    if( fixed_timing || snapshot->time <= snapshot->previousTime )
+        return 1.0f;
+    
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    fraction = (now.tv_sec * 1000000000LL + now.tv_nsec - snapshot->time) /
+               (float)(snapshot->time - snapshot->previousTime);
+    
+    if( fraction < 0.0f )
+        return 0.0f;
+    if( fraction > 1.0f )
+        return 1.0f;
+    return fraction;
 }
 
 /**
@@ -644,9 +1114,9 @@ void calc_fps()
     static float time = 0;
     static int last_time = -1;
     
-    int cur_time = glutGet(GLUT_ELAPSED_TIME);
+    int cur_time = fixed_timing ? fixed_time : glutGet(GLUT_ELAPSED_TIME);
     
-    if( last_time == -1 )
+    if( last_time == -1 || cur_time < last_time )
     {
         last_time = cur_time;
         return;
@@ -673,9 +1143,12 @@ void calc_fps()
 /**
  * Renders the HUD on the given viewport.
  */
-void render_hud( Viewport* hud, GameState* gamestate )
+void render_hud( Viewport* hud, RenderSnapshot* snapshot )
 {
-    char fps_string[15];
+    char fps_string[15], pacing_string[64],
+         scale_string[16 + 8 * MAX_SPLIT_VIEWS];
+    int i;
+    PacingStats* pacing = pacing_get_stats();
     // Reload the identity matrix
     glMatrixMode(GL_MODELVIEW);
     glLoadIdentity();
@@ -686,15 +1159,69 @@ void render_hud( Viewport* hud, GameState* gamestate )
     // Draw the FPS
     sprintf( fps_string, "FPS: %3.1f", fps );
     
-    glDisable(GL_LIGHTING);
+    text_begin();
+    text_set_color( 1.0f, 1.0f, 1.0f, 1.0f );
+    text_set_outline( 0.0f, 0.0f, 0.0f, 1.0f );
+    draw_2D_text( fps_string, 4, 580, 16, hud );
+    // Frame pacing, if frames are being paced
+    if( pacing->frames > 0 )
+    {
+        sprintf( pacing_string, "Frame: %.1f +/- %.1f ms  CPU: %.0f%%%s",
+                 pacing->mean_ms, pacing->deviation_ms, pacing->cpu_percent,
+                 pacing->vsync ? "  vsync" : "" );
+        draw_2D_text( pacing_string, 4, 562, 12, hud );
+    }
+    // The players' resolutions, if they're being scaled
+    if( splitscreen_count() > 0 && splitscreen_view(0)->target != NULL &&
+        splitscreen_view(0)->target->budget > 0.0f )
+    {
+        strcpy( scale_string, "Resolution:" );
+        for( i = 0; i < splitscreen_count(); i++ )
+        {
+            sprintf( scale_string + strlen(scale_string), "%s %.0f%%",
+                     i == 0 ? "" : " /",
+                     splitscreen_view(i)->target->scale * 100.0f );
+        }
+        draw_2D_text( scale_string, 4, 548, 12, hud );
+    }
+    // Where the time's going, if it's being measured
+    if( profile_is_enabled() )
+        render_profile( hud );
+    count_draw_call( text_flush() );
+}
+
+/**
+ * Lists the minimum, mean and 99th percentile time of each profiled stage
+ * down the left of the HUD.
+ */
+void render_profile( Viewport* hud )
+{
+    ProfileStats* stats = profile_get_stats();
+    char time_string[16], occluded_string[32];
+    int stage, y = PROFILE_TOP;
     
-    glLineWidth(2.0f);
-    glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
-    draw_2D_text( fps_string, 0, 590, 10, hud );
-    glLineWidth(0.8f);
-    glColor4f(0.0f, 0.0f, 0.0f, 1.0f);
-    draw_2D_text( fps_string, 0, 590, 10, hud );
+    draw_2D_text( "Stage (ms)", 4, y, 12, hud );
+    draw_2D_text( "min", PROFILE_MIN_X, y, 12, hud );
+    draw_2D_text( "avg", PROFILE_MEAN_X, y, 12, hud );
+    draw_2D_text( "p99", PROFILE_P99_X, y, 12, hud );
     
-    glEnable(GL_LIGHTING);
+    for( stage = 0; stage < PROFILE_STAGES; stage++ )
+    {
+        if( stats[stage].samples == 0 )
+            continue;
+        
+        y -= PROFILE_LINE_HEIGHT;
+        draw_2D_text( profile_stage_name(stage), 4, y, 12, hud );
+        sprintf( time_string, "%.2f", stats[stage].min_ms );
+        draw_2D_text( time_string, PROFILE_MIN_X, y, 12, hud );
+        sprintf( time_string, "%.2f", stats[stage].mean_ms );
+        draw_2D_text( time_string, PROFILE_MEAN_X, y, 12, hud );
+        sprintf( time_string, "%.2f", stats[stage].p99_ms );
+        draw_2D_text( time_string, PROFILE_P99_X, y, 12, hud );
+    }
+    
+    // What the views have hidden behind hills this frame
+    sprintf( occluded_string, "Occluded: %d", render_stats.occluded );
+    draw_2D_text( occluded_string, 4, y - PROFILE_LINE_HEIGHT, 12, hud );
 }
 
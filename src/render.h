@@ -1,10 +1,23 @@
 #ifndef RENDER_H_
 #define RENDER_H_
 
+#include "Camera.h"
+
+/**
+ * The backends the game can be rendered through.
+ */
+typedef enum {
+    BACKEND_GLUT, // A GLUT window
+    BACKEND_OFFSCREEN // A headless, offscreen framebuffer (see offscreen.h)
+} RenderBackend;
+
 /**
  * Initializes the module.
+ * 
+ * The backend's OpenGL context must already be current, and a snapshot must
+ * already have been published (see snapshot.h).
  */
-void render_init();
+void render_init( RenderBackend backend );
 
 /**
  * Renders the game.
@@ -14,8 +27,63 @@ void render_init();
  */
 void render();
 
+/**
+ * Picks up the latest snapshot of the game, and moves the cameras on by
+ * `delta` milliseconds. The game is drawn from snapshots only, so this may be
+ * called while the simulation runs on another thread.
+ */
 void render_update( int delta );
 
+/**
+ * Counts of the work submitted to OpenGL for the last frame.
+ */
+typedef struct {
+    int draw_calls; // Batches of primitives (glBegin/glEnd pairs and the like)
+    int vertices; // Vertices submitted
+    // Landscape chunks and objects skipped for being hidden behind the
+    // landscape, over every view
+    int occluded;
+} RenderStats;
+
+/**
+ * Returns the counts for the last frame rendered.
+ */
+RenderStats* render_get_stats();
+
+/**
+ * Makes a player's viewport look through `camera` instead of following the
+ * player. Passing NULL makes it follow the player again.
+ */
+void render_set_camera_override( int player_id, Camera* camera );
+
+/**
+ * Returns true if the game drawn last is being played (rather than paused,
+ * finished or in the menu).
+ */
+int render_game_is_active();
+
+/**
+ * Makes the frame rate shown on the HUD come from the time passed to
+ * `render_update`, rather than the wall clock, and draws each snapshot as it
+ * is rather than interpolating, so that the same sequence of updates always
+ * draws the same frames.
+ */
+void render_set_fixed_timing( int enabled );
+
+/**
+ * Turns on or off skipping what's hidden behind hills (which is on by
+ * default).
+ */
+void render_set_occlusion( int enabled );
+
+/**
+ * Sets how long a frame may take to draw, in milliseconds. The players'
+ * viewports are drawn at a lower resolution while they'd take longer (see
+ * ScaledTarget.h). 0 always draws them at full resolution, as does the
+ * default.
+ */
+void render_set_frame_budget( float milliseconds );
+
 /**
  * The notification function for when the window is resized.
  */
@@ -0,0 +1,211 @@
+#include "replay.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*******************************************************************************
+ * GLOBALS AND CONSTANTS
+ ******************************************************************************/
+// The longest line in a replay
+#define REPLAY_LINE_LENGTH 512
+
+
+/*******************************************************************************
+ * INTERNAL FUNCTION PROTOTYPES
+ ******************************************************************************/
+int read_hash( char* line, int* tick, StateHash* hash );
+void report_divergence( int tick, StateHash* expected, StateHash* actual );
+
+
+/*******************************************************************************
+ * REPLAY FUNCTIONS
+ ******************************************************************************/
+void replay_write_header( FILE* file, MatchSpec* spec, unsigned int seed )
+{
+    const char* name;
+    float value;
+    int i;
+
+    fprintf( file, "# snake-sim replay\n" );
+    fprintf( file, "seed %u\n", seed );
+    fprintf( file, "tick_rate %d\n", spec->tick_rate );
+    for( i = 0; (name = rules_name(i)) != NULL; i++ )
+    {
+        rules_get( &spec->rules, name, &value );
+        fprintf( file, "rule %s %a\n", name, value );
+    }
+}
+
+void replay_write_action( FILE* file, int tick, int player_id, Action action )
+{
+    fprintf( file, "%d %d %s\n", tick, player_id, batch_action_name(action) );
+}
+
+void replay_write_hash( FILE* file, int tick, StateHash* hash )
+{
+    int i;
+
+    fprintf( file, "hash %d %016llx", tick, hash->total );
+    for( i = 0; i < STATE_PARTS; i++ )
+        fprintf( file, " %016llx", hash->parts[i] );
+    fprintf( file, "\n" );
+}
+
+int replay_verify( char* path )
+{
+    FILE* file = fopen( path, "r" );
+    char line[REPLAY_LINE_LENGTH], word[REPLAY_LINE_LENGTH];
+    GameState* gamestate = NULL;
+    StateHasher* hasher = StateHasher_new();
+    StateHash expected, actual;
+    Rules rules;
+    Action action;
+    unsigned int seed = 0;
+    int tick_rate = 0, tick = 0, line_number = 0, event_tick, player_id,
+        matched = 1, malformed = 0;
+    float value;
+
+    if( file == NULL )
+    {
+        fprintf( stderr, "Could not read the replay %s\n", path );
+        StateHasher_delete(hasher);
+        return 0;
+    }
+
+    rules_default(&rules);
+    while( matched && !malformed && fgets( line, sizeof(line), file ) != NULL )
+    {
+        line_number++;
+        if( line[strspn( line, " \t\r\n" )] == '\0' || line[0] == '#' )
+            continue;
+
+        // The settings come first
+        if( gamestate == NULL )
+        {
+            if( sscanf( line, "seed %u", &seed ) == 1 ||
+                sscanf( line, "tick_rate %d", &tick_rate ) == 1 )
+                continue;
+            if( sscanf( line, "rule %s %f", word, &value ) == 2 )
+            {
+                if( !rules_set( &rules, word, value ) )
+                {
+                    fprintf( stderr, "%s:%d: there's no rule called %s\n",
+                             path, line_number, word );
+                    malformed = 1;
+                }
+                continue;
+            }
+            if( tick_rate <= 0 )
+            {
+                fprintf( stderr, "%s:%d: no tick rate before the first "
+                                 "tick\n", path, line_number );
+                malformed = 1;
+                continue;
+            }
+
+            // ... and then the match begins
+            gamestate = GameState_new(seed);
+            gamestate->rules = rules;
+            new_game(gamestate);
+        }
+
+        if( strncmp( line, "hash", 4 ) == 0 )
+        {
+            if( !read_hash( line, &event_tick, &expected ) ||
+                event_tick != tick )
+            {
+                fprintf( stderr, "%s:%d: expected the hash of tick %d\n",
+                         path, line_number, tick );
+                malformed = 1;
+                continue;
+            }
+
+            update_world( gamestate, 1000.0f / tick_rate );
+            StateHasher_hash( hasher, gamestate, &actual );
+            if( actual.total != expected.total )
+            {
+                report_divergence( tick, &expected, &actual );
+                matched = 0;
+            }
+            tick++;
+        }
+        else if( sscanf( line, "%d %d %s", &event_tick, &player_id,
+                         word ) == 3 && event_tick == tick &&
+                 GameState_player( gamestate, player_id ) != NULL &&
+                 batch_parse_action( word, &action ) )
+        {
+            perform_action( gamestate, player_id, action );
+        }
+        else
+        {
+            fprintf( stderr, "%s:%d: expected an action on tick %d, or its "
+                             "hash\n", path, line_number, tick );
+            malformed = 1;
+        }
+    }
+
+    if( matched && !malformed )
+    {
+        printf( "Replayed %d ticks of %s, all as recorded", tick, path );
+        if( tick > 0 )
+            printf( " (final hash %016llx)", actual.total );
+        printf( "\n" );
+    }
+
+    fclose(file);
+    if( gamestate != NULL )
+        GameState_delete(gamestate);
+    StateHasher_delete(hasher);
+
+    return matched && !malformed;
+}
+
+
+/*******************************************************************************
+ * INTERNAL FUNCTIONS
+ ******************************************************************************/
+/**
+ * Reads a hash line. Returns false if it's malformed.
+ */
+int read_hash( char* line, int* tick, StateHash* hash )
+{
+    char* next;
+    int i;
+
+    if( sscanf( line, "hash %d", tick ) != 1 )
+        return 0;
+
+    // Skip "hash" and the tick
+    next = line + strspn( line, "hash \t" );
+    next += strspn( next, "0123456789" );
+
+    hash->total = strtoull( next, &next, 16 );
+    for( i = 0; i < STATE_PARTS; i++ )
+    {
+        if( *next == '\0' || *next == '\n' )
+            return 0;
+        hash->parts[i] = strtoull( next, &next, 16 );
+    }
+
+    return 1;
+}
+
+/**
+ * Prints the tick a replay went differently on, and the parts of the state
+ * that differed.
+ */
+void report_divergence( int tick, StateHash* expected, StateHash* actual )
+{
+    int i;
+
+    printf( "Diverged on tick %d: the state hash was %016llx, but the "
+            "recording has %016llx\n", tick, actual->total, expected->total );
+    for( i = 0; i < STATE_PARTS; i++ )
+    {
+        if( actual->parts[i] == expected->parts[i] )
+            continue;
+
+        printf( "  %-15s %016llx, recorded %016llx\n",
+                StateHasher_partName(i), actual->parts[i],
+                expected->parts[i] );
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef REPLAY_H_
+#define REPLAY_H_
+/**
+ * replay.h
+ * This module records matches as they're played, and replays the records to
+ * check that a build plays them the same way, tick for tick.
+ *
+ * Games are deterministic (see mechanics.h), so a match can be replayed from
+ * its seed, rules and tick rate and the actions taken on each tick, without
+ * the bots or scripts that chose them. Alongside the actions, a replay holds
+ * the hash of the state after every tick (see StateHasher.h), so verifying a
+ * replay finds the first tick on which the game went differently, and which
+ * parts of the state differed.
+ *
+ * A replay is a text file. It begins with the match's settings (with floats
+ * written exactly, in hex), followed, for each tick, by the actions taken on
+ * it, as in a script (see batch.h), and then the hash of the state after it,
+ * in total and by part:
+ *
+ *     seed 5
+ *     tick_rate 60
+ *     rule player_speed 0x1.4p+4
+ *     ...
+ *     hash 0 54e1c6d3f8a12b90 ...
+ *     ...
+ *     250 1 left
+ *     hash 250 9f02be17aa3c4d61 ...
+ */
+
+#include "StateHasher.h"
+#include "batch.h"
+#include <stdio.h>
+
+/*******************************************************************************
+ * REPLAY FUNCTIONS
+ ******************************************************************************/
+/**
+ * Writes the settings a match is played with.
+ */
+void replay_write_header( FILE* file, MatchSpec* spec, unsigned int seed );
+/**
+ * Writes an action taken on a tick.
+ */
+void replay_write_action( FILE* file, int tick, int player_id, Action action );
+/**
+ * Writes the state hash after a tick.
+ */
+void replay_write_hash( FILE* file, int tick, StateHash* hash );
+/**
+ * Replays a recorded match, comparing the state after every tick with the
+ * record's, and says where they first differ, if they do.
+ *
+ * Returns true if the replay went as recorded.
+ */
+int replay_verify( char* path );
+
+#endif /*REPLAY_H_*/
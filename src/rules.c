@@ -0,0 +1,121 @@
+#include "rules.h"
+#include <stddef.h>
+#include <string.h>
+
+/*******************************************************************************
+ * GLOBALS AND CONSTANTS
+ ******************************************************************************/
+// The number of players in a game
+#define PLAYERS 2
+// Points along each side of the landscape's grid
+#define GRID_SIZE 129
+
+// The players' speed, in grid divisions per second
+#define PLAYER_SPEED 20.0f
+// Initial maximum length of a player, in grid divisions
+#define PLAYER_INITIAL_LENGTH 64.0f
+// Player's radius, in grid divisions
+#define PLAYER_RADIUS 0.5f
+
+#define POINTS_FOR_FOOD 100
+// The radius of edibles, in grid divisions
+#define FOOD_RADIUS 3.0f
+// The amount of tail food gives you, in grid divisions
+#define FOOD_LENGTH_INCREMENT 64.0f
+
+// Projectile speed, in grid divisions per second
+#define PROJ_SPEED 3.0f
+// deformation amount is the depth in divisions
+// radius is also in divisions
+#define DEFORMATION_RADIUS 80.0f
+#define DEFORMATION_AMOUNT 2.0f
+
+/**
+ * A rule, by name, and where it is in Rules.
+ */
+typedef struct {
+    const char* name;
+    size_t offset;
+    int integer; // Whether it's an int rather than a float
+} RuleField;
+
+static const RuleField rule_fields[] = {
+    { "players", offsetof( Rules, players ), 1 },
+    { "grid_size", offsetof( Rules, gridSize ), 1 },
+    { "player_speed", offsetof( Rules, playerSpeed ), 0 },
+    { "player_initial_length", offsetof( Rules, playerInitialLength ), 0 },
+    { "player_radius", offsetof( Rules, playerRadius ), 0 },
+    { "points_for_food", offsetof( Rules, pointsForFood ), 1 },
+    { "food_radius", offsetof( Rules, foodRadius ), 0 },
+    { "food_length_increment", offsetof( Rules, foodLengthIncrement ), 0 },
+    { "projectile_speed", offsetof( Rules, projectileSpeed ), 0 },
+    { "deformation_radius", offsetof( Rules, deformationRadius ), 0 },
+    { "deformation_amount", offsetof( Rules, deformationAmount ), 0 }
+};
+#define RULE_FIELDS (sizeof(rule_fields) / sizeof(rule_fields[0]))
+
+
+/*******************************************************************************
+ * RULES FUNCTIONS
+ ******************************************************************************/
+void rules_default( Rules* rules )
+{
+    rules->players = PLAYERS;
+    rules->gridSize = GRID_SIZE;
+    rules->playerSpeed = PLAYER_SPEED;
+    rules->playerInitialLength = PLAYER_INITIAL_LENGTH;
+    rules->playerRadius = PLAYER_RADIUS;
+    rules->pointsForFood = POINTS_FOR_FOOD;
+    rules->foodRadius = FOOD_RADIUS;
+    rules->foodLengthIncrement = FOOD_LENGTH_INCREMENT;
+    rules->projectileSpeed = PROJ_SPEED;
+    rules->deformationRadius = DEFORMATION_RADIUS;
+    rules->deformationAmount = DEFORMATION_AMOUNT;
+}
+
+int rules_set( Rules* rules, const char* name, float value )
+{
+    char* field;
+    unsigned int i;
+
+    for( i = 0; i < RULE_FIELDS; i++ )
+    {
+        if( strcmp( name, rule_fields[i].name ) != 0 )
+            continue;
+
+        field = (char*)rules + rule_fields[i].offset;
+        if( rule_fields[i].integer )
+            *(int*)field = (int)value;
+        else
+            *(float*)field = value;
+        return 1;
+    }
+
+    return 0;
+}
+
+int rules_get( Rules* rules, const char* name, float* value )
+{
+    char* field;
+    unsigned int i;
+
+    for( i = 0; i < RULE_FIELDS; i++ )
+    {
+        if( strcmp( name, rule_fields[i].name ) != 0 )
+            continue;
+
+        field = (char*)rules + rule_fields[i].offset;
+        if( rule_fields[i].integer )
+            *value = *(int*)field;
+        else
+            *value = *(float*)field;
+        return 1;
+    }
+
+    return 0;
+}
+
+const char* rules_name( int i )
+{
+    return i >= 0 && i < (int)RULE_FIELDS ? rule_fields[i].name : NULL;
+}
@@ -0,0 +1,53 @@
+#ifndef RULES_H_
+#define RULES_H_
+/**
+ * rules.h
+ * The numbers the game is played by, which may be changed game by game.
+ *
+ * Each gamestate has its own rules, starting from the defaults, so matches
+ * played side by side can try different values (see snake-sim's --set).
+ * Lengths and distances are in grid divisions, and times in seconds.
+ */
+
+/*******************************************************************************
+ * TYPE DEFINITIONS
+ ******************************************************************************/
+typedef struct {
+    int players; // The number of players in a game
+    // The number of points along each side of the landscape's grid, which is
+    // rounded up to one more than a power of two
+    int gridSize;
+    float playerSpeed; // Grid divisions per second
+    float playerInitialLength; // A player's maximum length to begin with
+    float playerRadius;
+    int pointsForFood;
+    float foodRadius;
+    float foodLengthIncrement; // The length eating an edible adds
+    float projectileSpeed; // Grid divisions per second
+    float deformationRadius; // The radius of a projectile's crater
+    float deformationAmount; // The depth of a projectile's crater
+} Rules;
+
+/*******************************************************************************
+ * RULES FUNCTIONS
+ ******************************************************************************/
+/**
+ * Sets the rules to the game's defaults.
+ */
+void rules_default( Rules* rules );
+/**
+ * Sets the rule called `name` (e.g. "player_speed") to `value`. Returns false
+ * if there's no such rule.
+ */
+int rules_set( Rules* rules, const char* name, float value );
+/**
+ * Gets the value of the rule called `name`. Returns false if there's no such
+ * rule.
+ */
+int rules_get( Rules* rules, const char* name, float* value );
+/**
+ * Returns the name of the `i`th rule, or NULL once past the last.
+ */
+const char* rules_name( int i );
+
+#endif /*RULES_H_*/
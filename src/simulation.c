@@ -0,0 +1,267 @@
+#include "simulation.h"
+#include "snapshot.h"
+#include "profile.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+/*******************************************************************************
+ * TYPE DEFINITIONS
+ ******************************************************************************/
+typedef enum {
+    COMMAND_TURN, COMMAND_FIRE, COMMAND_TOGGLE_PAUSE
+} CommandType;
+
+typedef struct {
+    CommandType type;
+    int player_id;
+    Turn dir;
+} Command;
+
+/*******************************************************************************
+ * GLOBALS AND CONSTANTS
+ ******************************************************************************/
+// The size of the command queue (must be a power of two)
+#define COMMAND_QUEUE_SIZE 64
+
+#define NANOSECONDS_PER_SECOND 1000000000LL
+
+Command command_queue[COMMAND_QUEUE_SIZE];
+// Commands are added at the tail and taken from the head. Each only ever
+// increases, and is written by one side.
+atomic_uint command_head = 0, command_tail = 0;
+
+pthread_t simulation_thread;
+atomic_int simulation_running = 0;
+
+// The game being simulated
+GameState* gamestate = NULL;
+
+int tick_rate = DEFAULT_TICK_RATE;
+int max_catch_up = DEFAULT_MAX_CATCH_UP;
+// The number of players to play with, or 0 for the rules' default
+int player_count = 0;
+
+
+/*******************************************************************************
+ * INTERNAL FUNCTION PROTOTYPES
+ ******************************************************************************/
+void queue_command( CommandType type, int player_id, Turn dir );
+void run_commands();
+void tick( float delta, long long time );
+void* simulation_loop( void* unused );
+long long monotonic_ns();
+
+
+/*******************************************************************************
+ * PUBLIC FUNCTIONS
+ ******************************************************************************/
+void simulation_init( unsigned int seed )
+{
+    if( gamestate == NULL )
+        gamestate = GameState_new(seed);
+    else
+        GameState_seed( gamestate, seed );
+    if( player_count > 0 )
+        gamestate->rules.players = player_count;
+
+    new_game(gamestate);
+    snapshot_init(gamestate);
+}
+
+GameState* simulation_gamestate()
+{
+    return gamestate;
+}
+
+void simulation_configure( int rate, int catch_up )
+{
+    tick_rate = rate;
+    max_catch_up = catch_up;
+}
+
+void simulation_set_players( int players )
+{
+    player_count = players;
+}
+
+void simulation_step( float delta )
+{
+    tick( delta, monotonic_ns() );
+}
+
+int simulation_start()
+{
+    if( atomic_load(&simulation_running) )
+        return 1;
+
+    atomic_store( &simulation_running, 1 );
+    if( pthread_create( &simulation_thread, NULL, simulation_loop, NULL ) != 0 )
+    {
+        atomic_store( &simulation_running, 0 );
+        fprintf( stderr, "Could not start the simulation thread\n" );
+        return 0;
+    }
+
+    return 1;
+}
+
+void simulation_stop()
+{
+    if( !atomic_exchange( &simulation_running, 0 ) )
+        return;
+
+    pthread_join( simulation_thread, NULL );
+}
+
+void simulation_turn( int player_id, Turn dir )
+{
+    queue_command( COMMAND_TURN, player_id, dir );
+}
+
+void simulation_fire( int player_id )
+{
+    queue_command( COMMAND_FIRE, player_id, TURN_LEFT );
+}
+
+void simulation_toggle_pause()
+{
+    queue_command( COMMAND_TOGGLE_PAUSE, 0, TURN_LEFT );
+}
+
+
+/*******************************************************************************
+ * INTERNAL FUNCTIONS
+ ******************************************************************************/
+void queue_command( CommandType type, int player_id, Turn dir )
+{
+    unsigned int tail = atomic_load_explicit( &command_tail,
+                                              memory_order_relaxed );
+    Command* command;
+
+    // Drop the command if the queue is full
+    if( tail - atomic_load_explicit( &command_head, memory_order_acquire )
+            >= COMMAND_QUEUE_SIZE )
+    {
+        return;
+    }
+
+    command = &command_queue[tail & (COMMAND_QUEUE_SIZE - 1)];
+    command->type = type;
+    command->player_id = player_id;
+    command->dir = dir;
+
+    atomic_store_explicit( &command_tail, tail + 1, memory_order_release );
+}
+
+/**
+ * Carries out every queued command.
+ */
+void run_commands()
+{
+    unsigned int head = atomic_load_explicit( &command_head,
+                                              memory_order_relaxed ),
+                 tail = atomic_load_explicit( &command_tail,
+                                              memory_order_acquire );
+    Command* command;
+
+    for( ; head != tail; head++ )
+    {
+        command = &command_queue[head & (COMMAND_QUEUE_SIZE - 1)];
+
+        switch( command->type )
+        {
+        case COMMAND_TURN:
+            change_player_direction( gamestate, command->player_id,
+                                     command->dir );
+            break;
+        case COMMAND_FIRE:
+            fire_player_weapon( gamestate, command->player_id );
+            break;
+        case COMMAND_TOGGLE_PAUSE:
+            if( is_running(gamestate) )
+                pause_game(gamestate);
+            else if( is_paused(gamestate) )
+                resume_game(gamestate);
+            else
+                new_game(gamestate);
+            break;
+        }
+    }
+
+    atomic_store_explicit( &command_head, head, memory_order_release );
+}
+
+/**
+ * Runs one step, and publishes it as showing the game as of `time`.
+ */
+void tick( float delta, long long time )
+{
+    long long tick_start = PROFILE_BEGIN(), start;
+
+    run_commands();
+    update_world( gamestate, delta );
+
+    start = PROFILE_BEGIN();
+    snapshot_publish( gamestate, time );
+    PROFILE_END( PROFILE_PUBLISH, start );
+
+    PROFILE_END( PROFILE_TICK, tick_start );
+    PROFILE_COUNTER( PROFILE_ALLOCATIONS, profile_take_allocations() );
+}
+
+/**
+ * The simulation thread. Runs a tick for each tick's worth of time that has
+ * passed, then sleeps until the next is due.
+ */
+void* simulation_loop( void* unused )
+{
+    long long tick_length = NANOSECONDS_PER_SECOND / tick_rate,
+              accumulator = 0, last_time = monotonic_ns(), now;
+    float delta = 1000.0f / tick_rate;
+    struct timespec wait;
+    int ticks;
+
+    profile_name_thread("simulation");
+
+    while( atomic_load(&simulation_running) )
+    {
+        now = monotonic_ns();
+        accumulator += now - last_time;
+        last_time = now;
+
+        for( ticks = 0; accumulator >= tick_length && ticks < max_catch_up;
+             ticks++ )
+        {
+            accumulator -= tick_length;
+            // The game is now as it should be `accumulator` ago
+            tick( delta, now - accumulator );
+        }
+
+        // Too far behind to catch up, so let the time go
+        if( accumulator >= tick_length )
+            accumulator %= tick_length;
+
+        // Sleep until the next tick is due
+        wait.tv_sec = (tick_length - accumulator) / NANOSECONDS_PER_SECOND;
+        wait.tv_nsec = (tick_length - accumulator) % NANOSECONDS_PER_SECOND;
+        nanosleep( &wait, NULL );
+    }
+
+    return NULL;
+}
+
+/**
+ * Returns the time from a clock that only ever moves forward, in
+ * nanoseconds.
+ */
+long long monotonic_ns()
+{
+    struct timespec now;
+
+    clock_gettime( CLOCK_MONOTONIC, &now );
+
+    return now.tv_sec * NANOSECONDS_PER_SECOND + now.tv_nsec;
+}
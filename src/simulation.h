@@ -0,0 +1,90 @@
+#ifndef SIMULATION_H_
+#define SIMULATION_H_
+/**
+ * simulation.h
+ * This module runs the game's simulation, optionally on a thread of its own.
+ *
+ * Each step of the simulation carries out any commands queued by the input
+ * module, updates the world, and publishes a snapshot for the renderer (see
+ * snapshot.h). Run on its own thread, the simulation keeps stepping however
+ * long frames take to draw, and frames are drawn however long steps take.
+ *
+ * On its own thread the simulation runs at a fixed tick rate, whatever the
+ * frame rate. Real time (from the monotonic clock) is added to an accumulator,
+ * and a tick is run for each whole tick's worth of time in it. If it falls
+ * behind, it runs at most a set number of ticks to catch up and drops the
+ * rest of the time, so a stall slows the game down rather than making every
+ * following step slower still. The renderer draws between the last two ticks
+ * (see `snapshot_interpolate`), so movement stays smooth at any frame rate.
+ *
+ * Commands are queued rather than applied straight away because they usually
+ * come from another thread (GLUT's). The queue is lock free, with a single
+ * producer and a single consumer; if it fills up, commands are dropped.
+ */
+
+#include "mechanics.h"
+
+// Ticks per second, unless told otherwise
+#define DEFAULT_TICK_RATE 60
+// The most ticks run at once to catch up, unless told otherwise
+#define DEFAULT_MAX_CATCH_UP 5
+
+/**
+ * Starts a new game, with random numbers from `seed`, and publishes its first
+ * snapshot.
+ */
+void simulation_init( unsigned int seed );
+
+/**
+ * Returns the game being simulated. Only to be used on the simulation's
+ * thread, or while it isn't running.
+ */
+GameState* simulation_gamestate();
+
+/**
+ * Sets the number of ticks per second, and the most ticks run at once to
+ * catch up after falling behind. Takes effect when the thread next starts.
+ */
+void simulation_configure( int tick_rate, int max_catch_up );
+
+/**
+ * Sets the number of players in the games started from the next call to
+ * simulation_init on, or 0 for as many as the rules say by default.
+ */
+void simulation_set_players( int players );
+
+/**
+ * Carries out queued commands, updates the world by `delta` milliseconds and
+ * publishes a snapshot.
+ */
+void simulation_step( float delta );
+
+/**
+ * Starts ticking the simulation on its own thread, in real time.
+ *
+ * Returns false if the thread couldn't be started.
+ */
+int simulation_start();
+
+/**
+ * Stops the simulation thread, if it's running, and waits for it to finish.
+ */
+void simulation_stop();
+
+/**
+ * Queues a change of direction for a player.
+ */
+void simulation_turn( int player_id, Turn dir );
+
+/**
+ * Queues the firing of a player's weapon.
+ */
+void simulation_fire( int player_id );
+
+/**
+ * Queues a pause, resume or restart, depending on whether the game is running,
+ * paused or over.
+ */
+void simulation_toggle_pause();
+
+#endif /*SIMULATION_H_*/
@@ -0,0 +1,560 @@
+/**
+ * snakesim.c
+ * Plays batches of matches without drawing them, as fast as they'll go.
+ *
+ * snake-sim links only the simulation library (see the makefile), so it needs
+ * neither GL nor a display. Matches are spread over a pool of threads (see
+ * batch.h), one per core unless told otherwise. Each player is played by a
+ * bot (see Bot.h), follows a script, or just goes straight on, and any of the
+ * game's rules (see rules.h) may be changed for the batch, e.g.
+ *
+ *     snake-sim --seeds 1-10000 --set player_speed=25 --results speed25.csv
+ *
+ * Matches may have up to BATCH_MAX_PLAYERS players, on bigger maps:
+ *
+ *     snake-sim --seeds 1-1000 --set players=16 --set grid_size=257
+ *
+ * The results of each match go to a CSV file, one line per seed, and a
+ * summary is printed at the end.
+ *
+ * A match can also be recorded as a replay, and the replay verified later,
+ * by this build or another, to find where they play it differently (see
+ * replay.h):
+ *
+ *     snake-sim --seed 42 --record match42.replay
+ *     snake-sim --verify match42.replay
+ */
+
+#include "batch.h"
+#include "replay.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/*******************************************************************************
+ * GLOBALS AND CONSTANTS
+ ******************************************************************************/
+// Matches to play, unless told otherwise
+#define DEFAULT_MATCHES 100
+
+// The controllers' names, in the order of Controller
+static char* controller_names[] = { "bot", "script", "idle" };
+#define CONTROLLERS 3
+
+
+/*******************************************************************************
+ * TYPE DEFINITIONS
+ ******************************************************************************/
+/**
+ * Options given on the command line.
+ */
+typedef struct {
+    MatchSpec spec;
+    int threads;
+    // The script scripted players follow, or NULL
+    char* script_path;
+    // Where to write each match's results, or NULL
+    char* results_path;
+    // Play the batch again on 1, 2, 4... threads, to see how it scales
+    int scaling;
+    // Where to record the first match as a replay, or NULL
+    char* record_path;
+    // A replay to verify instead of playing a batch, or NULL
+    char* verify_path;
+} Options;
+
+
+/*******************************************************************************
+ * FUNCTION PROTOTYPES
+ ******************************************************************************/
+int parse_options( int argc, char** argv, Options* options );
+int parse_controllers( char* list, MatchSpec* spec );
+int parse_rule( char* setting, MatchSpec* spec );
+void print_usage( char* program );
+double play_batch( Options* options, int threads, MatchResult* results );
+void print_summary( Options* options, MatchResult* results, double elapsed );
+void print_scaling( Options* options, MatchResult* results, double elapsed );
+int write_results( char* path, MatchSpec* spec, MatchResult* results );
+double clock_ms();
+
+
+/*******************************************************************************
+ * ENTRY POINT
+ ******************************************************************************/
+int main( int argc, char** argv )
+{
+    Options options;
+    MatchResult* results;
+    double elapsed;
+    int i, status = 0;
+
+    if( !parse_options( argc, argv, &options ) )
+    {
+        print_usage( argv[0] );
+        return 2;
+    }
+
+    if( options.verify_path != NULL )
+        return replay_verify( options.verify_path ) ? 0 : 1;
+
+    if( options.spec.rules.players < 1 ||
+        options.spec.rules.players > BATCH_MAX_PLAYERS )
+    {
+        fprintf( stderr, "Matches may have from 1 to %d players\n",
+                 BATCH_MAX_PLAYERS );
+        return 2;
+    }
+    for( i = 0; i < options.spec.rules.players; i++ )
+    {
+        if( options.spec.controllers[i] == CONTROLLER_SCRIPT &&
+            options.script_path == NULL )
+        {
+            fprintf( stderr, "Player %d is scripted, but there's no "
+                             "--script\n", i + 1 );
+            return 2;
+        }
+    }
+    if( options.script_path != NULL )
+    {
+        options.spec.script = batch_read_script( options.script_path,
+                                                 &options.spec.script_length );
+        if( options.spec.script == NULL )
+            return 1;
+    }
+
+    results = (MatchResult*)calloc( options.spec.matches > 0 ?
+                                    options.spec.matches : 1,
+                                    sizeof(MatchResult) );
+
+    if( options.record_path != NULL )
+    {
+        // Only the first match is recorded
+        options.spec.matches = 1;
+        options.threads = 1;
+        elapsed = clock_ms();
+        if( !batch_record_match( &options.spec, options.spec.first_seed,
+                                 options.record_path, results ) )
+        {
+            status = 1;
+        }
+        print_summary( &options, results, clock_ms() - elapsed );
+    }
+    else
+    {
+        elapsed = play_batch( &options, options.threads, results );
+        print_summary( &options, results, elapsed );
+        if( options.scaling )
+            print_scaling( &options, results, elapsed );
+    }
+
+    if( options.results_path != NULL &&
+        !write_results( options.results_path, &options.spec, results ) )
+    {
+        status = 1;
+    }
+
+    free(results);
+    free(options.spec.script);
+
+    return status;
+}
+
+
+/*******************************************************************************
+ * FUNCTIONS
+ ******************************************************************************/
+/**
+ * Plays the batch on the given number of threads, and returns how long it
+ * took, in milliseconds.
+ */
+double play_batch( Options* options, int threads, MatchResult* results )
+{
+    double start = clock_ms();
+
+    batch_run( &options->spec, threads, results );
+
+    return clock_ms() - start;
+}
+
+/**
+ * Prints totals and means over the batch, and how fast it was played.
+ */
+void print_summary( Options* options, MatchResult* results, double elapsed )
+{
+    MatchSpec* spec = &options->spec;
+    int matches = spec->matches, players = spec->rules.players, finished = 0,
+        wins[BATCH_MAX_PLAYERS + 1] = { 0 }, i, j;
+    long long ticks = 0, scores[BATCH_MAX_PLAYERS] = { 0 }, deformations = 0;
+    double lengths[BATCH_MAX_PLAYERS] = { 0 }, seconds = elapsed / 1000.0,
+           per_match = matches > 0 ? 1.0 / matches : 0.0;
+
+    for( i = 0; i < matches; i++ )
+    {
+        finished += results[i].finished;
+        wins[results[i].winner]++;
+        ticks += results[i].ticks;
+        for( j = 0; j < players; j++ )
+        {
+            scores[j] += results[i].scores[j];
+            lengths[j] += results[i].lengths[j];
+        }
+        deformations += results[i].deformations;
+    }
+
+    printf( "Played %d matches (%d finished, %d stopped at %d ticks) "
+            "in %.3f s on %d threads\n", matches, finished,
+            matches - finished, spec->max_ticks, seconds, options->threads );
+    printf( "Wins:" );
+    for( j = 0; j < players; j++ )
+        printf( " player %d %d,", j + 1, wins[j + 1] );
+    printf( " neither %d\n", wins[0] );
+    printf( "Mean score:" );
+    for( j = 0; j < players; j++ )
+        printf( "%s player %d %.2f", j > 0 ? "," : "", j + 1,
+                scores[j] * per_match );
+    printf( "\nMean length:" );
+    for( j = 0; j < players; j++ )
+        printf( "%s player %d %.2f", j > 0 ? "," : "", j + 1,
+                lengths[j] * per_match );
+    printf( "\n" );
+    printf( "Mean duration: %.1f ticks (%.2f s), %.2f deformations\n",
+            ticks * per_match, ticks * per_match / spec->tick_rate,
+            deformations * per_match );
+    if( seconds > 0 )
+    {
+        printf( "%.1f matches per second (%.1f per thread), %.0f ticks "
+                "per second\n", matches / seconds,
+                matches / seconds / options->threads, ticks / seconds );
+    }
+}
+
+/**
+ * Plays the batch again on 1, 2, 4... threads, up to the number it was
+ * first played on, and prints how the speed scales.
+ */
+void print_scaling( Options* options, MatchResult* results, double elapsed )
+{
+    int threads = 1, matches = options->spec.matches;
+    double single = 0.0, taken;
+
+    printf( "\n%7s %12s %8s %10s\n", "threads", "matches/s", "speedup",
+            "efficiency" );
+    while( 1 )
+    {
+        // The full number's already been timed
+        taken = threads == options->threads ?
+                elapsed : play_batch( options, threads, results );
+        if( threads == 1 )
+            single = taken;
+
+        printf( "%7d %12.1f %7.2fx %9.0f%%\n", threads,
+                taken > 0 ? matches / (taken / 1000.0) : 0.0,
+                taken > 0 ? single / taken : 0.0,
+                taken > 0 ? 100.0 * single / taken / threads : 0.0 );
+
+        if( threads >= options->threads )
+            break;
+        threads = threads * 2 < options->threads ? threads * 2 :
+                                                   options->threads;
+    }
+}
+
+/**
+ * Writes each match's results to a CSV file, with a header line. There's a
+ * score and a length column for each player.
+ *
+ * Returns false if the file couldn't be written.
+ */
+int write_results( char* path, MatchSpec* spec, MatchResult* results )
+{
+    FILE* file = fopen( path, "w" );
+    MatchResult* result;
+    int players = spec->rules.players, i, j;
+
+    if( file == NULL )
+    {
+        fprintf( stderr, "Could not write the results to %s\n", path );
+        return 0;
+    }
+
+    fprintf( file, "seed,finished,winner" );
+    for( j = 0; j < players; j++ )
+        fprintf( file, ",score%d", j + 1 );
+    for( j = 0; j < players; j++ )
+        fprintf( file, ",length%d", j + 1 );
+    fprintf( file, ",ticks,seconds,deformations,hash\n" );
+    for( i = 0; i < spec->matches; i++ )
+    {
+        result = &results[i];
+        fprintf( file, "%u,%d,%d", result->seed, result->finished,
+                 result->winner );
+        for( j = 0; j < players; j++ )
+            fprintf( file, ",%d", result->scores[j] );
+        for( j = 0; j < players; j++ )
+            fprintf( file, ",%.2f", result->lengths[j] );
+        fprintf( file, ",%d,%.3f,%u,%016llx\n", result->ticks,
+                 result->ticks / (float)spec->tick_rate,
+                 result->deformations, result->hash );
+    }
+
+    fclose(file);
+    return 1;
+}
+
+/**
+ * Reads the options from the command line.
+ *
+ * Returns false if the options are malformed.
+ */
+int parse_options( int argc, char** argv, Options* options )
+{
+    unsigned int last_seed;
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    int controllers_given = 0, i;
+
+    batch_default_spec(&options->spec);
+    options->spec.matches = DEFAULT_MATCHES;
+    options->threads = cores > 0 ? cores : 1;
+    options->script_path = NULL;
+    options->results_path = NULL;
+    options->scaling = 0;
+    options->record_path = NULL;
+    options->verify_path = NULL;
+
+    for( i = 1; i < argc; i++ )
+    {
+        if( strcmp( argv[i], "--matches" ) == 0 )
+        {
+            if( i + 1 >= argc ||
+                sscanf( argv[++i], "%d", &options->spec.matches ) != 1 ||
+                options->spec.matches < 0 )
+            {
+                return 0;
+            }
+        }
+        else if( strcmp( argv[i], "--seed" ) == 0 )
+        {
+            if( i + 1 >= argc ||
+                sscanf( argv[++i], "%u", &options->spec.first_seed ) != 1 )
+            {
+                return 0;
+            }
+        }
+        else if( strcmp( argv[i], "--seeds" ) == 0 )
+        {
+            if( i + 1 >= argc ||
+                sscanf( argv[++i], "%u-%u", &options->spec.first_seed,
+                        &last_seed ) != 2 ||
+                last_seed < options->spec.first_seed )
+            {
+                return 0;
+            }
+            options->spec.matches = last_seed - options->spec.first_seed + 1;
+        }
+        else if( strcmp( argv[i], "--controllers" ) == 0 )
+        {
+            if( i + 1 >= argc ||
+                !parse_controllers( argv[++i], &options->spec ) )
+            {
+                return 0;
+            }
+            controllers_given = 1;
+        }
+        else if( strcmp( argv[i], "--script" ) == 0 )
+        {
+            if( i + 1 >= argc )
+                return 0;
+            options->script_path = argv[++i];
+        }
+        else if( strcmp( argv[i], "--set" ) == 0 )
+        {
+            if( i + 1 >= argc || !parse_rule( argv[++i], &options->spec ) )
+                return 0;
+        }
+        else if( strcmp( argv[i], "--tick-rate" ) == 0 )
+        {
+            if( i + 1 >= argc ||
+                sscanf( argv[++i], "%d", &options->spec.tick_rate ) != 1 ||
+                options->spec.tick_rate <= 0 )
+            {
+                return 0;
+            }
+        }
+        else if( strcmp( argv[i], "--max-ticks" ) == 0 )
+        {
+            if( i + 1 >= argc ||
+                sscanf( argv[++i], "%d", &options->spec.max_ticks ) != 1 ||
+                options->spec.max_ticks <= 0 )
+            {
+                return 0;
+            }
+        }
+        else if( strcmp( argv[i], "--threads" ) == 0 )
+        {
+            if( i + 1 >= argc ||
+                sscanf( argv[++i], "%d", &options->threads ) != 1 ||
+                options->threads <= 0 )
+            {
+                return 0;
+            }
+        }
+        else if( strcmp( argv[i], "--results" ) == 0 )
+        {
+            if( i + 1 >= argc )
+                return 0;
+            options->results_path = argv[++i];
+        }
+        else if( strcmp( argv[i], "--scaling" ) == 0 )
+        {
+            options->scaling = 1;
+        }
+        else if( strcmp( argv[i], "--record" ) == 0 )
+        {
+            if( i + 1 >= argc )
+                return 0;
+            options->record_path = argv[++i];
+        }
+        else if( strcmp( argv[i], "--verify" ) == 0 )
+        {
+            if( i + 1 >= argc )
+                return 0;
+            options->verify_path = argv[++i];
+        }
+        else if( strcmp( argv[i], "--verbose" ) == 0 )
+        {
+            options->spec.verbose = 1;
+        }
+        else
+        {
+            return 0;
+        }
+    }
+
+    // A script on its own is for every player
+    if( options->script_path != NULL && !controllers_given )
+    {
+        for( i = 0; i < BATCH_MAX_PLAYERS; i++ )
+            options->spec.controllers[i] = CONTROLLER_SCRIPT;
+    }
+
+    return 1;
+}
+
+/**
+ * Reads the players' controllers, e.g. "bot,script", in order of player. The
+ * last one given controls the rest of the players, so "bot" has bots play
+ * every player.
+ *
+ * Returns false if the list is malformed.
+ */
+int parse_controllers( char* list, MatchSpec* spec )
+{
+    char* name = list, *comma;
+    size_t length;
+    int player, i = 0;
+
+    for( player = 0; player < BATCH_MAX_PLAYERS; player++ )
+    {
+        if( name != NULL )
+        {
+            comma = strchr( name, ',' );
+            length = comma != NULL ? (size_t)(comma - name) : strlen(name);
+
+            for( i = 0; i < CONTROLLERS; i++ )
+            {
+                if( strlen( controller_names[i] ) == length &&
+                    strncmp( name, controller_names[i], length ) == 0 )
+                    break;
+            }
+            if( i == CONTROLLERS )
+                return 0;
+            name = comma != NULL ? comma + 1 : NULL;
+        }
+        spec->controllers[player] = (Controller)i;
+    }
+
+    // More controllers than players
+    return name == NULL;
+}
+
+/**
+ * Reads a change to the rules, e.g. "player_speed=25".
+ *
+ * Returns false if it's malformed, or there's no such rule.
+ */
+int parse_rule( char* setting, MatchSpec* spec )
+{
+    char name[64];
+    float value;
+
+    if( sscanf( setting, "%63[^=]=%f", name, &value ) != 2 )
+        return 0;
+    if( !rules_set( &spec->rules, name, value ) )
+    {
+        fprintf( stderr, "There's no rule called %s\n", name );
+        return 0;
+    }
+
+    return 1;
+}
+
+void print_usage( char* program )
+{
+    int i;
+
+    fprintf( stderr, "Usage: %s [--matches N] [--seed N] [--seeds FIRST-LAST] "
+                     "[--threads N]\n"
+                     "           [--controllers C[,C]...] [--script FILE] "
+                     "[--set RULE=VALUE]...\n"
+                     "           [--tick-rate N] [--max-ticks N] "
+                     "[--results FILE] [--scaling] [--verbose]\n"
+                     "           [--record FILE]\n"
+                     "       %s --verify FILE\n"
+                     "  --matches     number of matches to play (default %d)\n"
+                     "  --seed        seed of the first match (default 1); "
+                     "each match after\n"
+                     "                has the next seed\n"
+                     "  --seeds       play one match for each seed from "
+                     "FIRST to LAST\n"
+                     "  --threads     threads to play on (default: one per "
+                     "core)\n"
+                     "  --controllers who plays each player, in order: bot, "
+                     "script or idle; the\n"
+                     "                last plays the rest (default bot, or "
+                     "script with --script)\n"
+                     "  --script      the script scripted players follow\n"
+                     "  --set         change one of the rules for every "
+                     "match\n"
+                     "  --tick-rate   ticks per second of game time\n"
+                     "  --max-ticks   ticks after which a match is stopped\n"
+                     "  --results     write each match's results to FILE, "
+                     "as CSV\n"
+                     "  --scaling     play the batch again on 1, 2, 4... "
+                     "threads, and show\n"
+                     "                how the speed scales\n"
+                     "  --verbose     print what happens in each match\n"
+                     "  --record      play only the first match, and record "
+                     "it to FILE as a\n"
+                     "                replay\n"
+                     "  --verify      replay a recorded match, and say where "
+                     "it goes differently\n"
+                     "Rules:",
+             program, program, DEFAULT_MATCHES );
+    for( i = 0; rules_name(i) != NULL; i++ )
+        fprintf( stderr, " %s", rules_name(i) );
+    fprintf( stderr, "\n" );
+}
+
+/**
+ * Returns the time on the monotonic clock, in milliseconds.
+ */
+double clock_ms()
+{
+    struct timespec now;
+
+    clock_gettime( CLOCK_MONOTONIC, &now );
+
+    return now.tv_sec * 1000.0 + now.tv_nsec / 1000000.0;
+}
@@ -0,0 +1,328 @@
+#include "snapshot.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+
+/*******************************************************************************
+ * GLOBALS AND CONSTANTS
+ ******************************************************************************/
+#define SNAPSHOT_SLOTS 3
+
+// Set in `latest_slot` when it holds a snapshot the renderer hasn't seen
+#define SLOT_FRESH 4
+#define SLOT_INDEX 3
+
+// Objects that move further than this between snapshots have been replaced
+// by a new one, rather than moved, so aren't interpolated
+#define MAX_OBJECT_STEP 1.0f
+
+RenderSnapshot snapshot_slots[SNAPSHOT_SLOTS];
+
+// The slot being filled by the simulation, and the one drawn by the renderer
+int writing_slot = 0, reading_slot = 1;
+// The slot last published, which the next snapshot's previous positions come
+// from. Only the simulation writes slots, so it may read this one even while
+// the renderer is drawing it.
+int published_slot = 2;
+// The slot holding the latest finished snapshot
+atomic_int latest_slot = 2;
+
+
+/*******************************************************************************
+ * INTERNAL FUNCTION PROTOTYPES
+ ******************************************************************************/
+void fill_snapshot( RenderSnapshot* snapshot, GameState* gamestate );
+void copy_player( PlayerSnapshot* copy, Player* player, Landscape* landscape,
+                  PlayerSnapshot* previous, int same_game );
+void copy_object( ObjectSnapshot* copy, ObjectPool* pool,
+                  ObjectHandle handle, ObjectSnapshot* previous,
+                  int same_game );
+void interpolate_point( float result[3], float from[3], float to[3],
+                        float fraction );
+float distance_squared( float a[3], float b[3] );
+void copy_landscape( RenderSnapshot* snapshot, GameState* gamestate );
+void fit_players( RenderSnapshot* snapshot, int count );
+
+
+/*******************************************************************************
+ * PUBLIC FUNCTIONS
+ ******************************************************************************/
+void snapshot_init( GameState* gamestate )
+{
+    snapshot_shutdown();
+
+    writing_slot = 0;
+    reading_slot = 1;
+    published_slot = 2;
+    atomic_store( &latest_slot, 2 );
+
+    // Fill the latest slot first, so the others have something to be
+    // "previous" to
+    fill_snapshot( &snapshot_slots[published_slot], gamestate );
+    fill_snapshot( &snapshot_slots[writing_slot], gamestate );
+    fill_snapshot( &snapshot_slots[reading_slot], gamestate );
+}
+
+void snapshot_shutdown()
+{
+    int i, j;
+
+    for( i = 0; i < SNAPSHOT_SLOTS; i++ )
+    {
+        for( j = 0; j < snapshot_slots[i].playerCapacity; j++ )
+        {
+            free( snapshot_slots[i].players[j].body );
+            free( snapshot_slots[i].players[j].runs );
+        }
+        free( snapshot_slots[i].players );
+        free( snapshot_slots[i].projectiles );
+        Landscape_delete( snapshot_slots[i].landscape );
+        memset( &snapshot_slots[i], 0, sizeof(RenderSnapshot) );
+    }
+}
+
+void snapshot_publish( GameState* gamestate, long long time )
+{
+    RenderSnapshot* snapshot = &snapshot_slots[writing_slot];
+
+    fill_snapshot( snapshot, gamestate );
+    snapshot->previousTime = snapshot_slots[published_slot].time;
+    snapshot->time = time;
+    published_slot = writing_slot;
+
+    // Swap the finished snapshot for whichever was latest, which the renderer
+    // either never saw, or has finished with
+    writing_slot = atomic_exchange( &latest_slot, writing_slot | SLOT_FRESH )
+                   & SLOT_INDEX;
+}
+
+RenderSnapshot* snapshot_acquire()
+{
+    // Only swap if there's something new, or we'd hand back an older snapshot
+    if( atomic_load(&latest_slot) & SLOT_FRESH )
+    {
+        reading_slot = atomic_exchange( &latest_slot, reading_slot )
+                       & SLOT_INDEX;
+    }
+
+    return &snapshot_slots[reading_slot];
+}
+
+void snapshot_interpolate( RenderSnapshot* snapshot, float fraction,
+                           RenderSnapshot* result )
+{
+    PlayerSnapshot* players = result->players;
+    ObjectSnapshot* projectiles = result->projectiles;
+    int capacity = result->playerCapacity, i;
+
+    // The result's arrays are its own, since their contents are changed
+    if( capacity < snapshot->playerCount )
+    {
+        capacity = snapshot->playerCount;
+        players = (PlayerSnapshot*)realloc( players,
+                                            sizeof(PlayerSnapshot) * capacity );
+        projectiles = (ObjectSnapshot*)realloc( projectiles,
+                                        sizeof(ObjectSnapshot) * capacity );
+    }
+    *result = *snapshot;
+    result->players = players;
+    result->projectiles = projectiles;
+    result->playerCapacity = capacity;
+    memcpy( players, snapshot->players,
+            sizeof(PlayerSnapshot) * snapshot->playerCount );
+    memcpy( projectiles, snapshot->projectiles,
+            sizeof(ObjectSnapshot) * snapshot->playerCount );
+
+    for( i = 0; i < result->playerCount; i++ )
+    {
+        interpolate_point( players[i].headPosition,
+                           players[i].previousHeadPosition,
+                           players[i].headPosition, fraction );
+        interpolate_point( players[i].tailPosition,
+                           players[i].previousTailPosition,
+                           players[i].tailPosition, fraction );
+        interpolate_point( players[i].forward, players[i].previousForward,
+                           players[i].forward, fraction );
+        interpolate_point( players[i].up, players[i].previousUp,
+                           players[i].up, fraction );
+        interpolate_point( projectiles[i].position,
+                           projectiles[i].previousPosition,
+                           projectiles[i].position, fraction );
+    }
+    interpolate_point( result->edible.position,
+                       result->edible.previousPosition,
+                       result->edible.position, fraction );
+}
+
+
+/*******************************************************************************
+ * INTERNAL FUNCTIONS
+ ******************************************************************************/
+void fill_snapshot( RenderSnapshot* snapshot, GameState* gamestate )
+{
+    RenderSnapshot* previous = &snapshot_slots[published_slot];
+    // Things only move smoothly within a game
+    int same_game = previous->landscape != NULL &&
+                    previous->generation == gamestate->generation &&
+                    previous->playerCount == gamestate->playerCount;
+    int i;
+
+    // The landscape goes first, since it needs the previous generation
+    copy_landscape( snapshot, gamestate );
+
+    snapshot->generation = gamestate->generation;
+    snapshot->mode = gamestate->mode;
+    snapshot->countdown = gamestate->countdown;
+
+    fit_players( snapshot, gamestate->playerCount );
+    for( i = 0; i < gamestate->playerCount; i++ )
+    {
+        copy_player( &snapshot->players[i], gamestate->players[i],
+                     gamestate->landscape, &previous->players[i], same_game );
+        copy_object( &snapshot->projectiles[i], gamestate->projectiles,
+                     gamestate->playerProjectiles[i],
+                     &previous->projectiles[i], same_game );
+    }
+    copy_object( &snapshot->edible, gamestate->edibles, gamestate->edible,
+                 &previous->edible, same_game );
+}
+
+void copy_player( PlayerSnapshot* copy, Player* player, Landscape* landscape,
+                  PlayerSnapshot* previous, int same_game )
+{
+    int i;
+
+    // Players going through a wall jump to the other side, so don't slide
+    // them across the map
+    if( !same_game || previous->underGround != player->underGround )
+        previous = NULL;
+    memcpy( copy->previousHeadPosition, previous == NULL ?
+            player->headPosition : previous->headPosition, sizeof(float) * 3 );
+    memcpy( copy->previousTailPosition, previous == NULL ?
+            player->tailPosition : previous->tailPosition, sizeof(float) * 3 );
+    memcpy( copy->previousForward, previous == NULL ?
+            player->forward : previous->forward, sizeof(float) * 3 );
+    memcpy( copy->previousUp, previous == NULL ?
+            player->up : previous->up, sizeof(float) * 3 );
+
+    memcpy( copy->headPosition, player->headPosition, sizeof(float) * 3 );
+    memcpy( copy->tailPosition, player->tailPosition, sizeof(float) * 3 );
+    memcpy( copy->forward, player->forward, sizeof(float) * 3 );
+    memcpy( copy->up, player->up, sizeof(float) * 3 );
+    memcpy( copy->color, player->color, sizeof(float) * 3 );
+    copy->radius = player->radius;
+    copy->score = player->score;
+    copy->underGround = player->underGround;
+
+    // The joints between the head and tail (the renderer draws those two
+    // from their exact positions), where they are on the landscape now
+    copy->bodyLength = player->jointCount < 2 ? 0 : player->jointCount - 2;
+    copy->bodySerial = player->jointsLaid - 2;
+    copy->groundVersion = landscape->version;
+    if( copy->bodyLength > copy->bodyCapacity )
+    {
+        copy->bodyCapacity = copy->bodyCapacity == 0 ? 64 : copy->bodyCapacity;
+        while( copy->bodyCapacity < copy->bodyLength )
+            copy->bodyCapacity *= 2;
+        copy->body = (Point*)realloc( copy->body,
+                                      sizeof(Point) * copy->bodyCapacity );
+    }
+    for( i = 0; i < copy->bodyLength; i++ )
+    {
+        memcpy( copy->body[i], Player_jointPosition( player, i + 1, landscape ),
+                sizeof(Point) );
+    }
+
+    if( player->runCount > copy->runCapacity )
+    {
+        copy->runCapacity = player->runCapacity;
+        copy->runs = (BodyRun*)realloc( copy->runs,
+                                        sizeof(BodyRun) * copy->runCapacity );
+    }
+    copy->runCount = player->runCount;
+    for( i = 0; i < player->runCount; i++ )
+        copy->runs[i] = *Player_run( player, i );
+}
+
+void copy_object( ObjectSnapshot* copy, ObjectPool* pool,
+                  ObjectHandle handle, ObjectSnapshot* previous,
+                  int same_game )
+{
+    int place = ObjectPool_find( pool, handle ), axis;
+
+    copy->exists = place >= 0;
+    if( place < 0 )
+        return;
+
+    for( axis = 0; axis < 3; axis++ )
+        copy->position[axis] = pool->position[axis][place];
+    copy->radius = pool->radius[place];
+
+    // Objects that have just appeared (or been replaced, for edibles, which
+    // reappear somewhere else when eaten) don't move from anywhere
+    if( same_game && previous->exists &&
+        distance_squared( previous->position, copy->position ) <
+            MAX_OBJECT_STEP * MAX_OBJECT_STEP )
+    {
+        memcpy( copy->previousPosition, previous->position,
+                sizeof(float) * 3 );
+    }
+    else
+    {
+        memcpy( copy->previousPosition, copy->position, sizeof(float) * 3 );
+    }
+}
+
+/**
+ * Finds the point `fraction` of the way from `from` to `to`. `result` may be
+ * `to`.
+ */
+void interpolate_point( float result[3], float from[3], float to[3],
+                        float fraction )
+{
+    int i;
+
+    for( i = 0; i < 3; i++ )
+    {
+        result[i] = from[i] + fraction * (to[i] - from[i]);
+    }
+}
+
+float distance_squared( float a[3], float b[3] )
+{
+    return (a[0] - b[0]) * (a[0] - b[0]) + (a[1] - b[1]) * (a[1] - b[1]) +
+           (a[2] - b[2]) * (a[2] - b[2]);
+}
+
+/**
+ * Brings the snapshot's landscape up to date. It shares the gamestate's
+ * terrain, which the simulation copies before changing (see
+ * Landscape_touchRows), so only the rows' pointers need copying.
+ */
+void copy_landscape( RenderSnapshot* snapshot, GameState* gamestate )
+{
+    if( snapshot->landscape == NULL )
+        snapshot->landscape = Landscape_copy( gamestate->landscape );
+    else
+        Landscape_assign( snapshot->landscape, gamestate->landscape );
+}
+
+/**
+ * Makes room in the snapshot for `count` players and their projectiles. New
+ * players start with no joints or runs, which copy_player allocates.
+ */
+void fit_players( RenderSnapshot* snapshot, int count )
+{
+    if( count > snapshot->playerCapacity )
+    {
+        snapshot->players = (PlayerSnapshot*)realloc( snapshot->players,
+                                sizeof(PlayerSnapshot) * count );
+        snapshot->projectiles = (ObjectSnapshot*)realloc(
+                                    snapshot->projectiles,
+                                    sizeof(ObjectSnapshot) * count );
+        memset( &snapshot->players[snapshot->playerCapacity], 0,
+                sizeof(PlayerSnapshot) * (count - snapshot->playerCapacity) );
+        snapshot->playerCapacity = count;
+    }
+    snapshot->playerCount = count;
+}
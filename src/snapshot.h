@@ -0,0 +1,137 @@
+#ifndef SNAPSHOT_H_
+#define SNAPSHOT_H_
+/**
+ * snapshot.h
+ * This module hands the game state from the simulation to the renderer.
+ *
+ * The renderer never reads the gamestate itself, since the simulation may be
+ * changing it on another thread. Instead, after each update the simulation
+ * publishes a snapshot: a copy of everything the renderer draws. The renderer
+ * draws whichever snapshot was published most recently.
+ *
+ * Snapshots are triple buffered. The simulation fills one, the renderer draws
+ * another, and the third holds the latest finished snapshot; publishing and
+ * acquiring swap a slot with the third atomically, so neither side ever waits
+ * for the other. A snapshot the renderer has acquired isn't touched until it
+ * acquires the next one.
+ *
+ * Copying the whole landscape every update would cost more than the update,
+ * so each slot's landscape shares the gamestate's terrain (see Landscape.h),
+ * which the simulation copies, a chunk at a time, only when it changes it.
+ *
+ * Each snapshot also carries the positions of moving things as they were in
+ * the previous snapshot, so the renderer can draw them part of the way between
+ * the two (see `snapshot_interpolate`).
+ *
+ * There may be one publishing thread and one acquiring thread.
+ */
+
+#include "GameState.h"
+
+/**
+ * What the renderer needs to know about a player.
+ */
+typedef struct {
+    float headPosition[3];
+    float tailPosition[3];
+    float forward[3];
+    float up[3];
+    float color[3];
+    float radius;
+    int score;
+    int underGround;
+
+    // As of the previous snapshot
+    float previousHeadPosition[3];
+    float previousTailPosition[3];
+    float previousForward[3];
+    float previousUp[3];
+
+    // The positions of the joints between the head and the tail, newest first
+    Point* body;
+    int bodyLength;
+    int bodyCapacity;
+    // The number of body[0], counting joints in the order they were laid;
+    // body[i] is joint number bodySerial - i
+    unsigned int bodySerial;
+    // The landscape's version the joints' positions are from; joints move
+    // when the ground under them does
+    unsigned int groundVersion;
+    // The body's straight runs, oldest first
+    BodyRun* runs;
+    int runCount;
+    int runCapacity;
+} PlayerSnapshot;
+
+/**
+ * What the renderer needs to know about a projectile or edible.
+ */
+typedef struct {
+    int exists; // False if there's no such object at the moment
+    float position[3];
+    float radius;
+
+    // As of the previous snapshot (the same as `position` if it's new)
+    float previousPosition[3];
+} ObjectSnapshot;
+
+/**
+ * A copy of the drawable parts of the game state.
+ */
+typedef struct {
+    unsigned int generation; // The gamestate's generation when taken
+
+    /* The times, in nanoseconds on the monotonic clock, that this and the
+     * previous snapshot show the game as of */
+    long long time;
+    long long previousTime;
+    GameMode mode;
+    float countdown;
+
+    // Every player (player 1 is players[0]), and each one's projectile
+    PlayerSnapshot* players;
+    ObjectSnapshot* projectiles;
+    int playerCount;
+    int playerCapacity;
+    ObjectSnapshot edible;
+
+    Landscape* landscape; // A copy, sharing the gamestate's terrain
+} RenderSnapshot;
+
+/**
+ * Fills every slot from the gamestate, so that there's always a snapshot to
+ * draw. Must be called before anything is published or acquired.
+ */
+void snapshot_init( GameState* gamestate );
+
+/**
+ * Frees the snapshots.
+ */
+void snapshot_shutdown();
+
+/**
+ * Takes a snapshot of the gamestate as of `time` (in nanoseconds, on the
+ * monotonic clock), and makes it the latest. Called by the simulation.
+ */
+void snapshot_publish( GameState* gamestate, long long time );
+
+/**
+ * Returns the latest snapshot. Called by the renderer.
+ *
+ * The snapshot stays valid, and unchanged, until the next call.
+ */
+RenderSnapshot* snapshot_acquire();
+
+/**
+ * Copies `snapshot` into `result`, with everything that moves placed
+ * `fraction` of the way from its previous position to its current one.
+ *
+ * The copy shares the original's body joints and landscape, so is only valid
+ * as long as the original is. `result` keeps its own arrays of players and
+ * projectiles from one call to the next, growing them to fit, so should start
+ * out zeroed.
+ */
+void snapshot_interpolate( RenderSnapshot* snapshot, float fraction,
+                           RenderSnapshot* result );
+
+#endif /*SNAPSHOT_H_*/
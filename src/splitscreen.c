@@ -0,0 +1,134 @@
+#include "splitscreen.h"
+#include <stdlib.h>
+#include <math.h>
+
+/*******************************************************************************
+ * GLOBALS AND CONSTANTS
+ ******************************************************************************/
+// Prefer vertical splits to horizontal ones, when they're equally square?
+//#define PREFER_VERTICAL
+
+// How much worse an empty cell makes a layout, against views being one
+// natural logarithm away from square
+#define EMPTY_CELL_PENALTY 0.5f
+
+PlayerView split_views[MAX_SPLIT_VIEWS];
+int split_view_count = 0;
+
+
+/*******************************************************************************
+ * INTERNAL FUNCTION PROTOTYPES
+ ******************************************************************************/
+int choose_columns( int count, int width, int height );
+
+
+/*******************************************************************************
+ * PUBLIC FUNCTIONS
+ ******************************************************************************/
+void splitscreen_init( int count )
+{
+    int i;
+
+    splitscreen_shutdown();
+
+    if( count > MAX_SPLIT_VIEWS )
+        count = MAX_SPLIT_VIEWS;
+
+    for( i = 0; i < count; i++ )
+    {
+        split_views[i].viewport = Viewport_new( 0, 0, 1, 1 );
+        split_views[i].target = ScaledTarget_new();
+        split_views[i].player_id = i + 1;
+        split_views[i].camera_override = NULL;
+    }
+    split_view_count = count;
+}
+
+void splitscreen_shutdown()
+{
+    int i;
+
+    for( i = 0; i < split_view_count; i++ )
+    {
+        Viewport_delete( split_views[i].viewport );
+        ScaledTarget_delete( split_views[i].target );
+    }
+    split_view_count = 0;
+}
+
+int splitscreen_count()
+{
+    return split_view_count;
+}
+
+PlayerView* splitscreen_view( int index )
+{
+    return &split_views[index];
+}
+
+void splitscreen_layout( int width, int height )
+{
+    int columns, rows, i, row, column;
+    Viewport* viewport;
+
+    if( split_view_count == 0 )
+        return;
+
+    columns = choose_columns( split_view_count, width, height );
+    rows = (split_view_count + columns - 1) / columns;
+
+    for( i = 0; i < split_view_count; i++ )
+    {
+        // From the bottom right, leftwards then upwards
+        row = i / columns;
+        column = columns - 1 - i % columns;
+
+        viewport = split_views[i].viewport;
+        viewport->x = column * width / columns;
+        viewport->y = row * height / rows;
+        viewport->width = (column + 1) * width / columns - viewport->x;
+        viewport->height = (row + 1) * height / rows - viewport->y;
+    }
+}
+
+
+/*******************************************************************************
+ * INTERNAL FUNCTIONS
+ ******************************************************************************/
+/**
+ * Picks the number of columns to lay `count` views out in.
+ */
+int choose_columns( int count, int width, int height )
+{
+    int columns, rows, empty, best_columns = 1;
+    float score, best_score = 0.0f;
+
+    for( columns = 1; columns <= count; columns++ )
+    {
+        rows = (count + columns - 1) / columns;
+        empty = columns * rows - count;
+
+        // A whole empty row is just wasted space
+        if( empty >= columns )
+            continue;
+
+        // How far the views are from square
+        score = fabsf( logf( (width / (float)columns) /
+                             (height / (float)rows) ) ) +
+                EMPTY_CELL_PENALTY * empty;
+
+        if( columns == 1 ||
+#ifdef PREFER_VERTICAL
+            score <= best_score
+#else
+            score < best_score
+#endif
+          )
+        {
+            best_score = score;
+            best_columns = columns;
+        }
+    }
+
+    return best_columns;
+}
@@ -0,0 +1,53 @@
+#ifndef SPLITSCREEN_H_
+#define SPLITSCREEN_H_
+/**
+ * splitscreen.h
+ * This module divides the window between the players' views.
+ *
+ * Views are laid out in a grid, with as many columns as make the views
+ * closest to square without leaving whole rows empty. Players fill the grid
+ * from the bottom right, along each row then upwards, so that two players
+ * split the screen as they always have: player 1 on the right, or on the
+ * bottom in a tall window.
+ */
+
+#include "Viewport.h"
+#include "ScaledTarget.h"
+
+// The most views the screen may be split into
+#define MAX_SPLIT_VIEWS 8
+
+typedef struct {
+    Viewport* viewport;
+    ScaledTarget* target; // NULL if the view can't be scaled
+    int player_id; // The player the view follows
+    Camera* camera_override; // Looked through instead, if not NULL
+} PlayerView;
+
+/**
+ * Creates a view for each of `count` players, numbered from 1. Requires a
+ * current OpenGL context.
+ */
+void splitscreen_init( int count );
+
+/**
+ * Deletes the views.
+ */
+void splitscreen_shutdown();
+
+/**
+ * Returns the number of views.
+ */
+int splitscreen_count();
+
+/**
+ * Returns a view, by index (from 0).
+ */
+PlayerView* splitscreen_view( int index );
+
+/**
+ * Lays the views out across a window of the given size.
+ */
+void splitscreen_layout( int width, int height );
+
+#endif /*SPLITSCREEN_H_*/
@@ -1,54 +1,459 @@
 #include "text.h"
 #include <stdlib.h>
-#include <GL/glut.h>
+#include <string.h>
+#include <GL/gl.h>
 
-#define FONT_MAX_HEIGHT 152.38
+/*******************************************************************************
+ * TYPE DEFINITIONS
+ ******************************************************************************/
+/**
+ * The cached metrics of a glyph, in font pixels.
+ */
+typedef struct {
+    int bearing; // Blank columns to the left of the glyph
+    int advance; // Distance to move the pen after drawing the glyph
+    float s, t; // Texture coordinates of the glyph's cell (bottom left)
+} Glyph;
+
+/**
+ * A vertex in the text queue. Laid out for GL_T2F_C4UB_V3F.
+ */
+typedef struct {
+    GLfloat s, t;
+    GLubyte color[4];
+    GLfloat x, y, z;
+} TextVertex;
+
+/*******************************************************************************
+ * GLOBALS AND CONSTANTS
+ ******************************************************************************/
+// The font covers printable ASCII
+#define FIRST_GLYPH ' '
+#define GLYPH_COUNT 96
+
+// Glyphs are 8x8 pixels, with a blank border of one pixel in the atlas so that
+// neighbouring glyphs never bleed into each other
+#define GLYPH_SIZE 8
+#define CELL_SIZE (GLYPH_SIZE + 2)
+#define ATLAS_COLUMNS 16
+#define ATLAS_ROWS 6
+// Texture dimensions are kept to powers of two for old hardware
+#define ATLAS_WIDTH 256
+#define ATLAS_HEIGHT 64
+
+// The bottom row of each glyph is reserved for descenders
+#define DESCENT 1
+// The width of a space, in font pixels
+#define SPACE_ADVANCE 4
+
+// Outline thickness and shadow offset, in screen pixels
+#define OUTLINE_WIDTH 1.0f
+#define SHADOW_OFFSET 2.0f
+
+#define INITIAL_QUEUE_CAPACITY 1024
+
+/* 8x8 font for printable ASCII, one byte per row from top to bottom, least
+ * significant bit leftmost. Derived from the public domain IBM PC BIOS font. */
+static const unsigned char font_data[GLYPH_COUNT][GLYPH_SIZE] = {
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // ' '
+    { 0x18, 0x3C, 0x3C, 0x18, 0x18, 0x00, 0x18, 0x00 }, // '!'
+    { 0x36, 0x36, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // '"'
+    { 0x36, 0x36, 0x7F, 0x36, 0x7F, 0x36, 0x36, 0x00 }, // '#'
+    { 0x0C, 0x3E, 0x03, 0x1E, 0x30, 0x1F, 0x0C, 0x00 }, // '$'
+    { 0x00, 0x63, 0x33, 0x18, 0x0C, 0x66, 0x63, 0x00 }, // '%'
+    { 0x1C, 0x36, 0x1C, 0x6E, 0x3B, 0x33, 0x6E, 0x00 }, // '&'
+    { 0x06, 0x06, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00 }, // '''
+    { 0x18, 0x0C, 0x06, 0x06, 0x06, 0x0C, 0x18, 0x00 }, // '('
+    { 0x06, 0x0C, 0x18, 0x18, 0x18, 0x0C, 0x06, 0x00 }, // ')'
+    { 0x00, 0x66, 0x3C, 0xFF, 0x3C, 0x66, 0x00, 0x00 }, // '*'
+    { 0x00, 0x0C, 0x0C, 0x3F, 0x0C, 0x0C, 0x00, 0x00 }, // '+'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x06 }, // ','
+    { 0x00, 0x00, 0x00, 0x3F, 0x00, 0x00, 0x00, 0x00 }, // '-'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x00 }, // '.'
+    { 0x60, 0x30, 0x18, 0x0C, 0x06, 0x03, 0x01, 0x00 }, // '/'
+    { 0x3E, 0x63, 0x73, 0x7B, 0x6F, 0x67, 0x3E, 0x00 }, // '0'
+    { 0x0C, 0x0E, 0x0C, 0x0C, 0x0C, 0x0C, 0x3F, 0x00 }, // '1'
+    { 0x1E, 0x33, 0x30, 0x1C, 0x06, 0x33, 0x3F, 0x00 }, // '2'
+    { 0x1E, 0x33, 0x30, 0x1C, 0x30, 0x33, 0x1E, 0x00 }, // '3'
+    { 0x38, 0x3C, 0x36, 0x33, 0x7F, 0x30, 0x78, 0x00 }, // '4'
+    { 0x3F, 0x03, 0x1F, 0x30, 0x30, 0x33, 0x1E, 0x00 }, // '5'
+    { 0x1C, 0x06, 0x03, 0x1F, 0x33, 0x33, 0x1E, 0x00 }, // '6'
+    { 0x3F, 0x33, 0x30, 0x18, 0x0C, 0x0C, 0x0C, 0x00 }, // '7'
+    { 0x1E, 0x33, 0x33, 0x1E, 0x33, 0x33, 0x1E, 0x00 }, // '8'
+    { 0x1E, 0x33, 0x33, 0x3E, 0x30, 0x18, 0x0E, 0x00 }, // '9'
+    { 0x00, 0x0C, 0x0C, 0x00, 0x00, 0x0C, 0x0C, 0x00 }, // ':'
+    { 0x00, 0x0C, 0x0C, 0x00, 0x00, 0x0C, 0x0C, 0x06 }, // ';'
+    { 0x18, 0x0C, 0x06, 0x03, 0x06, 0x0C, 0x18, 0x00 }, // '<'
+    { 0x00, 0x00, 0x3F, 0x00, 0x00, 0x3F, 0x00, 0x00 }, // '='
+    { 0x06, 0x0C, 0x18, 0x30, 0x18, 0x0C, 0x06, 0x00 }, // '>'
+    { 0x1E, 0x33, 0x30, 0x18, 0x0C, 0x00, 0x0C, 0x00 }, // '?'
+    { 0x3E, 0x63, 0x7B, 0x7B, 0x7B, 0x03, 0x1E, 0x00 }, // '@'
+    { 0x0C, 0x1E, 0x33, 0x33, 0x3F, 0x33, 0x33, 0x00 }, // 'A'
+    { 0x3F, 0x66, 0x66, 0x3E, 0x66, 0x66, 0x3F, 0x00 }, // 'B'
+    { 0x3C, 0x66, 0x03, 0x03, 0x03, 0x66, 0x3C, 0x00 }, // 'C'
+    { 0x1F, 0x36, 0x66, 0x66, 0x66, 0x36, 0x1F, 0x00 }, // 'D'
+    { 0x7F, 0x46, 0x16, 0x1E, 0x16, 0x46, 0x7F, 0x00 }, // 'E'
+    { 0x7F, 0x46, 0x16, 0x1E, 0x16, 0x06, 0x0F, 0x00 }, // 'F'
+    { 0x3C, 0x66, 0x03, 0x03, 0x73, 0x66, 0x7C, 0x00 }, // 'G'
+    { 0x33, 0x33, 0x33, 0x3F, 0x33, 0x33, 0x33, 0x00 }, // 'H'
+    { 0x1E, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00 }, // 'I'
+    { 0x78, 0x30, 0x30, 0x30, 0x33, 0x33, 0x1E, 0x00 }, // 'J'
+    { 0x67, 0x66, 0x36, 0x1E, 0x36, 0x66, 0x67, 0x00 }, // 'K'
+    { 0x0F, 0x06, 0x06, 0x06, 0x46, 0x66, 0x7F, 0x00 }, // 'L'
+    { 0x63, 0x77, 0x7F, 0x7F, 0x6B, 0x63, 0x63, 0x00 }, // 'M'
+    { 0x63, 0x67, 0x6F, 0x7B, 0x73, 0x63, 0x63, 0x00 }, // 'N'
+    { 0x1C, 0x36, 0x63, 0x63, 0x63, 0x36, 0x1C, 0x00 }, // 'O'
+    { 0x3F, 0x66, 0x66, 0x3E, 0x06, 0x06, 0x0F, 0x00 }, // 'P'
+    { 0x1E, 0x33, 0x33, 0x33, 0x3B, 0x1E, 0x38, 0x00 }, // 'Q'
+    { 0x3F, 0x66, 0x66, 0x3E, 0x36, 0x66, 0x67, 0x00 }, // 'R'
+    { 0x1E, 0x33, 0x07, 0x0E, 0x38, 0x33, 0x1E, 0x00 }, // 'S'
+    { 0x3F, 0x2D, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00 }, // 'T'
+    { 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x3F, 0x00 }, // 'U'
+    { 0x33, 0x33, 0x33, 0x33, 0x33, 0x1E, 0x0C, 0x00 }, // 'V'
+    { 0x63, 0x63, 0x63, 0x6B, 0x7F, 0x77, 0x63, 0x00 }, // 'W'
+    { 0x63, 0x63, 0x36, 0x1C, 0x1C, 0x36, 0x63, 0x00 }, // 'X'
+    { 0x33, 0x33, 0x33, 0x1E, 0x0C, 0x0C, 0x1E, 0x00 }, // 'Y'
+    { 0x7F, 0x63, 0x31, 0x18, 0x4C, 0x66, 0x7F, 0x00 }, // 'Z'
+    { 0x1E, 0x06, 0x06, 0x06, 0x06, 0x06, 0x1E, 0x00 }, // '['
+    { 0x03, 0x06, 0x0C, 0x18, 0x30, 0x60, 0x40, 0x00 }, // '\'
+    { 0x1E, 0x18, 0x18, 0x18, 0x18, 0x18, 0x1E, 0x00 }, // ']'
+    { 0x08, 0x1C, 0x36, 0x63, 0x00, 0x00, 0x00, 0x00 }, // '^'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF }, // '_'
+    { 0x0C, 0x0C, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00 }, // '`'
+    { 0x00, 0x00, 0x1E, 0x30, 0x3E, 0x33, 0x6E, 0x00 }, // 'a'
+    { 0x07, 0x06, 0x06, 0x3E, 0x66, 0x66, 0x3B, 0x00 }, // 'b'
+    { 0x00, 0x00, 0x1E, 0x33, 0x03, 0x33, 0x1E, 0x00 }, // 'c'
+    { 0x38, 0x30, 0x30, 0x3E, 0x33, 0x33, 0x6E, 0x00 }, // 'd'
+    { 0x00, 0x00, 0x1E, 0x33, 0x3F, 0x03, 0x1E, 0x00 }, // 'e'
+    { 0x1C, 0x36, 0x06, 0x0F, 0x06, 0x06, 0x0F, 0x00 }, // 'f'
+    { 0x00, 0x00, 0x6E, 0x33, 0x33, 0x3E, 0x30, 0x1F }, // 'g'
+    { 0x07, 0x06, 0x36, 0x6E, 0x66, 0x66, 0x67, 0x00 }, // 'h'
+    { 0x0C, 0x00, 0x0E, 0x0C, 0x0C, 0x0C, 0x1E, 0x00 }, // 'i'
+    { 0x30, 0x00, 0x30, 0x30, 0x30, 0x33, 0x33, 0x1E }, // 'j'
+    { 0x07, 0x06, 0x66, 0x36, 0x1E, 0x36, 0x67, 0x00 }, // 'k'
+    { 0x0E, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00 }, // 'l'
+    { 0x00, 0x00, 0x33, 0x7F, 0x7F, 0x6B, 0x63, 0x00 }, // 'm'
+    { 0x00, 0x00, 0x1F, 0x33, 0x33, 0x33, 0x33, 0x00 }, // 'n'
+    { 0x00, 0x00, 0x1E, 0x33, 0x33, 0x33, 0x1E, 0x00 }, // 'o'
+    { 0x00, 0x00, 0x3B, 0x66, 0x66, 0x3E, 0x06, 0x0F }, // 'p'
+    { 0x00, 0x00, 0x6E, 0x33, 0x33, 0x3E, 0x30, 0x78 }, // 'q'
+    { 0x00, 0x00, 0x3B, 0x6E, 0x66, 0x06, 0x0F, 0x00 }, // 'r'
+    { 0x00, 0x00, 0x3E, 0x03, 0x1E, 0x30, 0x1F, 0x00 }, // 's'
+    { 0x08, 0x0C, 0x3E, 0x0C, 0x0C, 0x2C, 0x18, 0x00 }, // 't'
+    { 0x00, 0x00, 0x33, 0x33, 0x33, 0x33, 0x6E, 0x00 }, // 'u'
+    { 0x00, 0x00, 0x33, 0x33, 0x33, 0x1E, 0x0C, 0x00 }, // 'v'
+    { 0x00, 0x00, 0x63, 0x6B, 0x7F, 0x7F, 0x36, 0x00 }, // 'w'
+    { 0x00, 0x00, 0x63, 0x36, 0x1C, 0x36, 0x63, 0x00 }, // 'x'
+    { 0x00, 0x00, 0x33, 0x33, 0x33, 0x3E, 0x30, 0x1F }, // 'y'
+    { 0x00, 0x00, 0x3F, 0x19, 0x0C, 0x26, 0x3F, 0x00 }, // 'z'
+    { 0x38, 0x0C, 0x0C, 0x07, 0x0C, 0x0C, 0x38, 0x00 }, // '{'
+    { 0x18, 0x18, 0x18, 0x00, 0x18, 0x18, 0x18, 0x00 }, // '|'
+    { 0x07, 0x0C, 0x0C, 0x38, 0x0C, 0x0C, 0x07, 0x00 }, // '}'
+    { 0x6E, 0x3B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // '~'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }  // DEL
+};
+
+GLuint atlas_texture = 0;
+Glyph glyphs[GLYPH_COUNT];
+
+// The text queue
+TextVertex* text_queue = NULL;
+int text_queue_length = 0;
+int text_queue_capacity = 0;
+
+// The current text style
+GLubyte text_color[4];
+GLubyte outline_color[4];
+GLubyte shadow_color[4];
+
+
+/*******************************************************************************
+ * INTERNAL FUNCTION PROTOTYPES
+ ******************************************************************************/
+void rasterize_glyph( int index, GLubyte* atlas );
+Glyph* find_glyph( char c );
+void pack_color( GLubyte color[4], float r, float g, float b, float a );
+void queue_string( char* text, float x, float y, float scale, float hppu,
+                   float vppu, Viewport* vp, float dx, float dy,
+                   GLubyte color[4] );
+void queue_vertex( float s, float t, float x, float y, GLubyte color[4] );
+
+
+/*******************************************************************************
+ * PUBLIC FUNCTIONS
+ ******************************************************************************/
+void text_init()
+{
+    GLubyte* atlas;
+    int i;
+
+    if( atlas_texture != 0 )
+        return;
+
+    // Rasterize every glyph into the atlas, and work out its metrics
+    atlas = (GLubyte*)calloc( ATLAS_WIDTH * ATLAS_HEIGHT, 1 );
+    for( i = 0; i < GLYPH_COUNT; i++ )
+    {
+        rasterize_glyph( i, atlas );
+    }
+
+    // Upload the atlas. Glyph coverage goes in the alpha channel, so the
+    // colour of the text comes from the vertices.
+    glGenTextures( 1, &atlas_texture );
+    glBindTexture( GL_TEXTURE_2D, atlas_texture );
+    glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP );
+    glTexImage2D( GL_TEXTURE_2D, 0, GL_ALPHA, ATLAS_WIDTH, ATLAS_HEIGHT, 0,
+                  GL_ALPHA, GL_UNSIGNED_BYTE, atlas );
+    glBindTexture( GL_TEXTURE_2D, 0 );
+
+    free(atlas);
+
+    text_begin();
+}
+
+void text_begin()
+{
+    text_queue_length = 0;
+
+    pack_color( text_color, 1.0f, 1.0f, 1.0f, 1.0f );
+    pack_color( outline_color, 0.0f, 0.0f, 0.0f, 0.0f );
+    pack_color( shadow_color, 0.0f, 0.0f, 0.0f, 0.0f );
+}
+
+void text_set_color( float r, float g, float b, float a )
+{
+    pack_color( text_color, r, g, b, a );
+}
+
+void text_set_outline( float r, float g, float b, float a )
+{
+    pack_color( outline_color, r, g, b, a );
+}
+
+void text_set_shadow( float r, float g, float b, float a )
+{
+    pack_color( shadow_color, r, g, b, a );
+}
 
 void draw_2D_text( char* text, int x, int y, int height, Viewport* vp )
 {
-    float vscale,
-          hscale,
-          vppu,
-          hppu;
-    
+    float scale, vppu, hppu;
+
     if( text == NULL )
         return;
-    
+
+    // Pixels per unit, in each direction
     vppu = vp->height / (vp->top - vp->bottom);
     hppu = vp->width / (vp->right - vp->left);
-    
+    // Screen pixels per font pixel
+    scale = height / (float)GLYPH_SIZE;
+
+    // The shadow goes underneath everything, then the outline, then the text
+    if( shadow_color[3] != 0 )
+    {
+        queue_string( text, x, y, scale, hppu, vppu, vp,
+                      SHADOW_OFFSET, -SHADOW_OFFSET, shadow_color );
+    }
+    if( outline_color[3] != 0 )
+    {
+        queue_string( text, x, y, scale, hppu, vppu, vp,
+                      -OUTLINE_WIDTH, 0.0f, outline_color );
+        queue_string( text, x, y, scale, hppu, vppu, vp,
+                      OUTLINE_WIDTH, 0.0f, outline_color );
+        queue_string( text, x, y, scale, hppu, vppu, vp,
+                      0.0f, -OUTLINE_WIDTH, outline_color );
+        queue_string( text, x, y, scale, hppu, vppu, vp,
+                      0.0f, OUTLINE_WIDTH, outline_color );
+    }
+    queue_string( text, x, y, scale, hppu, vppu, vp,
+                  0.0f, 0.0f, text_color );
+}
+
+void draw_centered_text( char* text, int x, int y, int height, Viewport* vp )
+{
+    if( text == NULL )
+        return;
+
+    draw_2D_text( text, x - text_width( text, height ) / 2, y, height, vp );
+}
+
+float text_width( char* text, int height )
+{
+    int width = 0;
+
+    while( *text != '\0' )
+    {
+        width += find_glyph(*text)->advance;
+        text++;
+    }
+
+    return width * (height / (float)GLYPH_SIZE);
+}
+
+int text_flush()
+{
+    int vertex_count = text_queue_length;
+
+    if( text_queue_length == 0 || atlas_texture == 0 )
+        return 0;
+
+    glPushAttrib( GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_TEXTURE_BIT );
+    glPushClientAttrib( GL_CLIENT_VERTEX_ARRAY_BIT );
+
+    // Vertices are already in viewport units
     glMatrixMode(GL_MODELVIEW);
     glPushMatrix();
-    
     glLoadIdentity();
-    vscale = height / (vppu * (float)FONT_MAX_HEIGHT);
-    glTranslatef( vp->left + x / hppu, vp->bottom + y / vppu, 0.0f );
-    glScalef( vscale, vscale, 1.0f );
-    
-    draw_text(text);
-    
+
+    glDisable(GL_LIGHTING);
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+    glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
+    glEnable(GL_TEXTURE_2D);
+    glBindTexture( GL_TEXTURE_2D, atlas_texture );
+    glTexEnvi( GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE );
+
+    glInterleavedArrays( GL_T2F_C4UB_V3F, 0, text_queue );
+    glDrawArrays( GL_QUADS, 0, text_queue_length );
+
+    glBindTexture( GL_TEXTURE_2D, 0 );
     glPopMatrix();
+    glPopClientAttrib();
+    glPopAttrib();
+
+    text_queue_length = 0;
+
+    return vertex_count;
+}
+
+
+/*******************************************************************************
+ * INTERNAL FUNCTIONS
+ ******************************************************************************/
+/**
+ * Copies a glyph from the font into its cell in the atlas, and caches its
+ * metrics.
+ */
+void rasterize_glyph( int index, GLubyte* atlas )
+{
+    int row, column, left = GLYPH_SIZE, right = -1;
+    int cell_x = (index % ATLAS_COLUMNS) * CELL_SIZE,
+        cell_y = (index / ATLAS_COLUMNS) * CELL_SIZE;
+    Glyph* glyph = &glyphs[index];
+
+    for( row = 0; row < GLYPH_SIZE; row++ )
+    {
+        for( column = 0; column < GLYPH_SIZE; column++ )
+        {
+            if( !(font_data[index][row] & (1 << column)) )
+                continue;
+
+            // The font is stored top down, but textures are bottom up
+            atlas[ (cell_y + GLYPH_SIZE - row) * ATLAS_WIDTH
+                   + cell_x + 1 + column ] = 0xFF;
+
+            if( column < left )
+                left = column;
+            if( column > right )
+                right = column;
+        }
+    }
+
+    // Blank glyphs (i.e. space) get a fixed advance
+    if( right < left )
+    {
+        glyph->bearing = 0;
+        glyph->advance = SPACE_ADVANCE;
+    }
+    else
+    {
+        glyph->bearing = left;
+        glyph->advance = right - left + 2;
+    }
+
+    glyph->s = cell_x / (float)ATLAS_WIDTH;
+    glyph->t = cell_y / (float)ATLAS_HEIGHT;
 }
 
-void draw_text( char* text )
+/**
+ * Returns the glyph for a character, substituting '?' for anything the font
+ * doesn't cover.
+ */
+Glyph* find_glyph( char c )
 {
-    
+    if( c < FIRST_GLYPH || c >= FIRST_GLYPH + GLYPH_COUNT )
+        c = '?';
+
+    return &glyphs[c - FIRST_GLYPH];
+}
+
+void pack_color( GLubyte color[4], float r, float g, float b, float a )
+{
+    color[0] = r * 255.0f;
+    color[1] = g * 255.0f;
+    color[2] = b * 255.0f;
+    color[3] = a * 255.0f;
+}
+
+/**
+ * Queues one quad per character in `text`, offset by (dx, dy) screen pixels.
+ */
+void queue_string( char* text, float x, float y, float scale, float hppu,
+                   float vppu, Viewport* vp, float dx, float dy,
+                   GLubyte color[4] )
+{
+    Glyph* glyph;
+    float left, bottom, right, top, s1, t1,
+          cell_width = CELL_SIZE / (float)ATLAS_WIDTH,
+          cell_height = CELL_SIZE / (float)ATLAS_HEIGHT;
+
+    // Cells have a one pixel border, and the descender row sits below the
+    // baseline
+    bottom = vp->bottom + (y + dy - (1 + DESCENT) * scale) / vppu;
+    top = bottom + CELL_SIZE * scale / vppu;
+
     while( *text != '\0' )
     {
-        glutStrokeCharacter( GLUT_STROKE_ROMAN, *text );
+        glyph = find_glyph(*text);
+
+        left = vp->left + (x + dx - (1 + glyph->bearing) * scale) / hppu;
+        right = left + CELL_SIZE * scale / hppu;
+        s1 = glyph->s + cell_width;
+        t1 = glyph->t + cell_height;
+
+        queue_vertex( glyph->s, glyph->t, left, bottom, color );
+        queue_vertex( s1, glyph->t, right, bottom, color );
+        queue_vertex( s1, t1, right, top, color );
+        queue_vertex( glyph->s, t1, left, top, color );
+
+        x += glyph->advance * scale;
         text++;
     }
 }
 
-void draw_centered_text( char* text, int x, int y, int height, Viewport* vp )
+void queue_vertex( float s, float t, float x, float y, GLubyte color[4] )
 {
-    char* c = text;
-    float width = 0.0f;
-    
-    while( *c != '\0' )
+    TextVertex* vertex;
+
+    // Grow the queue as needed. It's never shrunk, so after the first few
+    // frames this never allocates.
+    if( text_queue_length == text_queue_capacity )
     {
-        width += glutStrokeWidth( GLUT_STROKE_ROMAN, *c );
+        text_queue_capacity = text_queue_capacity == 0 ?
+                              INITIAL_QUEUE_CAPACITY : text_queue_capacity * 2;
+        text_queue = (TextVertex*)realloc( text_queue,
+                                    sizeof(TextVertex) * text_queue_capacity );
     }
-    
-    draw_2D_text( text, x - width / 2, y, height, vp );
+
+    vertex = &text_queue[text_queue_length++];
+    vertex->s = s;
+    vertex->t = t;
+    memcpy( vertex->color, color, 4 );
+    vertex->x = x;
+    vertex->y = y;
+    vertex->z = 0.0f;
 }
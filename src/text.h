@@ -1,19 +1,80 @@
 #ifndef TEXT_H_
 #define TEXT_H_
+/**
+ * This module draws text.
+ *
+ * A bitmap font is rasterized once into a texture atlas by `text_init`, and
+ * the metrics of each glyph are cached alongside it. Strings are not drawn
+ * straight away; they are queued as textured quads, and the whole queue is
+ * drawn with a single call by `text_flush`. Outlines and drop shadows are
+ * extra quads in the same queue, so they cost no more state changes than the
+ * text itself.
+ *
+ * Typical use, once per frame:
+ *
+ *     text_begin();
+ *     text_set_color( 1.0f, 1.0f, 1.0f, 1.0f );
+ *     text_set_outline( 0.0f, 0.0f, 0.0f, 1.0f );
+ *     draw_2D_text( "Hello", 0, 590, 10, hud );
+ *     text_flush();
+ */
 
 #include "Viewport.h"
 
 /**
- * Draws `text` at pixel coordinates (x,y), with a height of `height`, on
- * viewport `vp`.
+ * Builds the glyph atlas. Requires a current OpenGL context, and need only be
+ * called once.
  */
-void draw_2D_text( char* text, int x, int y, int height, Viewport* vp );
+void text_init();
+
+/**
+ * Empties the text queue, and resets the text style to opaque white with no
+ * outline or shadow.
+ */
+void text_begin();
+
+/**
+ * Sets the colour of text queued from now on.
+ */
+void text_set_color( float r, float g, float b, float a );
+
+/**
+ * Sets the colour of the outline drawn around text queued from now on. An
+ * alpha of zero turns the outline off.
+ */
+void text_set_outline( float r, float g, float b, float a );
 
 /**
- * Draws `text`.
+ * Sets the colour of the drop shadow drawn beneath text queued from now on. An
+ * alpha of zero turns the shadow off.
  */
-void draw_text( char* text );
+void text_set_shadow( float r, float g, float b, float a );
 
+/**
+ * Queues `text` at pixel coordinates (x,y), with a height of `height`, on
+ * viewport `vp`. (x,y) gives the left end of the text's baseline.
+ */
+void draw_2D_text( char* text, int x, int y, int height, Viewport* vp );
+
+/**
+ * As for `draw_2D_text`, but (x,y) gives the middle of the text's baseline.
+ */
 void draw_centered_text( char* text, int x, int y, int height, Viewport* vp );
 
+/**
+ * Returns the width, in pixels, `text` would have if drawn `height` pixels
+ * high.
+ */
+float text_width( char* text, int height );
+
+/**
+ * Draws everything queued since `text_begin`, then empties the queue.
+ *
+ * Text is drawn with the current projection matrix, so the viewport it was
+ * queued on should still be applied.
+ *
+ * Returns the number of vertices drawn.
+ */
+int text_flush();
+
 #endif /*TEXT_H_*/